@@ -0,0 +1,58 @@
+/* This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to send the decoded data to a computer (or another board) in binary packets, with IRsmallDUplink.h,
+ * instead of printing it as text.
+ *
+ * Steps:
+ *  1 - Connect the IR receiver (see library documentation);
+ *  2 - Uncomment the #define for the desired protocol;
+ *      leave the others commented out (only one is allowed);
+ *  3 - Upload this sketch and close the Serial Monitor (the packets are not text);
+ *  4 - On the computer, build and run the iruplink host tool (see extras/HostTools/README.md), e.g.:
+ *        ./iruplink_nec -b 115200 /dev/ttyUSB0
+ *  5 - Push buttons on the remote control,
+ *      you should see one line per decoded frame, in the terminal.
+ *
+ * How it works:
+ *  - Each frame becomes a 10 byte record (protocol, addr, cmd, ext, keyHeld and time). The records are sent
+ *    in batches, as packets with a CRC, framed with COBS (a 0x00 byte ends each packet);
+ *  - poll() keeps the records for up to c_maxDelay ms, so the frames of a held key go in the same packet,
+ *    and it only sends a packet while the decoder is idle (between frames).
+ *
+ * In this example, it is assumed that the IR receiver is connected to digital pin 2, and that the pin supports
+ * external interrupts (on ESP boards, see the ESP_IR_Decoder example).
+ *
+ * For more information, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder or read the README.pdf file in the extras folder.
+ */
+
+
+// »»»» Select one Protocol:
+#define IR_SMALLD_NEC
+// #define IR_SMALLD_NECx
+// #define IR_SMALLD_RC5
+// #define IR_SMALLD_SIRC12
+// #define IR_SMALLD_SIRC15
+// #define IR_SMALLD_SIRC20
+// #define IR_SMALLD_SIRC
+// #define IR_SMALLD_SAMSUNG
+// #define IR_SMALLD_SAMSUNG32
+// #define IR_SMALLD_HASH
+
+// »»»» Records per packet (5 records fit in the 64 byte serial TX buffer of most AVR boards):
+#define IR_SMALLD_UPLINK_BATCH 5
+
+#include <IRsmallDecoder.h>
+#include <IRsmallDUplink.h>
+
+const uint16_t c_maxDelay = 250;  // ms (more than the period of the repeated frames of a held key)
+
+IRsmallDecoder irDecoder(2);
+IRsmallDUplink uplink(Serial, c_maxDelay);
+
+void setup() {
+  Serial.begin(115200);
+}
+
+void loop() {
+  uplink.poll(irDecoder);
+}
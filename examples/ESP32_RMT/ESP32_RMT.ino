@@ -0,0 +1,93 @@
+/* This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to decode the IR signals captured by the ESP32's RMT peripheral (edge buffer input).
+ *
+ * Instead of one interrupt per edge (about 68 for each NEC frame), the RMT records the whole frame
+ * and the decoder processes it in one call to decodeBuffer().
+ *
+ * Steps:
+ *  1 - Connect the IR receiver (see library documentation);
+ *  2 - Uncomment the #define for the desired protocol;
+ *      leave the others commented out (only one is allowed);
+ *  3 - Upload this sketch and open the Serial Monitor;
+ *  4 - Push buttons on the remote control,
+ *      you should see the decoded data on the Serial Monitor.
+ *
+ * It requires the ESP32 Arduino core version 3 (or later) and any ESP32 with a RMT peripheral.
+ * In this example, it is assumed that the IR receiver is connected to the GPIO pin 5.
+ */
+
+
+// »»»» Select one Protocol:
+#define IR_SMALLD_NEC
+// #define IR_SMALLD_NECx
+// #define IR_SMALLD_RC5
+// #define IR_SMALLD_SIRC12
+// #define IR_SMALLD_SIRC15
+// #define IR_SMALLD_SIRC20
+// #define IR_SMALLD_SIRC
+// #define IR_SMALLD_SAMSUNG
+// #define IR_SMALLD_SAMSUNG32
+
+// »»»» Use the edge buffer input, instead of the pin interrupt:
+#define IR_SMALLD_EDGE_BUFFER
+
+// »»»» Choose a pin where you'll connect the IR module:
+#define IR_DECODER_PIN 5
+
+// »»»» Include the library:
+#include <IRsmallDecoder.h>
+
+#define RMT_IDLE_US 12000  // A frame ends after 12ms without edges (longer than any space inside a frame)
+
+IRsmallDecoder irDecoder;  // No pin, the RMT takes care of it (so it can be a global object)
+irSmallD_t irData;
+rmt_data_t rmtItems[64];
+
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial);
+  // 1 tick = 1µs, so the RMT durations can be used directly:
+  if (!rmtInit(IR_DECODER_PIN, RMT_RX_MODE, RMT_MEM_NUM_BLOCKS_1, 1000000)) {
+    Serial.println("RMT initialization failed");
+    while (true) delay(1000);
+  }
+  rmtSetRxMinThreshold(IR_DECODER_PIN, 100);  // Ignore glitches shorter than 100µs
+  rmtSetRxMaxThreshold(IR_DECODER_PIN, RMT_IDLE_US);
+  Serial.println();
+  Serial.println("Waiting for a remote control IR signal...");
+  Serial.println("held\tAddr\tCmd");
+}
+
+
+void loop() {
+  size_t itemCount = sizeof(rmtItems) / sizeof(rmtItems[0]);
+  if (rmtRead(IR_DECODER_PIN, rmtItems, &itemCount, 200)) {  // Waits up to 200ms for a frame
+    // Each RMT item holds two durations; the data ends with a zero duration:
+    const irSmallD_pulse_t *pulses = (const irSmallD_pulse_t *)rmtItems;
+    uint16_t pulseCount = itemCount * 2;
+    uint32_t frameLength = 0;
+    for (uint16_t i = 0; i < pulseCount && pulses[i].duration; i++) frameLength += pulses[i].duration;
+    // The frame was received before the idle time, that's when it started:
+    irDecoder.decodeBuffer(pulses, pulseCount, micros() - RMT_IDLE_US - frameLength);
+  }
+
+  // »»»» Check for a decoded signal and use it if available:
+  if (irDecoder.dataAvailable(irData)) {
+    Serial.print("» ");
+    #if !defined(IR_SMALLD_HAS_KEYHELD)
+      Serial.print("-");  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
+    #else
+      Serial.print(irData.keyHeld);
+    #endif
+    Serial.print("\t");
+    Serial.print(irData.addr, HEX);
+    Serial.print("\t");
+    Serial.print(irData.cmd, HEX);
+    #if defined(IR_SMALLD_SIRC20) || defined(IR_SMALLD_SIRC)
+      Serial.print("\t");
+      Serial.print(irData.ext, HEX);  // SIRC20 and SIRC have extended data
+    #endif
+    Serial.println();
+  }
+}
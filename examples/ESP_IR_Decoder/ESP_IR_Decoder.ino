@@ -53,8 +53,8 @@ void loop() {
   // »»»» Check for a decoded signal and use it if available:
   if (irDecoder.dataAvailable(irData)) {
     Serial.print("» ");
-    #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15) || defined(IR_SMALLD_SIRC20)
-      Serial.print("-");  // SIRC12/15/20 do not have keyHeld
+    #if !defined(IR_SMALLD_HAS_KEYHELD)
+      Serial.print("-");  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
     #else
       Serial.print(irData.keyHeld);
     #endif
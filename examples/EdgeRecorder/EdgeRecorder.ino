@@ -0,0 +1,86 @@
+/* Edge recorder
+ *
+ * This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to record the last edges received by the decoder, so that a remote control that isn't
+ * (always) decoded can be analyzed on a computer, with the irdecode host tool (extras/HostTools).
+ *
+ * The recorder keeps the last frames in a small ring buffer. With IR_SMALLD_RECORDER_FREEZE_ON_ERROR,
+ * the recording stops at the first frame that the decoder rejects, so the bad frame (and the ones
+ * before it) are not overwritten.
+ *
+ * How to use this sketch:
+ *  - Connect the IR receiver to digital pin 2 (or change the pin below, it must support external interrupts);
+ *  - Uncomment the #define for the desired protocol;
+ *    leave the others commented out (only one is allowed);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - Push buttons on the remote control, you should see the decoded data on the Serial Monitor;
+ *  - Send 'd' to print the recording (it's printed automatically when it's frozen by an error), 'r' to resume it;
+ *  - Copy the lines from "#irsmalld-rec" to "#end" into a file and decode it on a computer, e.g.:
+ *      irdecode_nec -f rec recording.txt
+ *
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#define IR_SMALLD_NEC
+//#define IR_SMALLD_NECx
+//#define IR_SMALLD_RC5
+//#define IR_SMALLD_SIRC12
+//#define IR_SMALLD_SIRC15
+//#define IR_SMALLD_SIRC20
+//#define IR_SMALLD_SIRC
+//#define IR_SMALLD_SAMSUNG
+//#define IR_SMALLD_SAMSUNG32
+
+#define IR_SMALLD_RECORDER
+#define IR_SMALLD_RECORDER_SIZE 256  // bytes (this is the default value), about 2 NEC frames
+#define IR_SMALLD_RECORDER_FREEZE_ON_ERROR
+#include <IRsmallDecoder.h>
+
+IRsmallDecoder irDecoder(2);
+irSmallD_t irData;
+bool dumped = false;
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Waiting for a remote control IR signal...");
+  Serial.println("Send 'd' to print the recording, 'r' to resume it");
+  Serial.println("held \t addr \t cmd");
+}
+
+
+void loop() {
+  if (irDecoder.dataAvailable(irData)) {
+    #if !defined(IR_SMALLD_HAS_KEYHELD)
+      Serial.print("-");  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
+    #else
+      Serial.print(irData.keyHeld, HEX);
+    #endif
+    Serial.print("\t ");
+    Serial.print(irData.addr, HEX);
+    Serial.print("\t ");
+    Serial.println(irData.cmd, HEX);
+  }
+
+  if (irDecoder.recorderFrozen() && !dumped) {  // Stopped by an error
+    Serial.println("A frame was rejected:");
+    irDecoder.dumpRecorder(Serial);
+    dumped = true;
+  }
+
+  if (Serial.available()) {
+    switch (Serial.read()) {
+      case 'd':
+        irDecoder.dumpRecorder(Serial);
+        break;
+      case 'r':
+        irDecoder.clearRecorder();
+        irDecoder.resumeRecorder();
+        dumped = false;
+        Serial.println("Recording...");
+        break;
+    }
+  }
+}
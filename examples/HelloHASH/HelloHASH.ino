@@ -0,0 +1,31 @@
+/* A simple example using the IRsmallDecoder library
+ * for testing remote controls that are not supported by the other decoders.
+ *
+ * The HASH decoder does not decode the signal; it turns each frame into a 32-bit
+ * hash value that depends on the sequence of pulses and spaces. Each key will 
+ * (usually) have its own hash, which can then be used as if it was a command code.
+ *
+ * In this example it's assumed that the IR receiver is connected to digital pin 2, 
+ * and that the pin supports external interrupts (with the CHANGE mode).
+ * 
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#define IR_SMALLD_HASH        // 1st: Define which protocol to use;
+#include <IRsmallDecoder.h>   // 2nd: Include the library;
+IRsmallDecoder irDecoder(2);  // 3rd: Create one decoder object with the correct digital pin;
+irSmallD_t irData;            // 4th: Declare a decoder data structure;
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Waiting for an IR signal (any remote control)...");
+  Serial.println("hash");
+}
+
+void loop() {
+  if (irDecoder.dataAvailable(irData)) {  // 5th: If the decoder has new data available,
+    Serial.println(irData.hash, HEX);     // 6th: do something with that data...
+  }
+}
@@ -2,10 +2,12 @@
  * that use the Sony SIRC12, SIRC15 or SIRC20 protocols. 
  *
  * Notes: 
- *  - Unlike IR_SMALLD_SIRC, IR_SMALLD_SIRC12/15/20 do not have the keyHeld data member;
+ *  - Unlike IR_SMALLD_SIRC, IR_SMALLD_SIRC12/15/20 do not have the keyHeld data member,
+ *    unless IR_SMALLD_SIRC_KEYHELD is defined (uncomment it below);
  *  - IR_SMALLD_SIRC20 has an additional data member (ext);
  *  - Each keypress on a SIRC remote, usually sends three signal frames. The two additional 
- *    signal repetitions are ignored in the IR_SMALLD_SIRC, but not in the IR_SMALLD_SIRC12/15/20;
+ *    signal repetitions are ignored in the IR_SMALLD_SIRC, but not in the IR_SMALLD_SIRC12/15/20
+ *    (again, unless IR_SMALLD_SIRC_KEYHELD is defined);
  *  - IR_SMALLD_SIRC12 will receive signals from SIRC15 and SIRC20, but the codes will not be correct;
  *  - In a similar way, IR_SMALLD_SIRC15 will receive signals from SIRC20, but not from SIRC12.
  *	
@@ -21,6 +23,7 @@
 #define IR_SMALLD_SIRC12      // 1st: Define which protocol to use
 //#define IR_SMALLD_SIRC15    //      (only one of these three can be defined at a time);
 //#define IR_SMALLD_SIRC20
+//#define IR_SMALLD_SIRC_KEYHELD  //      Optional: ignore the repetitions and report held keys
 
 #include <IRsmallDecoder.h>   // 2nd: Include the library;
 IRsmallDecoder irDecoder(2);  // 3rd: Create one decoder object with the correct digital pin;
@@ -44,12 +47,15 @@ void loop() {
   if (irDecoder.dataAvailable(irData)) {  // 5th: If the decoder has new data available,
     Serial.print(irData.addr, HEX);       // 6th: do something with that data...
     Serial.print("   \t");
-    #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15)
-      Serial.println(irData.cmd, HEX);
-    #else
-      Serial.print(irData.cmd, HEX);
+    Serial.print(irData.cmd, HEX);
+    #if defined(IR_SMALLD_SIRC20)
       Serial.print("  \t");
-      Serial.println(irData.ext, HEX);
+      Serial.print(irData.ext, HEX);
     #endif
+    #if defined(IR_SMALLD_SIRC_KEYHELD)
+      Serial.print("\t");
+      Serial.print(irData.keyHeld);
+    #endif
+    Serial.println();
   }
 }
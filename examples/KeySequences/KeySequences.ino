@@ -0,0 +1,67 @@
+/* Key sequences
+ *
+ * This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to recognize sequences of keys, like service codes or PINs, with a sequence set.
+ *
+ * The sequences are checked and compiled into a state machine at compile time (a repeated
+ * sequence, or one that contains another, results in a compilation error) and stored in
+ * program memory. Each key takes the same time, whatever the number of sequences, and the
+ * sequence set only uses 3 bytes of RAM.
+ *
+ * How to use this sketch:
+ *  - Connect the IR receiver (see library documentation);
+ *  - Replace the address and the commands in the sequences with the ones from your remote
+ *    (you can find them with the HelloNEC example);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - Enter the sequences, with less than 3 seconds between keys.
+ *
+ * In this example, it's assumed that the board has a built-in LED and the IR receiver is
+ * connected to digital pin 2, which must be usable for external interrupts.
+ *
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#define IR_SMALLD_NEC
+#include <IRsmallDecoder.h>
+#include <IRsmallDSequence.h>
+
+IRsmallDecoder irDecoder(2);  // Assuming that the IR receiver is connected to digital pin 2
+irSmallD_t irData;
+bool locked = true;
+
+IR_SMALLD_SEQUENCES(codes, 0x00, 3000,  // Remote's address and maximum time between keys (ms)
+  IR_SEQ(0x0C, 0x18, 0x5E, 0x08),         // 0: 1 2 3 4 (unlock)
+  IR_SEQ(0x08, 0x5E, 0x18, 0x0C),         // 1: 4 3 2 1 (lock)
+  IR_SEQ(0x47, 0x42, 0x4A, 0x42)          // 2: MENU 7 9 7 (service menu)
+);
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  Serial.begin(115200);
+  Serial.println("Waiting for a NEC remote control IR signal...");
+}
+
+void loop() {
+  if (irDecoder.dataAvailable(irData)) {
+    switch (codes.update(irData)) {
+      case 0:
+        locked = false;
+        digitalWrite(LED_BUILTIN, HIGH);
+        Serial.println("Unlocked");
+        break;
+      case 1:
+        locked = true;
+        digitalWrite(LED_BUILTIN, LOW);
+        Serial.println("Locked");
+        break;
+      case 2:
+        Serial.println(locked ? "Service menu: unlock first" : "Service menu");
+        break;
+      default:  // IR_SEQ_NONE
+        if (codes.inProgress()) Serial.print("*");  // Part of a sequence was entered
+        else Serial.println();
+    }
+  }
+}
@@ -0,0 +1,68 @@
+/* Keymap
+ *
+ * This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to use a keymap to call a function for each key, instead of using if/switch chains.
+ *
+ * The keymap is a table of {address, command, keyHeld policy, handler function} entries.
+ * It's checked and organized at compile time (duplicate keys result in a compilation error)
+ * and stored in program memory, so it doesn't use any RAM.
+ *
+ * How to use this sketch:
+ *  - Connect the IR receiver (see library documentation);
+ *  - Replace the addresses and commands in the keymap with the ones from your remote
+ *    (you can find them with the HelloNEC example);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - Press the keys in the keymap (and hold the "volume" keys).
+ *
+ * In this example, it's assumed that the board has a built-in LED and the IR receiver is
+ * connected to digital pin 2, which must be usable for external interrupts.
+ *
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#define IR_SMALLD_NEC
+#include <IRsmallDecoder.h>
+#include <IRsmallDKeymap.h>
+
+IRsmallDecoder irDecoder(2);  // Assuming that the IR receiver is connected to digital pin 2
+int ledState = LOW;
+int volume = 10;
+
+void togglePower(const irSmallD_t &irData) {
+  ledState = (ledState == LOW) ? HIGH : LOW;
+  digitalWrite(LED_BUILTIN, ledState);
+}
+
+void volumeUp(const irSmallD_t &irData) {
+  if (volume < 100) volume++;
+  Serial.println(volume);
+}
+
+void volumeDown(const irSmallD_t &irData) {
+  if (volume > 0) volume--;
+  Serial.println(volume);
+}
+
+void mute(const irSmallD_t &irData) {
+  volume = 0;
+  Serial.println(volume);
+}
+
+IR_SMALLD_KEYMAP(remoteKeys,
+  {0x00, 0x45, IR_KEY_PRESS,  togglePower},  // Power key: pressing it toggles the LED (holding it does nothing)
+  {0x00, 0x46, IR_KEY_REPEAT, volumeUp},     // Volume up: press it or hold it
+  {0x00, 0x15, IR_KEY_REPEAT, volumeDown},   // Volume down: press it or hold it
+  {0x00, 0x47, IR_KEY_HELD,   mute}          // Mute: hold the key for a while
+);
+
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+  Serial.begin(115200);
+  Serial.println("Waiting for a NEC remote control IR signal...");
+}
+
+void loop() {
+  remoteKeys.dispatch(irDecoder);  // Calls the key's function if there's new data from a key in the keymap
+}
@@ -0,0 +1,108 @@
+/* This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to put an ESP32 to sleep between frames, with the isIdle() and nextDeadline() methods.
+ *
+ * Steps:
+ *  1 - Connect the IR receiver to an RTC capable pin (see below);
+ *  2 - Uncomment the #define for the desired protocol;
+ *      leave the others commented out (only one is allowed);
+ *  3 - Upload this sketch and open the Serial Monitor;
+ *  4 - Push buttons on the remote control,
+ *      you should see the decoded data, and the number of wake-ups, on the Serial Monitor.
+ *
+ * How it works:
+ *  - While the decoder is idle (no frame being received), the ESP32 enters light sleep and is woken up when the
+ *    receiver's output goes low. The ext0 wake-up source is used, so the pin must be one of the RTC GPIOs
+ *    (0, 2, 4, 12-15, 25-27, 32-39 on the ESP32), and it only works on the ESP32, ESP32-S2 and ESP32-S3;
+ *  - After waking up, it stays awake for c_awakeTime ms, so that the repeated frames of a held key are decoded;
+ *  - While a frame is being received, the task sleeps (with waitForData) until new data is available or until the
+ *    frame's deadline, when dataAvailable() resets the decoder if the frame was left incomplete.
+ *
+ * Notes:
+ *  - The decoder measures the time between edges with micros(), which keeps counting during light sleep. In deep
+ *    sleep, or with sleep modes that stop the micros() clock on other boards, the gap before a frame is lost.
+ *  - While the ESP32 is asleep, the pin is an RTC input, so the decoder does not see the edge that wakes it up.
+ *    The NEC, NECx and SAMSUNG decoders only use the rising edges, so the first frame is decoded anyway; the other
+ *    protocols lose the first frame, but not the following ones (SIRC remotes send each code at least 3 times).
+ *
+ * For more information, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder or read the README.pdf file in the extras folder.
+ */
+
+
+// »»»» Select one Protocol:
+#define IR_SMALLD_NEC
+// #define IR_SMALLD_NECx
+// #define IR_SMALLD_RC5
+// #define IR_SMALLD_SIRC12
+// #define IR_SMALLD_SIRC15
+// #define IR_SMALLD_SIRC20
+// #define IR_SMALLD_SIRC
+// #define IR_SMALLD_SAMSUNG
+// #define IR_SMALLD_SAMSUNG32
+
+// »»»» Choose an RTC capable pin where you'll connect the IR module:
+#define IR_DECODER_PIN 27
+
+// »»»» waitForData() sleeps until the ISR notifies the loop task:
+#define IR_SMALLD_FREERTOS_NOTIFY
+#include <IRsmallDecoder.h>
+#include <driver/rtc_io.h>
+
+#if !defined(ESP32)
+  #error This example uses the ESP32's light sleep
+#endif
+
+const uint32_t c_awakeTime = 300;  // ms after each wake-up (longer than the gap between repeated frames)
+
+uint32_t wakeups = 0;
+
+
+void lightSleepUntilEdge() {
+  Serial.flush();
+  esp_sleep_enable_ext0_wakeup((gpio_num_t)IR_DECODER_PIN, 0);  // Wakes up when the output goes low (IR light)
+  esp_light_sleep_start();
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_EXT0);
+  rtc_gpio_deinit((gpio_num_t)IR_DECODER_PIN);  // Gives the pin back to the GPIO matrix, and to the decoder's interrupt
+  wakeups++;
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial);
+  Serial.println();
+  Serial.println("Waiting for a remote control IR signal...");
+  Serial.println("wakeups\tAddr\tCmd");
+}
+
+
+void loop() {
+  // »»»» Create one static decoder (see the ESP_IR_Decoder example):
+  static IRsmallDecoder irDecoder(IR_DECODER_PIN);
+  static uint32_t awakeSince = millis();
+  irSmallD_t irData;
+  uint32_t deadline;
+  uint32_t waitTime;
+
+  // »»»» Nothing being received for a while: sleep until the next edge
+  if (irDecoder.isIdle() && millis() - awakeSince >= c_awakeTime) {
+    lightSleepUntilEdge();
+    awakeSince = millis();
+  }
+
+  // »»»» A frame is being received: wait for its data, but no longer than its deadline
+  if (irDecoder.nextDeadline(deadline)) {
+    int32_t timeLeft = (int32_t)(deadline - micros());
+    waitTime = timeLeft > 0 ? timeLeft : 0;
+  }
+  else waitTime = 10000;  // Idle, but still awake: check again in 10ms
+
+  if (irDecoder.waitForData(irData, waitTime)) {
+    Serial.print(wakeups);
+    Serial.print("\t");
+    Serial.print(irData.addr, HEX);
+    Serial.print("\t");
+    Serial.println(irData.cmd, HEX);
+    awakeSince = millis();
+  }
+}
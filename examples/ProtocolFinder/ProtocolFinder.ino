@@ -0,0 +1,150 @@
+/* Protocol Finder
+ *
+ * This example is part of the IRsmallDecoder library and is intended to help find out
+ * which protocol is used by an unknown remote control, before choosing the decoder.
+ *
+ * Only one decoder can be compiled at a time, so this sketch does not use the decoder at all.
+ * Instead, it records the durations of the pulses and spaces of each frame and compares them
+ * with the timings of the supported protocols. When the same protocol is detected in a few
+ * consecutive frames, its name and ID are shown (see IRsmallDProtocolIDs.h).
+ *
+ * The result is meant for choosing the #define of your sketch, at compile time: the library can't
+ * detect the protocol, or switch to another one, at runtime. The ID only identifies a protocol;
+ * the final sketch's IR_SMALLD_PROTOCOL_ID tells which one it was compiled with.
+ *
+ * How to use this sketch:
+ *  - Connect the IR receiver (see library documentation);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - Point the remote at the receiver and press a few different keys (one at a time);
+ *  - Use the #define shown on the Serial Monitor in your own sketch.
+ *
+ * In this example, it's assumed that the IR receiver is connected to digital pin 2,
+ * which must be usable for external interrupts (with the CHANGE mode).
+ *
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#include <IRsmallDProtocolIDs.h>
+
+#define IR_PIN        2
+#define MAX_INTERVALS 68    // Enough for 32 bit frames (2 for the leading mark + 32 x 2 for the bits + 1 stop pulse)
+#define FRAME_GAP     5200  // Minimum space between frames, in µs (the longest space inside a frame is 4500µs)
+#define CONFIRMATIONS 3     // Number of consecutive frames that must be detected as the same protocol
+
+volatile uint16_t intervals[MAX_INTERVALS];  // pulse, space, pulse, space, ... (in µs)
+volatile uint8_t  intervalCount = 0;
+volatile bool     receiving = false;
+volatile uint32_t lastEdgeTime = 0;
+
+uint8_t lastId = IR_SMALLD_ID_UNKNOWN;
+uint8_t sameIdCount = 0;
+
+
+void edgeISR() {  // Triggered on every change of the IR receiver's output (the signal is active low)
+  uint32_t now = micros();
+  uint32_t duration = now - lastEdgeTime;
+  lastEdgeTime = now;
+  if (digitalRead(IR_PIN) == LOW) {  // A pulse has just started, so a space has ended
+    if (duration > FRAME_GAP) {      // It was a gap, a new frame is starting
+      if (!receiving) {              // (unless the previous frame wasn't analysed yet)
+        intervalCount = 0;
+        receiving = true;
+      }
+    } else if (receiving && intervalCount < MAX_INTERVALS) intervals[intervalCount++] = duration;
+  } else {                           // A pulse has just ended
+    if (receiving && intervalCount < MAX_INTERVALS) intervals[intervalCount++] = duration;
+  }
+}
+
+
+bool isAround(uint16_t duration, uint16_t nominal) {  // 25% tolerance
+  return duration >= nominal - nominal / 4 && duration <= nominal + nominal / 4;
+}
+
+
+uint8_t findProtocol(const volatile uint16_t *iv, uint8_t count) {
+  if (count < 3) return IR_SMALLD_ID_UNKNOWN;
+
+  // NEC / NECx: 9ms leading pulse followed by a 4.5ms space; 32 bits coded in the spaces' length
+  if (isAround(iv[0], 9000) && isAround(iv[1], 4500) && count == 67) {
+    uint8_t addr = 0, addrInv = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (iv[3 + 2 * i] > 1125) addr |= 1 << i;          // LSB first
+      if (iv[19 + 2 * i] > 1125) addrInv |= 1 << i;
+    }
+    return (addr == (uint8_t)~addrInv) ? IR_SMALLD_ID_NEC : IR_SMALLD_ID_NECx;
+  }
+
+  // SAMSUNG / SAMSUNG32: 4.5ms leading pulse followed by a 4.5ms space; 20 or 32 bits
+  if (isAround(iv[0], 4500) && isAround(iv[1], 4500)) {
+    if (count == 43) return IR_SMALLD_ID_SAMSUNG;
+    if (count == 67) return IR_SMALLD_ID_SAMSUNG32;
+    return IR_SMALLD_ID_UNKNOWN;
+  }
+
+  // SIRC: 2.4ms leading pulse; 12, 15 or 20 bits coded in the pulses' length (the last space is the gap)
+  if (isAround(iv[0], 2400) && isAround(iv[1], 600)) {
+    if (count == 25) return IR_SMALLD_ID_SIRC12;
+    if (count == 31) return IR_SMALLD_ID_SIRC15;
+    if (count == 41) return IR_SMALLD_ID_SIRC20;
+    return IR_SMALLD_ID_UNKNOWN;
+  }
+
+  // RC5: no leading mark, all pulses and spaces are 889µs or 1778µs long
+  for (uint8_t i = 0; i < count; i++) {
+    if (!isAround(iv[i], 889) && !isAround(iv[i], 1778)) return IR_SMALLD_ID_UNKNOWN;
+  }
+  return IR_SMALLD_ID_RC5;
+}
+
+
+void printProtocol(uint8_t id) {
+  Serial.print(F("Protocol found: #define "));
+  switch (id) {
+    case IR_SMALLD_ID_NEC:       Serial.print(F("IR_SMALLD_NEC"));       break;
+    case IR_SMALLD_ID_NECx:      Serial.print(F("IR_SMALLD_NECx"));      break;
+    case IR_SMALLD_ID_RC5:       Serial.print(F("IR_SMALLD_RC5"));       break;
+    case IR_SMALLD_ID_SIRC12:    Serial.print(F("IR_SMALLD_SIRC12"));    break;
+    case IR_SMALLD_ID_SIRC15:    Serial.print(F("IR_SMALLD_SIRC15"));    break;
+    case IR_SMALLD_ID_SIRC20:    Serial.print(F("IR_SMALLD_SIRC20"));    break;
+    case IR_SMALLD_ID_SAMSUNG:   Serial.print(F("IR_SMALLD_SAMSUNG"));   break;
+    case IR_SMALLD_ID_SAMSUNG32: Serial.print(F("IR_SMALLD_SAMSUNG32")); break;
+  }
+  Serial.print(F("  (ID="));
+  Serial.print(id);
+  Serial.println(F(")"));
+  if (id >= IR_SMALLD_ID_SIRC12 && id <= IR_SMALLD_ID_SIRC20) {
+    Serial.println(F("Most Sony remotes send 3 frames per keypress, so IR_SMALLD_SIRC (with keyHeld) may also be used."));
+  }
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  pinMode(IR_PIN, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(IR_PIN), edgeISR, CHANGE);
+  Serial.println(F("Press a few different keys on the remote (one at a time)..."));
+}
+
+
+void loop() {
+  uint32_t lastEdgeCopy;
+  noInterrupts();  // 32-bit copies are not atomic on 8-bit MCUs
+  lastEdgeCopy = lastEdgeTime;
+  interrupts();
+
+  // A frame has ended when the receiver's output stays high for longer than FRAME_GAP:
+  if (receiving && digitalRead(IR_PIN) == HIGH && micros() - lastEdgeCopy > FRAME_GAP) {
+    uint8_t id = findProtocol(intervals, intervalCount);
+    receiving = false;  // Ready for the next frame
+    if (id == IR_SMALLD_ID_UNKNOWN) return;  // Repeat codes, noise and unsupported protocols are ignored
+    if (id == lastId) sameIdCount++;
+    else {
+      lastId = id;
+      sameIdCount = 1;
+    }
+    if (sameIdCount == CONFIRMATIONS) printProtocol(id);
+  }
+}
@@ -0,0 +1,95 @@
+/* Sampling mode (no external interrupt needed)
+ *
+ * This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to use the decoder on a pin that doesn't support external interrupts.
+ *
+ * In sampling mode, the decoder's sample() method must be called periodically (every IR_SMALLD_SAMPLE_PERIOD
+ * microseconds), and the edges are detected by comparing each level with the previous one.
+ * Here, the Timer2 compare match interrupt is used to call it every 50µs.
+ *
+ * How to use this sketch:
+ *  - Connect the IR receiver to digital pin 7 (or change IR_PIN);
+ *  - Uncomment the #define for the desired protocol;
+ *    leave the others commented out (only one is allowed);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - The cost of each sample() call is measured and shown at startup;
+ *  - Push buttons on the remote control, you should see the decoded data on the Serial Monitor.
+ *
+ * This sketch uses Timer2 registers, so it only works on boards based on the ATmega328P (and similar) running at
+ * 8 or 16MHz (Uno, Nano, Pro Mini...). On other boards, call sample() from any periodic timer interrupt.
+ * Note that the tone() function also uses Timer2.
+ */
+
+#define IR_SMALLD_NEC
+//#define IR_SMALLD_NECx
+//#define IR_SMALLD_RC5
+//#define IR_SMALLD_SIRC12
+//#define IR_SMALLD_SIRC15
+//#define IR_SMALLD_SIRC20
+//#define IR_SMALLD_SIRC
+//#define IR_SMALLD_SAMSUNG
+//#define IR_SMALLD_SAMSUNG32
+
+#define IR_SMALLD_SAMPLING
+#define IR_SMALLD_SAMPLE_PERIOD 50  // µs (this is the default value)
+#include <IRsmallDecoder.h>
+
+#define IR_PIN 7
+
+#if !defined(TCCR2A)
+  #error This example uses Timer2 (ATmega328P and similar). On other boards, call sample() from a periodic timer.
+#elif (F_CPU / 8 / 1000000) * IR_SMALLD_SAMPLE_PERIOD > 256
+  #error The sample period is too long for Timer2 with a prescaler of 8
+#endif
+
+IRsmallDecoder irDecoder(IR_PIN);  // Any digital pin can be used
+irSmallD_t irData;
+
+
+ISR(TIMER2_COMPA_vect) {
+  irDecoder.sample();
+}
+
+
+void setup() {
+  Serial.begin(115200);
+
+  // Measure how long a sample() call takes (without edges, which is the most common case):
+  const uint16_t calls = 1000;
+  uint32_t start = micros();
+  for (uint16_t i = 0; i < calls; i++) irDecoder.sample();
+  uint32_t elapsed = micros() - start;
+  Serial.print("sample() takes about ");
+  Serial.print((float)elapsed / calls);
+  Serial.print("us, ");
+  Serial.print(100.0 * elapsed / calls / IR_SMALLD_SAMPLE_PERIOD);
+  Serial.println("% of the CPU time");
+  irDecoder.enable();  // Reset the decoder after the measurements
+
+  // Timer2 in CTC mode, prescaler 8, interrupt every IR_SMALLD_SAMPLE_PERIOD µs:
+  noInterrupts();
+  TCCR2A = (1 << WGM21);
+  TCCR2B = (1 << CS21);
+  TCNT2 = 0;
+  OCR2A = (F_CPU / 8 / 1000000) * IR_SMALLD_SAMPLE_PERIOD - 1;
+  TIMSK2 = (1 << OCIE2A);
+  interrupts();
+
+  Serial.println("Waiting for a remote control IR signal...");
+  Serial.println("held \t addr \t cmd");
+}
+
+
+void loop() {
+  if (irDecoder.dataAvailable(irData)) {
+    #if !defined(IR_SMALLD_HAS_KEYHELD)
+      Serial.print("-");  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
+    #else
+      Serial.print(irData.keyHeld, HEX);
+    #endif
+    Serial.print("\t ");
+    Serial.print(irData.addr, HEX);
+    Serial.print("\t ");
+    Serial.println(irData.cmd, HEX);
+  }
+}
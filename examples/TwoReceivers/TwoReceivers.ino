@@ -0,0 +1,71 @@
+/* Two IR receivers (diversity)
+ *
+ * This example is part of the IRsmallDecoder library and is intended to demonstrate
+ * how to decode the signals of two IR receivers, placed in different spots (or facing different directions),
+ * as if they were a single receiver with a wider coverage.
+ *
+ * Each receiver is decoded separately; the first one to complete a frame wins, and the same frame
+ * from the other receiver is discarded (it's a duplicate). The number of frames won by each receiver
+ * is shown every 10 seconds, which helps to find the best placement for both.
+ *
+ * How to use this sketch:
+ *  - Connect one IR receiver to digital pin 2 and the other to digital pin 3
+ *    (both pins must support external interrupts);
+ *  - Uncomment the #define for the desired protocol;
+ *    leave the others commented out (only one is allowed);
+ *  - Upload the sketch and open the Serial Monitor;
+ *  - Push buttons on the remote control, from different places in the room.
+ *
+ * For more information on the usable pins of each board, see the library documentation at:
+ * https://github.com/LuisMiCa/IRsmallDecoder
+ * or read the README.pdf file in the extras folder of this library.
+ */
+
+#define IR_SMALLD_NEC
+//#define IR_SMALLD_NECx
+//#define IR_SMALLD_RC5
+//#define IR_SMALLD_SIRC12
+//#define IR_SMALLD_SIRC15
+//#define IR_SMALLD_SIRC20
+//#define IR_SMALLD_SIRC
+//#define IR_SMALLD_SAMSUNG
+//#define IR_SMALLD_SAMSUNG32
+
+#define IR_SMALLD_DIVERSITY
+#include <IRsmallDecoder.h>
+
+IRsmallDecoder irDecoder(2, 3);  // Receiver 0 on pin 2, receiver 1 on pin 3
+irSmallD_t irData;
+uint32_t lastReport = 0;
+
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("Waiting for a remote control IR signal...");
+  Serial.println("held \t addr \t cmd");
+}
+
+
+void loop() {
+  if (irDecoder.dataAvailable(irData)) {
+    #if !defined(IR_SMALLD_HAS_KEYHELD)
+      Serial.print("-");  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
+    #else
+      Serial.print(irData.keyHeld, HEX);
+    #endif
+    Serial.print("\t ");
+    Serial.print(irData.addr, HEX);
+    Serial.print("\t ");
+    Serial.println(irData.cmd, HEX);
+  }
+
+  if (millis() - lastReport >= 10000) {
+    lastReport = millis();
+    Serial.print("Frames won by receiver 0: ");
+    Serial.print(irDecoder.receiverWins(0));
+    Serial.print(", by receiver 1: ");
+    Serial.print(irDecoder.receiverWins(1));
+    Serial.print(", received by both: ");
+    Serial.println(irDecoder.duplicateFrames());
+  }
+}
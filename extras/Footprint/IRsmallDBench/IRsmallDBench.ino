@@ -0,0 +1,285 @@
+/* IRsmallDBench - Measures the decoder's CPU cycles per edge on AVR boards (used by footprint.sh)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * The protocol is selected with a compiler flag (footprint.sh passes -DIR_SMALLD_<protocol>), NEC by default.
+ *
+ * The sketch builds a nominal frame of the selected protocol and feeds it to the decoder, c_frames times, through the
+ * edge buffer input. So, the ISR runs exactly as it would for each edge, except for the micros() call, which is
+ * replaced by the buffer's time. Timer1 counts the CPU cycles of each decodeBuffer() call, with interrupts disabled,
+ * and the result is printed as a single line:
+ *   IRsmallDBench NEC: 1980 edges, 150480 cycles, 76 cycles/edge, 5016 cycles/frame, 30 frames decoded
+ * The cycles per frame are the ones to compare when the number of edges changes (e.g. IR_SMALLD_DUAL_EDGE, which
+ * makes the ISR run on both edges).
+ * With -DIR_SMALLD_SAMPLING, the frames are fed to sample(level) instead, one call per sample period (including the
+ * gap up to the next frame), and Timer1 counts the cycles of each call. The ticks without an edge (which only count
+ * the time and check the timeout) and the ones with an edge are averaged separately, and the cycles per frame are
+ * those of all the ticks of a frame period. Then, Timer1 calls sample() (which reads the pin with digitalRead())
+ * from its compare interrupt, every IR_SMALLD_SAMPLE_PERIOD µs, and the CPU share of that interrupt is measured by
+ * counting the iterations of a loop for 100ms, with and without it:
+ *   IRsmallDBench NEC, sampling every 50us: 64800 ticks, 2040 edges, <c> cycles, <i> cycles/idle tick, <e> cycles/edge,
+ *   <f> cycles/frame, <s>% of the CPU, 30 frames decoded
+ * It runs on a board (ATmega328P, ATmega2560, ATmega32U4...) or in simavr, which prints the UART's output.
+ */
+
+#if !defined(IR_SMALLD_NEC) && !defined(IR_SMALLD_NECx) && !defined(IR_SMALLD_RC5) && !defined(IR_SMALLD_SIRC12) && \
+    !defined(IR_SMALLD_SIRC15) && !defined(IR_SMALLD_SIRC20) && !defined(IR_SMALLD_SIRC) &&                       \
+    !defined(IR_SMALLD_SAMSUNG) && !defined(IR_SMALLD_SAMSUNG32) && !defined(IR_SMALLD_HASH)
+  #define IR_SMALLD_NEC
+#endif
+#if !defined(IR_SMALLD_SAMPLING)
+  #define IR_SMALLD_EDGE_BUFFER
+  #define IR_SMALLD_NO_TIMEOUT  // The frames' times are synthetic, micros() would time out the FSM between frames
+#endif
+#include <IRsmallDecoder.h>
+
+#if !defined(__AVR__)
+  #error IRsmallDBench measures the cycles with Timer1 of the AVR boards
+#endif
+
+const uint8_t c_frames = 30;
+
+#if defined(IR_SMALLD_SAMPLING)
+  IRsmallDecoder irDecoder(2);  // Unconnected (pulled up): the pin stays HIGH while the CPU share is measured
+#else
+  IRsmallDecoder irDecoder;
+#endif
+irSmallD_t irData;
+#if defined(IR_SMALLD_SAMPLING)
+  struct irSmallD_pulse_t {  // As the edge buffer's items
+    uint16_t duration : 15;
+    uint16_t level    : 1;
+  };
+#endif
+irSmallD_pulse_t frame[72];
+uint8_t items;
+uint32_t period;  // Frame repetition period (µs)
+
+
+void add(uint16_t duration, uint8_t level) {  // Adds a pulse (LOW, IR light detected) or a space (HIGH)
+  if (items && frame[items - 1].level == level) frame[items - 1].duration += duration;  // Merges the RC5 half bits
+  else {
+    frame[items].duration = duration;
+    frame[items].level = level;
+    items++;
+  }
+}
+
+
+// Pulse distance (NEC, SAMSUNG) and pulse width (SIRC) frames, from a code sent LSB first:
+void addBits(uint32_t code, uint8_t bits, uint16_t pulse0, uint16_t pulse1, uint16_t space0, uint16_t space1) {
+  for (uint8_t i = 0; i < bits; i++, code >>= 1) {
+    add(code & 1 ? pulse1 : pulse0, LOW);
+    add(code & 1 ? space1 : space0, HIGH);
+  }
+}
+
+
+void buildFrame() {
+  items = 0;
+  #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_NECx) || defined(IR_SMALLD_HASH)
+    add(9000, LOW);
+    add(4500, HIGH);
+    addBits(0xD02FFF00, 32, 562, 562, 562, 1687);  // addr 0x00, cmd 0x2F
+    add(562, LOW);
+    period = 108000;
+  #elif defined(IR_SMALLD_SAMSUNG)
+    add(4500, LOW);
+    add(4500, HIGH);
+    addBits(0x2F707, 20, 562, 562, 562, 1687);     // addr 0x707, cmd 0x2F
+    add(562, LOW);
+    period = 60000;
+  #elif defined(IR_SMALLD_SAMSUNG32)
+    add(4500, LOW);
+    add(4500, HIGH);
+    addBits(0xD02F0707, 32, 562, 562, 562, 1687);  // addr 0x07, cmd 0x2F
+    add(562, LOW);
+    period = 108000;
+  #elif defined(IR_SMALLD_RC5)
+    const uint16_t code = 0x3000 | (0x01 << 6) | 0x2F;  // Start and field bits, addr 0x01, cmd 0x2F
+    for (int8_t i = 13; i >= 0; i--) {                  // MSB first, a 1 is a space followed by a pulse
+      add(889, (code >> i) & 1 ? HIGH : LOW);
+      add(889, (code >> i) & 1 ? LOW : HIGH);
+    }
+    if (frame[0].level == HIGH) {  // The first space is just the idle line
+      for (uint8_t i = 1; i < items; i++) frame[i - 1] = frame[i];
+      items--;
+    }
+    if (frame[items - 1].level == HIGH) items--;
+    period = 113792;
+  #else  // SIRC
+    add(2400, LOW);
+    add(600, HIGH);
+    #if defined(IR_SMALLD_SIRC15)
+      addBits(0x0197, 15, 600, 1200, 600, 600);    // addr 0x03, cmd 0x17
+    #elif defined(IR_SMALLD_SIRC20)
+      addBits(0x01197, 20, 600, 1200, 600, 600);   // ext 0x01, addr 0x03, cmd 0x17
+    #else
+      addBits(0x0197, 12, 600, 1200, 600, 600);    // addr 0x03, cmd 0x17
+    #endif
+    items--;  // Ends with the last bit's pulse
+    period = 45000;
+  #endif
+}
+
+
+void printProtocol() {
+  Serial.print(F("IRsmallDBench "));
+  #if defined(IR_SMALLD_NEC)
+    Serial.print(F("NEC"));
+  #elif defined(IR_SMALLD_NECx)
+    Serial.print(F("NECx"));
+  #elif defined(IR_SMALLD_RC5)
+    Serial.print(F("RC5"));
+  #elif defined(IR_SMALLD_SIRC12)
+    Serial.print(F("SIRC12"));
+  #elif defined(IR_SMALLD_SIRC15)
+    Serial.print(F("SIRC15"));
+  #elif defined(IR_SMALLD_SIRC20)
+    Serial.print(F("SIRC20"));
+  #elif defined(IR_SMALLD_SIRC)
+    Serial.print(F("SIRC"));
+  #elif defined(IR_SMALLD_SAMSUNG)
+    Serial.print(F("SAMSUNG"));
+  #elif defined(IR_SMALLD_SAMSUNG32)
+    Serial.print(F("SAMSUNG32"));
+  #else
+    Serial.print(F("HASH"));
+  #endif
+}
+
+
+#if defined(IR_SMALLD_SAMPLING)
+volatile uint32_t loops;
+
+ISR(TIMER1_COMPA_vect) {
+  irDecoder.sample();
+}
+
+uint32_t countLoops() {  // Iterations of an empty loop in 100ms
+  loops = 0;
+  uint32_t start = micros();
+  while (micros() - start < 100000) loops = loops + 1;
+  return loops;
+}
+
+
+void setup() {
+  Serial.begin(115200);
+  buildFrame();
+
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);  // No prescaler: Timer1 counts CPU cycles
+  noInterrupts();
+  TCNT1 = 0;
+  uint16_t overhead = TCNT1;  // Cycles of the measurement itself
+  interrupts();
+
+  for (uint32_t ticks = period / IR_SMALLD_SAMPLE_PERIOD; ticks; ticks--) irDecoder.sample(HIGH);  // A gap first
+  uint32_t idleCycles = 0, edgeCycles = 0, idleTicks = 0, edgeTicks = 0;
+  uint8_t decoded = 0, level = HIGH;
+  for (uint8_t i = 0; i < c_frames; i++) {
+    uint32_t ticks = period / IR_SMALLD_SAMPLE_PERIOD;  // Ticks left in this frame period (the rest is the gap)
+    for (uint8_t j = 0; j <= items; j++) {
+      uint8_t itemLevel = j < items ? frame[j].level : HIGH;
+      uint32_t itemTicks = j < items ? (frame[j].duration + IR_SMALLD_SAMPLE_PERIOD / 2) / IR_SMALLD_SAMPLE_PERIOD : ticks;
+      ticks -= itemTicks;
+      for (; itemTicks; itemTicks--) {
+        noInterrupts();
+        TCNT1 = 0;
+        irDecoder.sample(itemLevel);
+        uint16_t count = TCNT1 - overhead;
+        interrupts();
+        if (itemLevel != level) {
+          edgeCycles += count;
+          edgeTicks++;
+        }
+        else {
+          idleCycles += count;
+          idleTicks++;
+        }
+        level = itemLevel;
+      }
+    }
+    if (irDecoder.dataAvailable(irData)) decoded++;
+  }
+
+  // CPU share of the timer interrupt, which calls sample() every IR_SMALLD_SAMPLE_PERIOD µs:
+  uint32_t freeLoops = countLoops();
+  noInterrupts();
+  TCCR1B = 0;
+  TCNT1 = 0;
+  OCR1A = (F_CPU / 1000000) * IR_SMALLD_SAMPLE_PERIOD - 1;
+  TCCR1B = _BV(WGM12) | _BV(CS10);  // CTC mode, no prescaler
+  TIMSK1 = _BV(OCIE1A);
+  interrupts();
+  uint32_t sampledLoops = countLoops();
+  TIMSK1 = 0;
+
+  uint32_t cycles = idleCycles + edgeCycles;
+  printProtocol();
+  Serial.print(F(", sampling every "));
+  Serial.print(IR_SMALLD_SAMPLE_PERIOD);
+  Serial.print(F("us: "));
+  Serial.print(idleTicks + edgeTicks);
+  Serial.print(F(" ticks, "));
+  Serial.print(edgeTicks);
+  Serial.print(F(" edges, "));
+  Serial.print(cycles);
+  Serial.print(F(" cycles, "));
+  Serial.print((idleCycles + idleTicks / 2) / idleTicks);  // Rounded
+  Serial.print(F(" cycles/idle tick, "));
+  Serial.print((edgeCycles + edgeTicks / 2) / edgeTicks);
+  Serial.print(F(" cycles/edge, "));
+  Serial.print((cycles + c_frames / 2) / c_frames);
+  Serial.print(F(" cycles/frame, "));
+  Serial.print(100.0 * ((float)freeLoops - sampledLoops) / freeLoops, 1);
+  Serial.print(F("% of the CPU, "));
+  Serial.print(decoded);
+  Serial.println(F(" frames decoded"));
+}
+
+#else
+void setup() {
+  Serial.begin(115200);
+  buildFrame();
+
+  uint16_t edges = (IR_ISR_MODE == CHANGE || (IR_ISR_MODE == RISING) == (frame[0].level == HIGH));
+  for (uint8_t i = 0; i < items; i++) edges += (IR_ISR_MODE == CHANGE || (IR_ISR_MODE == RISING) == (frame[i].level == LOW));
+
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);  // No prescaler: Timer1 counts CPU cycles (a frame takes much less than 65536 cycles)
+  uint32_t start = micros(), cycles = 0;
+  uint8_t decoded = 0;
+  for (uint8_t i = 0; i < c_frames; i++) {
+    start += period;  // Each frame starts one period after the previous one
+    noInterrupts();
+    TCNT1 = 0;
+    irDecoder.decodeBuffer(frame, items, start);
+    uint16_t count = TCNT1;
+    interrupts();
+    cycles += count;
+    if (irDecoder.dataAvailable(irData)) decoded++;
+  }
+
+  printProtocol();
+  uint32_t total = (uint32_t)edges * c_frames;
+  Serial.print(F(": "));
+  Serial.print(total);
+  Serial.print(F(" edges, "));
+  Serial.print(cycles);
+  Serial.print(F(" cycles, "));
+  Serial.print((cycles + total / 2) / total);  // Rounded
+  Serial.print(F(" cycles/edge, "));
+  Serial.print((cycles + c_frames / 2) / c_frames);
+  Serial.print(F(" cycles/frame, "));
+  Serial.print(decoded);
+  Serial.println(F(" frames decoded"));
+}
+
+#endif
+
+
+void loop() {}
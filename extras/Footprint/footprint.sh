@@ -0,0 +1,167 @@
+#!/bin/bash
+# footprint.sh - Flash, SRAM and ISR cycles of each decoder on AVR boards, for tracking regressions
+#
+# This file is part of the IRsmallDecoder library for Arduino
+# Copyright (c) 2020 Luis Carvalho
+#
+#
+# Usage:
+#   ./footprint.sh [-b fqbn] [-f] [-c] [-s mcu] [-u port] [-x flags] [protocol...]
+#     -b  board to compile for (default: arduino:avr:uno)
+#     -f  also build each protocol with the AVR fast path (IR_SMALLD_AVR_FAST), for comparison
+#     -c  print CSV instead of a table
+#     -s  simavr's MCU for the cycle counts (default: atmega328p at 16MHz, the UNO's)
+#     -u  serial port of a board to run the cycle counts on, if simavr isn't installed (the bench sketch is uploaded)
+#     -x  extra compiler flags for every build, e.g. -x "-DIR_SMALLD_DUAL_EDGE" (the reference sketch is not affected)
+#   The protocols are the names of the IR_SMALLD_<protocol> macros (default: all of them).
+#
+# Requirements: arduino-cli, with the board's core installed (arduino-cli core install arduino:avr), and avr-size,
+# which comes with the core's toolchain (it's searched in the PATH and in ~/.arduino15). The cycle counts need simavr
+# or a board; without them, that column is left empty.
+#
+# Sizes are measured the same way as in the README's Appendix A: a reference sketch (the ToggleLED example without
+# the library) and the same sketch with the decoder are compiled, and the difference is the decoder's footprint.
+#   text, data, bss: sections of the sketch with the decoder, from avr-size -A;
+#   flash:           program memory used by the decoder (text + data, minus the reference sketch's);
+#   ram:             static data used by the decoder (data + bss, minus the reference sketch's);
+#   cycles/edge:     mean CPU cycles per edge, measured by the IRsmallDBench sketch (see its header);
+#   cycles/frame:    mean CPU cycles per frame, from the same run (compare these when the flags change the edge count).
+# With -x -DIR_SMALLD_SAMPLING, the bench feeds the frames to sample() instead, one call per sample period, and the
+# cycles per edge are those of the calls with an edge, and the cycles per frame those of all the calls in a frame period.
+# Two more columns are filled then:
+#   cycles/tick:     mean CPU cycles of the calls without an edge;
+#   cpu:             CPU share of a timer interrupt that calls sample() (with digitalRead()) every sample period.
+
+set -o pipefail
+
+fqbn="arduino:avr:uno"
+compare=0
+csv=0
+mcu="atmega328p"
+port=""
+extra=""
+while getopts "b:fcs:u:x:h" opt; do
+  case $opt in
+    b) fqbn=$OPTARG ;;
+    f) compare=1 ;;
+    c) csv=1 ;;
+    s) mcu=$OPTARG ;;
+    u) port=$OPTARG ;;
+    x) extra=$OPTARG ;;
+    *) sed -n '8,17p' "$0" >&2; exit 2 ;;
+  esac
+done
+shift $((OPTIND - 1))
+protocols=${*:-"NEC NECx RC5 SIRC12 SIRC15 SIRC20 SIRC SAMSUNG SAMSUNG32 HASH"}
+
+here=$(cd "$(dirname "$0")" && pwd)
+library=$(cd "$here/../.." && pwd)
+work=$(mktemp -d)
+mkdir -p "$work/build"
+trap 'rm -rf "$work"' EXIT
+
+command -v arduino-cli > /dev/null || { echo "arduino-cli not found" >&2; exit 1; }
+size=$(command -v avr-size || ls -d "$HOME"/.arduino15/packages/arduino/tools/avr-gcc/*/bin/avr-size 2> /dev/null | tail -1)
+[ -x "$size" ] || { echo "avr-size not found" >&2; exit 1; }
+simavr=$(command -v simavr)
+
+
+# The reference sketch and the sketch with the decoder (the protocol is selected with a compiler flag):
+mkdir -p "$work/Reference" "$work/Footprint"
+cat > "$work/Reference/Reference.ino" << 'EOF'
+int ledState=LOW;
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+}
+void loop() {
+    ledState=(ledState==LOW)? HIGH:LOW;
+    digitalWrite(LED_BUILTIN,ledState);
+}
+EOF
+cat > "$work/Footprint/Footprint.ino" << 'EOF'
+#include <IRsmallDecoder.h>
+IRsmallDecoder irDecoder(2);
+irSmallD_t irData;
+int ledState=LOW;
+void setup() {
+  pinMode(LED_BUILTIN, OUTPUT);
+}
+void loop() {
+  if(irDecoder.dataAvailable(irData)){
+    ledState=(ledState==LOW)? HIGH:LOW;
+    digitalWrite(LED_BUILTIN,ledState);
+  }
+}
+EOF
+
+
+# Compiles a sketch with extra flags and prints its ELF file (the build folder is named after the flags):
+compile() {  # sketch flags
+  local build="$work/build/$(basename "$1")${2// /_}"
+  arduino-cli compile --fqbn "$fqbn" --library "$library" --build-path "$build" \
+    --build-property "compiler.cpp.extra_flags=$2" "$1" > "$build.log" 2>&1 || {
+    echo "Compilation failed ($(basename "$1") $2):" >&2
+    tail -20 "$build.log" >&2
+    return 1
+  }
+  echo "$build/$(basename "$1").ino.elf"
+}
+
+# Prints the sizes of the .text, .data and .bss sections:
+sections() {  # elf
+  "$size" -A "$1" | awk '$1 == ".text" {t = $2} $1 == ".data" {d = $2} $1 == ".bss" {b = $2} END {print t + 0, d + 0, b + 0}'
+}
+
+# Runs the bench sketch and prints the cycles per edge and per frame, and per idle tick and the CPU share if it
+# samples (or nothing):
+cycles() {  # elf
+  local line
+  if [ -n "$simavr" ]; then
+    line=$(timeout 20 "$simavr" -m "$mcu" -f 16000000 "$1" 2>&1 | grep -a -m1 "IRsmallDBench")
+  elif [ -n "$port" ]; then
+    arduino-cli upload --fqbn "$fqbn" -p "$port" --input-file "${1%.elf}.hex" > /dev/null 2>&1 || return
+    stty -F "$port" 115200 raw -echo 2> /dev/null
+    line=$(timeout 5 grep -a -m1 "IRsmallDBench" "$port")
+  fi
+  echo "$line" | sed -n 's/.* \([0-9]*\) cycles\/edge, \([0-9]*\) cycles\/frame.*/\1 \2/p' | tr '\n' ' '
+  echo "$line" | sed -n 's/.* \([0-9]*\) cycles\/idle tick, .* \([0-9.]*\)% of the CPU.*/\1 \2/p'
+}
+
+
+reference=$(compile "$work/Reference" "") || exit 1
+read -r refText refData refBss <<< "$(sections "$reference")"
+
+if [ $csv = 1 ]; then
+  echo "protocol,variant,text,data,bss,flash,ram,cycles_per_edge,cycles_per_frame,cycles_per_tick,cpu"
+else
+  printf "%-10s %-8s %7s %6s %6s %7s %5s %12s %13s %12s %6s\n" protocol variant text data bss flash ram cycles/edge \
+    cycles/frame cycles/tick cpu
+fi
+
+variants="default"
+[ $compare = 1 ] && variants="default fast"
+status=0
+for protocol in $protocols; do
+  for variant in $variants; do
+    flags="-DIR_SMALLD_$protocol${extra:+ $extra}"
+    [ $variant = fast ] && flags="$flags -DIR_SMALLD_AVR_FAST"
+    elf=$(compile "$work/Footprint" "$flags") || { status=1; continue; }
+    read -r text data bss <<< "$(sections "$elf")"
+    flash=$((text + data - refText - refData))
+    ram=$((data + bss - refData - refBss))
+    perEdge=""
+    perFrame=""
+    perTick=""
+    cpu=""
+    if [ -n "$simavr" ] || [ -n "$port" ]; then
+      bench=$(compile "$here/IRsmallDBench" "$flags") && read -r perEdge perFrame perTick cpu <<< "$(cycles "$bench")"
+    fi
+    if [ $csv = 1 ]; then
+      echo "$protocol,$variant,$text,$data,$bss,$flash,$ram,$perEdge,$perFrame,$perTick,$cpu"
+    else
+      printf "%-10s %-8s %7d %6d %6d %7d %5d %12s %13s %12s %6s\n" "$protocol" "$variant" "$text" "$data" "$bss" "$flash" "$ram" \
+        "$perEdge" "$perFrame" "$perTick" "${cpu:+$cpu%}"
+    fi
+  done
+done
+exit $status
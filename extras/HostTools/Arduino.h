@@ -0,0 +1,114 @@
+/* Arduino.h - Minimal Arduino API for running the decoders on a host computer (Linux)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Notes:
+ * - It's NOT used by the Arduino IDE; it's only meant for the host tools in this folder.
+ * - It provides just enough of the Arduino API for the IRsmallDecoder.h to compile, so the tools run exactly the
+ *   same ISRs (and FSMs) that run on the microcontrollers.
+ * - There is no real time: micros() returns the value set with IRsmallDHost::setMicros(), so the tools can feed
+ *   edges from a capture (or a synthetic signal) at their original timestamps, as fast as possible. It's an atomic,
+ *   so that a thread can read the time set by another (irhandoff runs the ISR and dataAvailable() on two threads).
+ * - attachInterrupt() does not attach anything, it just stores the ISR and its mode; the tools call
+ *   IRsmallDHost::edge(level) for each level change, and the ISR is called if the mode matches the edge.
+ * - Serial.print() calls (used by the debug macros) are forwarded to optional callbacks.
+ * - ARDUINO must be defined (as 100 or above) before including IRsmallDecoder.h.
+ */
+
+#ifndef IRsmallD_HostArduino_h
+#define IRsmallD_HostArduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+#define LOW          0
+#define HIGH         1
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define CHANGE       1
+#define FALLING      2
+#define RISING       3
+#define HEX          16
+#define DEC          10
+
+#define PROGMEM
+#define F(s)               (s)
+#define pgm_read_byte(p)   (*(const uint8_t *)(p))
+#define pgm_read_word(p)   (*(const uint16_t *)(p))
+#define pgm_read_dword(p)  (*(const uint32_t *)(p))
+#define memcpy_P           memcpy
+
+
+namespace IRsmallDHost {
+  struct State {
+    std::atomic<uint32_t> micros{0};
+    uint8_t  level = HIGH;       // The receiver's output is high when idle (active low)
+    void   (*isr)() = nullptr;
+    int      isrMode = 0;
+    void   (*onPrintNumber)(long value) = nullptr;
+    void   (*onPrintText)(const char *text) = nullptr;
+  };
+
+  inline State &state() { static State s; return s; }
+
+  inline void setMicros(uint32_t time) { state().micros.store(time, std::memory_order_relaxed); }
+
+  // Sets the input level and calls the ISR if the edge matches its mode (returns true if it was called):
+  inline bool edge(uint8_t level) {
+    State &s = state();
+    if (level == s.level) return false;  // Not an edge
+    s.level = level;
+    if (!s.isr || (s.isrMode != CHANGE && (s.isrMode == RISING) != (level == HIGH))) return false;
+    s.isr();
+    return true;
+  }
+}
+
+
+inline uint32_t micros() { return IRsmallDHost::state().micros.load(std::memory_order_relaxed); }
+inline uint32_t millis() { return micros() / 1000; }
+inline int  digitalRead(uint8_t) { return IRsmallDHost::state().level; }
+inline void pinMode(uint8_t, uint8_t) {}
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t, void (*isr)(), int mode) {
+  IRsmallDHost::state().isr = isr;
+  IRsmallDHost::state().isrMode = mode;
+}
+inline void detachInterrupt(uint8_t) { IRsmallDHost::state().isr = nullptr; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void yield() {}
+
+
+class Print {  // Only write() (for IRsmallDUplink.h)
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t byte) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+      size_t n = 0;
+      while (size--) n += write(*buffer++);
+      return n;
+    }
+};
+
+
+struct IRsmallDHostSerial {
+  void begin(unsigned long) {}
+  void print(const char *text) { if (IRsmallDHost::state().onPrintText) IRsmallDHost::state().onPrintText(text); }
+  void print(long value, int = DEC) { if (IRsmallDHost::state().onPrintNumber) IRsmallDHost::state().onPrintNumber(value); }
+  void print(unsigned long value, int base = DEC) { print((long)value, base); }
+  void print(int value, int base = DEC) { print((long)value, base); }
+  void print(unsigned int value, int base = DEC) { print((long)value, base); }
+  void print(double) {}
+  template <class T> void println(T value) { print(value); print("\n"); }
+  void println() { print("\n"); }
+};
+
+static IRsmallDHostSerial Serial __attribute__((unused));
+
+#endif
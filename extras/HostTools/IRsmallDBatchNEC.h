@@ -0,0 +1,276 @@
+/* IRsmallDBatchNEC - Batch decoding of NEC/NECx duration arrays (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * How it works:
+ * -------------
+ * Instead of one ISR call per edge, a whole array of durations (the intervals between consecutive rising edges,
+ * i.e., the same intervals measured by the NEC ISR) is decoded in two passes:
+ *   1. classify() converts each duration into a symbol, which is the number of thresholds it reaches.
+ *      This is done without branches, 8 (AVX2) or 4 (SSE2) durations at a time, with a scalar fallback;
+ *   2. decode() runs the NEC FSM over the symbols. It's the same FSM as in IRsmallD_NEC.h, but each
+ *      state only has to look at one small integer instead of comparing the duration with its thresholds.
+ *      After a leading mark, the next 32 symbols are checked at once and, if they are all bit marks, the
+ *      whole frame is assembled from a bit mask (otherwise, they go through the FSM one by one).
+ *
+ * The thresholds are calculated from the same definitions (and with the same conversions) used by the ISR, and the
+ * timeout resets are emulated as if the decoder was being polled continuously, so the decoded data is identical
+ * to the data returned by dataAvailable() (irbatch.cpp verifies it).
+ *
+ * Notes:
+ *   - IRsmallDecoder.h must be included first, with IR_SMALLD_NEC or IR_SMALLD_NECx defined;
+ *   - Data is never lost because of a pending copy (there's no _irCopyingData in here).
+ */
+
+#ifndef IRsmallD_BatchNEC_h
+#define IRsmallD_BatchNEC_h
+
+#if !defined(IR_SMALLD_NEC) && !defined(IR_SMALLD_NECx)
+  #error IRsmallDBatchNEC.h requires IR_SMALLD_NEC or IR_SMALLD_NECx
+#endif
+
+#include <stddef.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+  #include <immintrin.h>
+#endif
+
+
+// Symbols (each one is the number of thresholds reached by the duration):
+enum irNecSymbol_t : uint8_t {
+  NEC_SYM_SHORT,     // Too short for anything (error)
+  NEC_SYM_M0,        // Bit 0 mark
+  NEC_SYM_M1,        // Bit 1 mark
+  NEC_SYM_M1_RM,     // Bit 1 mark or repeat mark (the two ranges overlap)
+  NEC_SYM_RM,        // Repeat mark
+  NEC_SYM_LM,        // Leading mark
+  NEC_SYM_OTHER,     // Too long for a mark, too short for a gap (error)
+  NEC_SYM_GAP,       // Gap before a frame or a repeat mark
+  NEC_SYM_LONG_GAP   // Gap, too long for a held key
+};
+
+
+class IRsmallDBatchNEC {
+  public:
+    // Thresholds in microseconds, exactly as in the ISR:
+    static const uint16_t c_GapMin = NEC_GAP_1 * 0.7;
+    static const uint32_t c_GapMax = NEC_GAP_2 * 1.3;
+    static const uint16_t c_RMmin = NEC_R_MARK * 0.7;
+    static const uint16_t c_RMmax = NEC_R_MARK + NEC_R_TOL;
+    static const uint16_t c_LMmin = c_RMmax + 1;
+    static const uint16_t c_LMmax = NEC_L_MARK * 1.3;
+    static const uint16_t c_M1min = NEC_MARK_1 * 0.7;
+    static const uint16_t c_M1max = NEC_MARK_1 * 1.3;
+    static const uint16_t c_M0min = NEC_MARK_0 * 0.7;
+    static const uint8_t  c_RptCount = 2;
+
+    static const uint8_t c_thresholdCount = 8;
+    static const uint32_t *thresholds() {  // A duration d reaches threshold t if d >= t
+      static const uint32_t t[c_thresholdCount] = {
+        c_M0min, c_M1min, c_RMmin, c_M1max + 1u, c_LMmin, c_LMmax + 1u, c_GapMin + 1u, c_GapMax + 1u};
+      return t;
+    }
+
+    static uint8_t classify(uint32_t duration) {
+      const uint32_t *t = thresholds();
+      uint8_t symbol = 0;
+      for (uint8_t i = 0; i < c_thresholdCount; i++) symbol += (duration >= t[i]);
+      return symbol;
+    }
+
+    static void classifyScalar(const uint32_t *durations, uint8_t *symbols, size_t count) {
+      for (size_t i = 0; i < count; i++) symbols[i] = classify(durations[i]);
+    }
+
+    static void classify(const uint32_t *durations, uint8_t *symbols, size_t count);
+
+    /**
+     * Runs the FSM over the symbols (the state is kept between calls, so an array can be decoded in parts).
+     * For each decoded frame, onFrame(index, irData) is called, where index is the position of the duration
+     * that completed it.
+     */
+    template <class OnFrame> void decode(const uint32_t *durations, const uint8_t *symbols, size_t count, OnFrame &onFrame);
+
+  private:
+    static bool frameBits(const uint8_t *symbols, uint32_t &bits);
+    template <class OnFrame> void endOfFrame(size_t i, OnFrame &onFrame);
+
+    uint8_t  _state = 0;
+    uint8_t  _bitCount = 0;
+    uint8_t  _repeatCount = 0;
+    bool     _possiblyHeld = false;
+    uint32_t _irSignal = 0;
+    irSmallD_t _irData = {};
+};
+
+
+#if defined(__AVX2__)
+inline void IRsmallDBatchNEC::classify(const uint32_t *durations, uint8_t *symbols, size_t count) {
+  // There are no unsigned comparisons: the sign bit is flipped so that signed comparisons can be used
+  const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);  // Undoes the per-lane packing
+  __m256i limit[c_thresholdCount];
+  for (uint8_t i = 0; i < c_thresholdCount; i++) limit[i] = _mm256_set1_epi32((int32_t)((thresholds()[i] - 1) ^ 0x80000000u));
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    __m256i sum[4];
+    for (uint8_t v = 0; v < 4; v++) {
+      __m256i d = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(durations + i + v * 8)), bias);
+      sum[v] = _mm256_setzero_si256();
+      for (uint8_t t = 0; t < c_thresholdCount; t++) sum[v] = _mm256_sub_epi32(sum[v], _mm256_cmpgt_epi32(d, limit[t]));
+    }
+    __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(sum[0], sum[1]), _mm256_packs_epi32(sum[2], sum[3]));
+    _mm256_storeu_si256((__m256i *)(symbols + i), _mm256_permutevar8x32_epi32(packed, order));
+  }
+  classifyScalar(durations + i, symbols + i, count - i);
+}
+
+// Checks if the next 32 symbols are all bit marks and gets their bits (the first one is the LSB):
+inline bool IRsmallDBatchNEC::frameBits(const uint8_t *symbols, uint32_t &bits) {
+  __m256i s = _mm256_loadu_si256((const __m256i *)symbols);
+  __m256i invalid = _mm256_or_si256(_mm256_cmpeq_epi8(s, _mm256_setzero_si256()),
+                                    _mm256_cmpgt_epi8(s, _mm256_set1_epi8(NEC_SYM_M1_RM)));
+  if (_mm256_movemask_epi8(invalid)) return false;
+  bits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(s, _mm256_set1_epi8(NEC_SYM_M0)));
+  return true;
+}
+
+#elif defined(__SSE2__)
+inline void IRsmallDBatchNEC::classify(const uint32_t *durations, uint8_t *symbols, size_t count) {
+  const __m128i bias = _mm_set1_epi32(INT32_MIN);  // Same trick as above (SSE2 has no unsigned comparisons)
+  __m128i limit[c_thresholdCount];
+  for (uint8_t i = 0; i < c_thresholdCount; i++) limit[i] = _mm_set1_epi32((int32_t)((thresholds()[i] - 1) ^ 0x80000000u));
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i sum[4];
+    for (uint8_t v = 0; v < 4; v++) {
+      __m128i d = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(durations + i + v * 4)), bias);
+      sum[v] = _mm_setzero_si128();
+      for (uint8_t t = 0; t < c_thresholdCount; t++) sum[v] = _mm_sub_epi32(sum[v], _mm_cmpgt_epi32(d, limit[t]));
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sum[0], sum[1]), _mm_packs_epi32(sum[2], sum[3]));
+    _mm_storeu_si128((__m128i *)(symbols + i), packed);
+  }
+  classifyScalar(durations + i, symbols + i, count - i);
+}
+
+inline bool IRsmallDBatchNEC::frameBits(const uint8_t *symbols, uint32_t &bits) {
+  __m128i s0 = _mm_loadu_si128((const __m128i *)symbols);
+  __m128i s1 = _mm_loadu_si128((const __m128i *)(symbols + 16));
+  const __m128i zero = _mm_setzero_si128(), m0 = _mm_set1_epi8(NEC_SYM_M0), m1rm = _mm_set1_epi8(NEC_SYM_M1_RM);
+  __m128i invalid = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s0, zero), _mm_cmpgt_epi8(s0, m1rm)),
+                                 _mm_or_si128(_mm_cmpeq_epi8(s1, zero), _mm_cmpgt_epi8(s1, m1rm)));
+  if (_mm_movemask_epi8(invalid)) return false;
+  bits = (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(s0, m0)) | ((uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(s1, m0)) << 16);
+  return true;
+}
+
+#else
+inline void IRsmallDBatchNEC::classify(const uint32_t *durations, uint8_t *symbols, size_t count) {
+  classifyScalar(durations, symbols, count);
+}
+
+inline bool IRsmallDBatchNEC::frameBits(const uint8_t *symbols, uint32_t &bits) {
+  uint32_t b = 0;
+  for (uint8_t i = 0; i < 32; i++) {
+    if (symbols[i] == NEC_SYM_SHORT || symbols[i] > NEC_SYM_M1_RM) return false;
+    b |= (uint32_t)(symbols[i] >= NEC_SYM_M1) << i;
+  }
+  bits = b;
+  return true;
+}
+#endif
+
+
+template <class OnFrame>
+void IRsmallDBatchNEC::decode(const uint32_t *durations, const uint8_t *symbols, size_t count, OnFrame &onFrame) {
+  for (size_t i = 0; i < count; i++) {
+    uint8_t symbol = symbols[i];
+
+    #if not defined(IR_SMALLD_NO_TIMEOUT)
+      if (_state && durations[i] >= IR_SMALLD_TIMEOUT) {  // The decoder would have been reset by the timeout
+        _state = 0;                                          // (resetFSM() always leaves possiblyHeld false)
+        _possiblyHeld = false;
+        symbol = classify(durations[i] - IR_SMALLD_TIMEOUT);  // The next interval starts at the reset
+      }
+    #endif
+
+    switch (_state) {
+      case 0:  // Standby:
+        if (symbol >= NEC_SYM_GAP) {
+          if (symbol == NEC_SYM_LONG_GAP) _possiblyHeld = false;
+          _state = 1;
+        }
+        else _possiblyHeld = false;
+      break;
+
+      case 1:  // StartPulse:
+        if (symbol == NEC_SYM_LM) {
+          _bitCount = 0;
+          _repeatCount = 0;
+          _state = 2;
+          if (i + 32 < count && frameBits(symbols + i + 1, _irSignal)) {  // Fast path: 32 valid bit marks
+            #if defined(IR_SMALLD_NEC)
+              if ((uint8_t)_irSignal != (uint8_t)~(_irSignal >> 8)) break;  // Address error (slow path)
+              if (!ADDRESS_ALLOWED((uint8_t)_irSignal)) break;               // Filtered address (slow path)
+            #else
+              if (!ADDRESS_ALLOWED((uint16_t)_irSignal)) break;              // Filtered address (slow path)
+            #endif
+            i += 32;
+            _bitCount = 32;
+            endOfFrame(i, onFrame);
+          }
+        } else {
+          if (_possiblyHeld && (symbol == NEC_SYM_M1_RM || symbol == NEC_SYM_RM)) {  // Repeat mark
+            if (_repeatCount < c_RptCount) _repeatCount++;
+            else {                                      // A key was held (same addr and cmd as before)
+              _irData.keyHeld = true;
+              onFrame(i, _irData);
+            }
+          }
+          _state = 0;
+        }
+      break;
+
+      case 2:  // Receiving:
+        if (symbol == NEC_SYM_SHORT || symbol > NEC_SYM_M1_RM) _state = 0;  // Error: not a bit mark
+        else {
+          _irSignal = (_irSignal >> 1) | ((uint32_t)(symbol >= NEC_SYM_M1) << 31);
+          _bitCount++;
+          #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_ADDRESS_FILTER)
+            if (_bitCount == 16) {
+              #if defined(IR_SMALLD_NEC)
+                if ((uint8_t)(_irSignal >> 16) != (uint8_t)~(_irSignal >> 24)) _state = 0;  // Address error
+                else if (!ADDRESS_ALLOWED((uint8_t)(_irSignal >> 16))) { _state = 0; _possiblyHeld = false; }
+              #else
+                if (!ADDRESS_ALLOWED(_irSignal >> 16)) { _state = 0; _possiblyHeld = false; }
+              #endif
+            }
+            else
+          #endif
+          if (_bitCount == 32) endOfFrame(i, onFrame);
+        }
+      break;
+    }
+  }
+}
+
+
+template <class OnFrame>
+inline void IRsmallDBatchNEC::endOfFrame(size_t i, OnFrame &onFrame) {
+  if ((uint8_t)(_irSignal >> 16) == (uint8_t)~(_irSignal >> 24)) {  // Command OK
+    #if defined(IR_SMALLD_NEC)
+      _irData.addr = _irSignal & 0xFF;
+    #else
+      _irData.addr = _irSignal & 0xFFFF;
+    #endif
+    _irData.cmd = (_irSignal >> 16) & 0xFF;
+    _irData.keyHeld = false;
+    onFrame(i, _irData);
+    _possiblyHeld = true;
+  }
+  _state = 0;
+}
+
+#endif
@@ -0,0 +1,356 @@
+/* IRsmallDCapture - Streaming readers for IR receiver captures (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Supported formats:
+ *   list - one edge per line: "<time in µs> [level]"; if the level is omitted, it toggles
+ *          (starting with a falling edge, since the receiver's output is high when idle).
+ *          Lines starting with '#' are ignored.
+ *   csv  - sigrok CSV output (sigrok-cli -O csv), one sample per line. The time is taken from the
+ *          "Time" column, if there is one, or from the "; Samplerate:" comment (or the -r option).
+ *   vcd  - Value Change Dump (sigrok-cli -O vcd, PulseView, most logic analyzer software).
+ *   rec  - dumps of the library's edge recorder (IR_SMALLD_RECORDER), as printed by dumpRecorder(): a
+ *          "#irsmalld-rec" header line, lines of hexadecimal varints, and "#end". Any other lines (e.g. the rest
+ *          of a Serial Monitor log) are ignored. A dump found in a list file is also replayed.
+ *
+ * The files are read in fixed size blocks and parsed on the fly, so memory usage doesn't depend on the
+ * capture's length. For each level change, the callback receives the time (in µs, 64 bits) and the new level.
+ */
+
+#ifndef IRsmallD_Capture_h
+#define IRsmallD_Capture_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <string>
+
+enum irCaptureFormat_t { IR_CAPTURE_LIST, IR_CAPTURE_CSV, IR_CAPTURE_VCD, IR_CAPTURE_REC };
+
+struct irCaptureOptions_t {
+  irCaptureFormat_t format = IR_CAPTURE_LIST;
+  std::string channel;       // CSV column name or number (1 = first data column), VCD signal name or identifier
+  double sampleRate = 0;     // CSV samples per second (0 = from the file's header)
+  bool invert = false;       // Invert the levels (e.g. if the signal was captured before the receiver's inverter)
+};
+
+
+/**
+ * Guesses the capture format from the file name's extension.
+ */
+inline irCaptureFormat_t irCaptureFormatFromName(const char *name) {
+  const char *ext = strrchr(name, '.');
+  if (ext && !strcasecmp(ext, ".csv")) return IR_CAPTURE_CSV;
+  if (ext && !strcasecmp(ext, ".vcd")) return IR_CAPTURE_VCD;
+  if (ext && !strcasecmp(ext, ".irrec")) return IR_CAPTURE_REC;
+  return IR_CAPTURE_LIST;
+}
+
+
+/**
+ * Reads a capture, line by line, and calls onEdge(timeUs, level) for each level change.
+ * Returns false (and prints the reason to stderr) if the file can't be parsed.
+ */
+template <class EdgeCallback>
+class IRsmallDCaptureReader {
+  public:
+    IRsmallDCaptureReader(const irCaptureOptions_t &options, EdgeCallback &onEdge) : _opt(options), _onEdge(onEdge) {}
+    bool read(FILE *file);
+    uint8_t recorderProtocol() const { return _recProtocol; }  // Protocol ID of the last recorder dump (0 = none)
+
+  private:
+    static const size_t c_blockSize = 1 << 20;
+
+    const irCaptureOptions_t &_opt;
+    EdgeCallback &_onEdge;
+    uint8_t  _level = 1;          // The receiver's output is high when idle
+    uint64_t _lineNumber = 0;
+    // CSV:
+    int      _timeColumn = -1;
+    int      _dataColumn = -1;
+    double   _rate = 0;
+    uint64_t _sampleCount = 0;
+    bool     _headerDone = false;
+    // VCD:
+    double   _timescaleUs = 1;
+    std::string _vcdId;
+    std::string _vcdToken;        // Previous token (needed for "$timescale 1 ns" and "$var" declarations)
+    int      _vcdSection = 0;     // 0 = none, 1 = $timescale, 2 = $var, 3 = other $... block
+    int      _vcdVarField = 0;
+    uint64_t _vcdTime = 0;
+    // Recorder dumps:
+    char     _recMode = 0;        // Interrupt mode of the dump being read ('C', 'R' or 'F'), 0 outside a dump
+    uint8_t  _recProtocol = 0;
+    uint8_t  _recShift = 0;
+    uint8_t  _recLevel = 0;       // Level after the next recorded edge (CHANGE mode)
+    uint64_t _recTime = 0;        // Time of the last recorded edge (dumps follow each other)
+    uint32_t _recValue = 0;       // Varint being decoded (they may be split across lines)
+    uint8_t  _recBits = 0;
+
+    void level(uint64_t timeUs, uint8_t newLevel) {
+      if (_opt.invert) newLevel = !newLevel;
+      edge(timeUs, newLevel);
+    }
+    void edge(uint64_t timeUs, uint8_t newLevel) {  // Not inverted
+      if (newLevel != _level) {
+        _level = newLevel;
+        _onEdge(timeUs, newLevel);
+      }
+    }
+    bool fail(const char *reason) {
+      fprintf(stderr, "Line %llu: %s\n", (unsigned long long)_lineNumber, reason);
+      return false;
+    }
+    bool listLine(char *line);
+    bool recHeader(const char *line);
+    bool recLine(const char *line);
+    void recEdge(uint32_t value);
+    bool csvLine(char *line);
+    bool vcdLine(char *line);
+    bool vcdToken(const char *token);
+};
+
+
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::read(FILE *file) {
+  static char block[c_blockSize + 1];
+  size_t pending = 0;  // Bytes of an incomplete line, kept at the start of the block
+  for (;;) {
+    size_t count = fread(block + pending, 1, c_blockSize - pending, file);
+    size_t end = pending + count;
+    if (count == 0) {
+      if (pending == 0) return true;
+      block[end++] = '\n';  // Last line without a line break
+    }
+    char *line = block;
+    char *limit = block + end;
+    char *newline;
+    while ((newline = (char *)memchr(line, '\n', limit - line))) {
+      *newline = 0;
+      if (newline > line && newline[-1] == '\r') newline[-1] = 0;
+      _lineNumber++;
+      bool ok;
+      switch (_opt.format) {
+        case IR_CAPTURE_CSV: ok = csvLine(line); break;
+        case IR_CAPTURE_VCD: ok = vcdLine(line); break;
+        default:             ok = _recMode ? recLine(line) : listLine(line); break;
+      }
+      if (!ok) return false;
+      line = newline + 1;
+    }
+    pending = limit - line;
+    if (pending == c_blockSize) return fail("line too long");
+    memmove(block, line, pending);
+    if (count == 0) return true;
+  }
+}
+
+
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::listLine(char *line) {
+  while (*line == ' ' || *line == '\t') line++;
+  if (!strncmp(line, "#irsmalld-rec", 13)) return recHeader(line);
+  if (*line == 0 || *line == '#' || _opt.format == IR_CAPTURE_REC) return true;
+  uint64_t time = 0;
+  if (!isdigit((unsigned char)*line)) return fail("invalid time");
+  while (isdigit((unsigned char)*line)) time = time * 10 + (*line++ - '0');
+  while (*line && !isspace((unsigned char)*line) && *line != ',') line++;  // Fractions of µs are ignored
+  while (*line == ' ' || *line == '\t' || *line == ',') line++;
+  uint8_t newLevel;
+  if (*line == '0' || *line == '1') newLevel = *line - '0';
+  else newLevel = !_level ^ _opt.invert;  // No level: toggle (the first edge is a falling edge, even if inverted)
+  level(time, newLevel);
+  return true;
+}
+
+
+// Recorder dump header: "#irsmalld-rec protocol=1 mode=R shift=2 level=1"
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::recHeader(const char *line) {
+  const char *protocol = strstr(line, "protocol=");
+  const char *mode = strstr(line, "mode=");
+  const char *shift = strstr(line, "shift=");
+  const char *first = strstr(line, "level=");
+  if (!protocol || !mode || !shift || !first) return fail("incomplete recorder header");
+  _recMode = mode[5];
+  if (_recMode != 'C' && _recMode != 'R' && _recMode != 'F') return fail("invalid recorder mode");
+  _recProtocol = (uint8_t)atoi(protocol + 9);
+  _recShift = (uint8_t)atoi(shift + 6);
+  if (_recShift > 16) return fail("invalid recorder shift");
+  _recLevel = (first[6] == '1');
+  _recValue = 0;
+  _recBits = 0;
+  // In CHANGE mode, the first recorded edge must be a level change (as if the dropped edge before it was there):
+  if (_recMode == 'C' && _level == _recLevel) edge(_recTime, !_recLevel);
+  return true;
+}
+
+
+// Recorder dump data: each record is the time since the previous edge, in units of 2^shift µs, shifted left by one
+// bit (the low bit is the frame start flag, not needed here), as a varint (7 bits per byte, LSB first).
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::recLine(const char *line) {
+  while (*line == ' ' || *line == '\t') line++;
+  if (!strncmp(line, "#irsmalld-rec", 13)) return recHeader(line);
+  if (!strncmp(line, "#end", 4)) {
+    _recMode = 0;
+    return true;
+  }
+  while (*line) {
+    if (*line == ' ' || *line == '\t') { line++; continue; }
+    if (!isxdigit((unsigned char)line[0]) || !isxdigit((unsigned char)line[1])) return fail("invalid recorder data");
+    char hex[3] = {line[0], line[1], 0};
+    line += 2;
+    uint8_t byte = (uint8_t)strtoul(hex, NULL, 16);
+    if (_recBits > 28) return fail("invalid recorder data (varint too long)");
+    _recValue |= (uint32_t)(byte & 0x7F) << _recBits;
+    _recBits += 7;
+    if (!(byte & 0x80)) {
+      recEdge(_recValue);
+      _recValue = 0;
+      _recBits = 0;
+    }
+  }
+  return true;
+}
+
+
+template <class EdgeCallback>
+void IRsmallDCaptureReader<EdgeCallback>::recEdge(uint32_t value) {
+  uint64_t before = _recTime;
+  _recTime += (uint64_t)(value >> 1) << _recShift;
+  if (_recMode == 'C') {
+    edge(_recTime, _recLevel);
+    _recLevel = !_recLevel;
+    return;
+  }
+  // Only the edges that called the ISR were recorded, the other ones are placed just before them:
+  uint8_t isrLevel = (_recMode == 'R') ? 1 : 0;
+  edge(_recTime > before ? _recTime - 1 : _recTime, !isrLevel);
+  edge(_recTime, isrLevel);
+}
+
+
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::csvLine(char *line) {
+  if (*line == ';') {  // Comment, it may contain the sample rate: "; Samplerate: 1 MHz"
+    const char *rate = strstr(line, "Samplerate:");
+    if (rate) {
+      char *unit;
+      _rate = strtod(rate + 11, &unit);
+      while (*unit == ' ') unit++;
+      if (*unit == 'k' || *unit == 'K') _rate *= 1e3;
+      else if (*unit == 'M') _rate *= 1e6;
+      else if (*unit == 'G') _rate *= 1e9;
+    }
+    return true;
+  }
+  if (*line == 0) return true;
+
+  if (!_headerDone) {
+    _headerDone = true;
+    if (_opt.sampleRate > 0) _rate = _opt.sampleRate;
+    if (!isdigit((unsigned char)*line) && *line != '-' && *line != '.') {  // Column names
+      int column = 0, dataIndex = 0;
+      for (char *name = strtok(line, ","); name; name = strtok(NULL, ","), column++) {
+        while (*name == ' ') name++;
+        if (!strncasecmp(name, "time", 4)) { _timeColumn = column; continue; }
+        dataIndex++;
+        if (_dataColumn < 0 && (_opt.channel.empty() || _opt.channel == name || atoi(_opt.channel.c_str()) == dataIndex)) _dataColumn = column;
+      }
+      if (_dataColumn < 0) return fail("channel not found");
+      if (_timeColumn < 0 && _rate <= 0) return fail("no time column and no sample rate (use -r)");
+      return true;
+    }
+    // No column names: data columns only
+    _dataColumn = _opt.channel.empty() ? 0 : atoi(_opt.channel.c_str()) - 1;
+    if (_rate <= 0) return fail("no sample rate (use -r)");
+  }
+
+  // Data line:
+  char *field = line;
+  double seconds = -1;
+  int newLevel = -1;
+  for (int column = 0; field; column++) {
+    if (column == _timeColumn) seconds = strtod(field, NULL);
+    else if (column == _dataColumn) newLevel = (*field == '1');
+    if ((column >= _timeColumn) && newLevel >= 0) break;
+    field = strchr(field, ',');
+    if (field) field++;
+  }
+  if (newLevel < 0) return fail("missing data column");
+  if (_timeColumn < 0) seconds = _sampleCount / _rate;
+  _sampleCount++;
+  level((uint64_t)(seconds * 1e6 + 0.5), newLevel);
+  return true;
+}
+
+
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::vcdLine(char *line) {
+  for (char *token = strtok(line, " \t"); token; token = strtok(NULL, " \t")) {
+    if (!vcdToken(token)) return false;
+  }
+  return true;
+}
+
+
+template <class EdgeCallback>
+bool IRsmallDCaptureReader<EdgeCallback>::vcdToken(const char *token) {
+  if (_vcdSection) {  // Inside a $... $end block
+    if (!strcmp(token, "$end")) {
+      _vcdSection = 0;
+      return true;
+    }
+    if (_vcdSection == 1) {  // $timescale: "1 us", "10ns", "1 ps"...
+      const char *unit = token;
+      double value = strtod(token, (char **)&unit);
+      if (unit == token) value = strtod(_vcdToken.c_str(), NULL);  // The number was the previous token
+      if (*unit) {
+        if (value <= 0) value = 1;
+        if (!strcmp(unit, "s"))       _timescaleUs = value * 1e6;
+        else if (!strcmp(unit, "ms")) _timescaleUs = value * 1e3;
+        else if (!strcmp(unit, "us")) _timescaleUs = value;
+        else if (!strcmp(unit, "ns")) _timescaleUs = value * 1e-3;
+        else if (!strcmp(unit, "ps")) _timescaleUs = value * 1e-6;
+        else if (!strcmp(unit, "fs")) _timescaleUs = value * 1e-9;
+      }
+    } else if (_vcdSection == 2) {  // $var <type> <size> <id> <name> [range] $end
+      _vcdVarField++;
+      if (_vcdVarField == 3) _vcdToken = token;  // Identifier
+      else if (_vcdVarField == 4 && _vcdId.empty()) {  // Name (the first signal is used if no channel was given)
+        if (_opt.channel.empty() || _opt.channel == token || _opt.channel == _vcdToken) _vcdId = _vcdToken;
+      }
+      return true;
+    }
+    _vcdToken = token;
+    return true;
+  }
+
+  if (token[0] == '$') {
+    if (!strcmp(token, "$timescale")) _vcdSection = 1;
+    else if (!strcmp(token, "$var")) { _vcdSection = 2; _vcdVarField = 0; }
+    else if (!strcmp(token, "$enddefinitions")) {
+      _vcdSection = 3;
+      if (_vcdId.empty()) return fail("signal not found");
+    }
+    else if (!strcmp(token, "$dumpvars") || !strcmp(token, "$end") || !strcmp(token, "$dumpall")) {}  // Values follow
+    else _vcdSection = 3;
+    return true;
+  }
+  if (token[0] == '#') {
+    _vcdTime = strtoull(token + 1, NULL, 10);
+    return true;
+  }
+  if ((token[0] == '0' || token[0] == '1') && _vcdId == token + 1) {
+    level((uint64_t)(_vcdTime * _timescaleUs + 0.5), token[0] - '0');
+  }
+  return true;  // Other signals, x/z values and vectors are ignored
+}
+
+#endif
@@ -0,0 +1,176 @@
+/* IRsmallDCoProtocols - NEC/NECx and RC5 decoders written as coroutines (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * They decode exactly what the ISRs in IRsmallD_NEC.h and IRsmallD_RC5.h decode, with the same thresholds, but
+ * each one is a single loop (see IRsmallDCoroutine.h). Compare RC5's Manchester decoding, where a short duration
+ * is always followed by another one and a long duration flips the direction of the mid-bit edges, with the four
+ * states and three pseudo-states of the ISR.
+ *
+ * Notes:
+ *   - IRsmallDecoder.h must be included first, with IR_SMALLD_NEC, IR_SMALLD_NECx or IR_SMALLD_RC5 defined;
+ *   - IRsmallDCoDecoder is the class of the selected protocol;
+ *   - The frame timestamps, signal quality and repetition gate (IR_SMALLD_TIMESTAMPS, IR_SMALLD_QUALITY,
+ *     IR_SMALLD_HOLD_GATE) are not implemented, and data is never lost because of a pending copy (there's no
+ *     _irCopyingData in here).
+ */
+
+#ifndef IRsmallD_CoProtocols_h
+#define IRsmallD_CoProtocols_h
+
+#include "IRsmallDCoroutine.h"
+
+#if defined(IR_SMALLD_DUAL_EDGE)  // The coroutines would get the pulses' edges as marks
+  #error IR_SMALLD_DUAL_EDGE is not implemented in IRsmallDCoProtocols.h
+#endif
+
+#if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_NECx)
+
+class IRsmallDCoNEC : public IRsmallDCoProtocol {
+  public:
+    // NEC timings' thresholds in microseconds, exactly as in the ISR:
+    static const uint16_t c_GapMin = NEC_GAP_1 * 0.7 - IR_SMALLD_JITTER;
+    static const uint32_t c_GapMax = NEC_GAP_2 * 1.3 + IR_SMALLD_JITTER;
+    static const uint16_t c_RMmin = NEC_R_MARK * 0.7 - IR_SMALLD_JITTER;
+    static const uint16_t c_RMmax = NEC_R_MARK + NEC_R_TOL;
+    static const uint16_t c_LMmin = c_RMmax + 1;
+    static const uint16_t c_LMmax = NEC_L_MARK * 1.3 + IR_SMALLD_JITTER;
+    static const uint16_t c_M1min = NEC_MARK_1 * 0.7;
+    static const uint16_t c_M1max = NEC_MARK_1 * 1.3 + IR_SMALLD_JITTER;
+    static const uint16_t c_M0min = NEC_MARK_0 * 0.7 - IR_SMALLD_JITTER;
+    static const uint8_t  c_RptCount = 2;
+
+    IRsmallDCoTask run() {
+      bool possiblyHeld = false;  // A timeout restarts the coroutine, so it's false after it, as after resetFSM()
+      uint8_t repeatCount = 0;
+      for (;;) {
+        uint32_t duration = co_await standbyDuration();  // The gap before the frame
+        if (duration <= c_GapMin) {
+          possiblyHeld = false;
+          continue;
+        }
+        if (duration > c_GapMax) possiblyHeld = false;
+
+        duration = co_await nextDuration();              // Leading mark or repeat mark
+        if (duration < c_LMmin || duration > c_LMmax) {
+          if (possiblyHeld && duration >= c_RMmin && duration <= c_RMmax) {
+            if (repeatCount < c_RptCount) repeatCount++;   // The first repeat marks are ignored
+            else {
+              irData.keyHeld = true;
+              co_yield irData;
+            }
+          }
+          continue;
+        }
+        repeatCount = 0;
+
+        uint8_t irSignal[4] = {};  // Address, inverted address (NECx: high address byte), command, inverted command
+        bool bitsOK = true;
+        for (uint8_t bit = 0; bit < 32 && bitsOK; bit++) {
+          duration = co_await nextDuration();
+          if (duration < c_M0min || duration > c_M1max) bitsOK = false;  // Not a bit mark
+          else {
+            uint8_t &irByte = irSignal[bit >> 3];
+            irByte = (irByte >> 1) | (duration >= c_M1min ? 0x80 : 0);
+            if (bit == 15) {  // The address is complete
+              #if defined(IR_SMALLD_NEC)
+                if (irSignal[0] != (uint8_t)~irSignal[1]) bitsOK = false;
+                else if (!ADDRESS_ALLOWED(irSignal[0])) bitsOK = possiblyHeld = false;
+              #else
+                if (!ADDRESS_ALLOWED(irSignal[0] | (uint16_t)irSignal[1] << 8)) bitsOK = possiblyHeld = false;
+              #endif
+            }
+          }
+        }
+        if (!bitsOK || irSignal[2] != (uint8_t)~irSignal[3]) continue;
+
+        #if defined(IR_SMALLD_NEC)
+          irData.addr = irSignal[0];
+        #else
+          irData.addr = irSignal[0] | (uint16_t)irSignal[1] << 8;
+        #endif
+        irData.cmd = irSignal[2];
+        irData.keyHeld = false;
+        co_yield irData;
+        possiblyHeld = true;  // Will remain true if the next gap is OK
+      }
+    }
+};
+
+typedef IRsmallDCoNEC IRsmallDCoDecoder;
+
+
+#elif defined(IR_SMALLD_RC5)
+
+class IRsmallDCoRC5 : public IRsmallDCoProtocol {
+  public:
+    // RC5 timings in microseconds, exactly as in the ISR:
+    static const uint32_t c_rptPmax  = 113792 * 1.2 + IR_SMALLD_JITTER;
+    static const uint32_t c_gapMin   = 88900 * 0.8 - IR_SMALLD_JITTER;
+    static const uint16_t c_bitPeriod = 1778;
+    static const uint16_t c_tolerance = 444;
+    static const uint16_t c_longMax  = c_bitPeriod + c_tolerance + IR_SMALLD_JITTER;
+    static const uint16_t c_shortMax = c_bitPeriod / 2 + c_tolerance;
+    static const uint16_t c_shortMin = c_bitPeriod / 2 - c_tolerance - IR_SMALLD_JITTER;
+    static const uint8_t  c_rptCount = 2;
+
+    IRsmallDCoTask run() {
+      for (;;) {
+        uint32_t duration = co_await standbyDuration();
+        if (duration < c_gapMin) continue;  // It's very unlikely that a non-start pulse will be longer than c_gapMin
+
+        // From here on, each loop starts at a mid-bit edge (the first one is the start bit's):
+        uint16_t irSignal = 0;  // Only 14 bits used
+        uint8_t bitCount = 0;
+        bool rose = true;       // Direction of the mid-bit edge; it's the value of the bit (1 for a rising edge)
+        for (;;) {
+          duration = co_await nextDuration();
+          irSignal = (irSignal << 1) | rose;
+          bitCount++;
+          if (duration < c_shortMin || duration > c_longMax) break;              // Error
+          if (bitCount == 8 && !ADDRESS_ALLOWED(irSignal & 0x1F)) break;         // Another device's remote
+          if (duration <= c_shortMax) {  // Short: an edge between the bits, then a mid-bit edge in the same direction
+            duration = co_await nextDuration();
+            if (duration < c_shortMin || duration > c_shortMax) break;            // Error
+          }
+          else rose = !rose;             // Long: the next mid-bit edge is in the other direction
+          if (bitCount == 13) {          // All 14 bits received (the last one is this mid-bit edge)
+            irSignal = (irSignal << 1) | rose;
+            bool toggle = irSignal & 0x0800;
+            if (edgeTime() - _lastBitTime < c_rptPmax && _prevToggle == toggle) {  // The key was held
+              if (_repeatCount < c_rptCount) _repeatCount++;
+              else {
+                irData.keyHeld = true;
+                co_yield irData;
+              }
+            } else {
+              irData.addr = (irSignal & 0x7C0) >> 6;
+              irData.cmd = (irSignal & 0x3F) | ((irSignal & 0x1000) ? 0 : 0x40);  // Add the field bit (inverted)
+              irData.keyHeld = false;
+              co_yield irData;
+              _repeatCount = 0;
+            }
+            _prevToggle = toggle;
+            _lastBitTime = edgeTime();
+            break;
+          }
+        }
+      }
+    }
+
+  private:  // Not changed by a timeout (they're statics in the ISR)
+    uint32_t _lastBitTime = 0;
+    uint8_t  _repeatCount = 0;
+    bool     _prevToggle = false;
+};
+
+typedef IRsmallDCoRC5 IRsmallDCoDecoder;
+
+
+#else
+  #error IRsmallDCoProtocols.h requires IR_SMALLD_NEC, IR_SMALLD_NECx or IR_SMALLD_RC5
+#endif
+
+#endif
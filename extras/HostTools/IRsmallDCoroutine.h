@@ -0,0 +1,180 @@
+/* IRsmallDCoroutine - Decoders written as C++20 coroutines, fed one edge at a time (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * How it works:
+ * -------------
+ * The ISRs are finite state machines: each call measures one duration, looks at the state number and leaves the
+ * next one in a static variable (with pseudo-states, like RC5's ps_roseChoice, for the code that several states
+ * share). Here, a protocol is a class with a run() coroutine that decodes frames in an endless loop, written as
+ * straight-line code. It waits for each duration with co_await and publishes each frame with co_yield:
+ *
+ *   IRsmallDCoTask run() {
+ *     for (;;) {
+ *       uint32_t duration = co_await standbyDuration();  // Waiting for a frame (the timeout is not armed)
+ *       if (duration < c_gapMin) continue;
+ *       duration = co_await nextDuration();              // Receiving
+ *       ...
+ *       co_yield irData;                                 // Like _irDataAvailable = true
+ *     }
+ *   }
+ *
+ * The position in the code replaces the state number and the local variables replace the statics. The members
+ * of the protocol class are kept when the coroutine is restarted by a timeout, like the statics that resetFSM()
+ * doesn't change. IRsmallDCoRunner does the rest of the ISR's work: it filters the edges by IR_ISR_MODE, measures
+ * the durations (with the same 32-bit arithmetic) and restarts the coroutine when dataAvailable() would have reset
+ * the FSM, so the decoded data can be compared with the ISR's (see ircoro.cpp).
+ *
+ * Notes:
+ *   - IRsmallDecoder.h must be included first (through the host Arduino.h), with the protocol selected;
+ *   - It needs C++20 (g++ 10 or above, with -std=c++20), so it's only meant for the host tools, not for sketches;
+ *   - The coroutine frame is allocated once, when the runner is created or restarted (not for each edge).
+ */
+
+#ifndef IRsmallD_Coroutine_h
+#define IRsmallD_Coroutine_h
+
+#if __cplusplus < 202002L
+  #error IRsmallDCoroutine.h requires C++20 (-std=c++20)
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+
+// What a protocol can wait for (see IRsmallDCoProtocol):
+struct irCoNextDuration {};     // The next duration of a frame
+struct irCoStandbyDuration {};  // The next duration, while waiting for a frame (in standby)
+
+
+/**
+ * The coroutine returned by a protocol's run(). It starts right away and runs until it waits for the first duration.
+ */
+class IRsmallDCoTask {
+  public:
+    struct promise_type {
+      uint32_t   duration = 0;
+      bool       standby = true;
+      bool       published = false;
+      irSmallD_t data = {};
+
+      struct DurationAwaiter {
+        promise_type &promise;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) const noexcept {}
+        uint32_t await_resume() const noexcept { return promise.duration; }
+      };
+
+      IRsmallDCoTask get_return_object() { return IRsmallDCoTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_always final_suspend() noexcept { return {}; }  // A protocol never returns (just in case)
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+
+      std::suspend_never yield_value(const irSmallD_t &irData) {  // Publishes a frame and goes on
+        data = irData;
+        published = true;
+        return {};
+      }
+      DurationAwaiter await_transform(irCoNextDuration) {
+        standby = false;
+        return {*this};
+      }
+      DurationAwaiter await_transform(irCoStandbyDuration) {
+        standby = true;
+        return {*this};
+      }
+    };
+
+    IRsmallDCoTask(IRsmallDCoTask &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+    IRsmallDCoTask &operator=(IRsmallDCoTask &&other) noexcept {
+      if (this != &other) {
+        if (_handle) _handle.destroy();
+        _handle = std::exchange(other._handle, nullptr);
+      }
+      return *this;
+    }
+    IRsmallDCoTask(const IRsmallDCoTask &) = delete;
+    IRsmallDCoTask &operator=(const IRsmallDCoTask &) = delete;
+    ~IRsmallDCoTask() {
+      if (_handle) _handle.destroy();
+    }
+
+    // Resumes the coroutine with a duration; returns true if it published a frame (see data()):
+    bool feed(uint32_t duration) {
+      promise_type &promise = _handle.promise();
+      promise.duration = duration;
+      promise.published = false;
+      if (!_handle.done()) _handle.resume();
+      return promise.published;
+    }
+
+    bool standby() const { return _handle.promise().standby; }
+    const irSmallD_t &data() const { return _handle.promise().data; }
+
+  private:
+    explicit IRsmallDCoTask(std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+    std::coroutine_handle<promise_type> _handle;
+};
+
+
+/**
+ * Base class of the protocols. The derived class defines:
+ *   IRsmallDCoTask run();
+ */
+class IRsmallDCoProtocol {
+  protected:
+    static irCoNextDuration nextDuration() { return {}; }
+    static irCoStandbyDuration standbyDuration() { return {}; }
+    uint32_t edgeTime() const { return _edgeTime; }  // The ISR's _previousTime (the end of the last duration)
+
+    irSmallD_t irData = {};  // Kept between frames, like _irData (a held key publishes the previous data)
+
+  private:
+    template <class Protocol> friend class IRsmallDCoRunner;
+    uint32_t _edgeTime = 0;
+};
+
+
+/**
+ * Feeds the edges of a signal to a protocol's coroutine, as the ISR and dataAvailable() would.
+ */
+template <class Protocol>
+class IRsmallDCoRunner {
+  public:
+    IRsmallDCoRunner() : _task(_protocol.run()) {}
+
+    // Feeds a level change of the receiver's output; returns true if a frame was decoded (see data()):
+    bool edge(uint64_t timeUs, uint8_t level) {
+      if (level == _level) return false;  // Not an edge
+      _level = level;
+      if (IR_ISR_MODE != CHANGE && (IR_ISR_MODE == RISING) != (level == HIGH)) return false;
+      uint32_t duration = (uint32_t)timeUs - _previousTime;
+      _previousTime = (uint32_t)timeUs;
+      #if not defined(IR_SMALLD_NO_TIMEOUT)
+        if (!_task.standby() && duration >= IR_SMALLD_TIMEOUT) {  // dataAvailable() would have reset the FSM
+          _task = _protocol.run();                                 // A new coroutine, in standby
+          duration -= IR_SMALLD_TIMEOUT;                           // The next interval starts at the reset
+          _timeouts++;
+        }
+      #endif
+      _protocol._edgeTime = _previousTime;
+      return _task.feed(duration);
+    }
+
+    const irSmallD_t &data() const { return _task.data(); }
+    bool standby() const { return _task.standby(); }
+    uint64_t timeouts() const { return _timeouts; }
+
+  private:
+    Protocol       _protocol;
+    IRsmallDCoTask _task;               // Declared after _protocol, which run() uses
+    uint32_t       _previousTime = 0;   // As the ISR's, it starts at 0
+    uint8_t        _level = HIGH;       // The receiver's output is high when idle
+    uint64_t       _timeouts = 0;
+};
+
+#endif
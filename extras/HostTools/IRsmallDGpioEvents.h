@@ -0,0 +1,190 @@
+/* IRsmallDGpioEvents - Live input from Linux GPIO line events, with kernel timestamps (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * On Linux boards (Raspberry Pi and the like) there is no attachInterrupt(), but the GPIO character device
+ * (/dev/gpiochipN) can report the edges of an input line as events, timestamped by the kernel's interrupt handler.
+ * So, the intervals are as accurate as on a microcontroller, even if the process is only scheduled much later.
+ *
+ * Event formats (the structures in <linux/gpio.h>):
+ *   v1 - struct gpioevent_data (16 bytes), from GPIO_GET_LINEEVENT_IOCTL (deprecated, but still widely available);
+ *   v2 - struct gpio_v2_line_event (48 bytes), from GPIO_V2_GET_LINE_IOCTL (Linux 5.10+). Its sequence numbers are
+ *        used to count the events that the kernel dropped (when its buffer overflows).
+ *
+ * Notes:
+ * - The reader works with any file descriptor that delivers these structures, so a pipe, a FIFO or a socketpair
+ *   carrying synthetic events can be used for testing without hardware (a structure may arrive in pieces).
+ *   Regular files can't be polled, so they are just read to the end.
+ * - It waits with epoll and, on each wakeup, reads all the events that are available (up to c_batchSize) at once.
+ * - Edge events are level changes: a rising edge sets the level to HIGH, a falling edge to LOW.
+ * - The reader doesn't change the descriptor's flags (it may be the standard input, shared with other processes).
+ */
+
+#ifndef IRsmallD_GpioEvents_h
+#define IRsmallD_GpioEvents_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+enum irGpioEventFormat_t { IR_GPIO_EVENTS_V1, IR_GPIO_EVENTS_V2 };
+
+
+inline size_t irGpioEventSize(irGpioEventFormat_t format) {
+  return format == IR_GPIO_EVENTS_V1 ? sizeof(struct gpioevent_data) : sizeof(struct gpio_v2_line_event);
+}
+
+
+/**
+ * Requests the edge events (both edges) of a line of an open GPIO chip.
+ * Returns the file descriptor of the events, or -1 (and errno) if the request fails.
+ */
+inline int irGpioRequestEvents(int chipFd, unsigned line, irGpioEventFormat_t format, const char *consumer) {
+  if (format == IR_GPIO_EVENTS_V1) {
+    struct gpioevent_request request;
+    memset(&request, 0, sizeof(request));
+    request.lineoffset = line;
+    request.handleflags = GPIOHANDLE_REQUEST_INPUT;
+    request.eventflags = GPIOEVENT_REQUEST_BOTH_EDGES;
+    strncpy(request.consumer_label, consumer, sizeof(request.consumer_label) - 1);
+    if (ioctl(chipFd, GPIO_GET_LINEEVENT_IOCTL, &request) < 0) return -1;
+    return request.fd;
+  } else {
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    request.offsets[0] = line;
+    request.num_lines = 1;
+    request.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+    request.event_buffer_size = 256;  // Events kept by the kernel while the process isn't reading (default: 16)
+    strncpy(request.consumer, consumer, sizeof(request.consumer) - 1);
+    if (ioctl(chipFd, GPIO_V2_GET_LINE_IOCTL, &request) < 0) return -1;
+    return request.fd;
+  }
+}
+
+
+/**
+ * Reads GPIO line events from a file descriptor and calls the handler's methods:
+ *   void onEdge(uint64_t timeUs, uint8_t level);  // kernel timestamp (CLOCK_MONOTONIC, by default) and new level
+ *   int  idleTimeout();                           // ms to wait for the next event, before calling onIdle() (-1 = forever)
+ *   void onIdle();
+ */
+template <class Handler>
+class IRsmallDGpioEventReader {
+  public:
+    IRsmallDGpioEventReader(int fd, irGpioEventFormat_t format, bool invert, Handler &handler)
+      : _fd(fd), _format(format), _invert(invert), _handler(handler) {}
+
+    // Runs until the end of the input (returns true) or an error (returns false, the reason is printed to stderr):
+    bool run();
+
+    uint64_t events() const { return _events; }
+    uint64_t wakeups() const { return _wakeups; }
+    uint64_t dropped() const { return _dropped; }  // Events lost by the kernel (v2 only)
+
+  private:
+    static const size_t c_batchSize = 64;  // Events read at once
+
+    int _fd;
+    irGpioEventFormat_t _format;
+    bool _invert;
+    Handler &_handler;
+    uint64_t _events = 0;
+    uint64_t _wakeups = 0;
+    uint64_t _dropped = 0;
+    uint32_t _lastSeqno = 0;
+
+    void event(const uint8_t *data);
+};
+
+
+template <class Handler>
+bool IRsmallDGpioEventReader<Handler>::run() {
+  int epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd < 0) {
+    perror("epoll_create1");
+    return false;
+  }
+  struct epoll_event watch;
+  memset(&watch, 0, sizeof(watch));
+  watch.events = EPOLLIN;
+  bool polled = true;
+  if (epoll_ctl(epollFd, EPOLL_CTL_ADD, _fd, &watch) < 0) {
+    if (errno != EPERM) {
+      perror("epoll_ctl");
+      close(epollFd);
+      return false;
+    }
+    polled = false;  // A regular file (always ready): it's just read to the end
+  }
+
+  const size_t eventSize = irGpioEventSize(_format);
+  static uint8_t buffer[c_batchSize * sizeof(struct gpio_v2_line_event)];
+  size_t pending = 0;  // Bytes of an incomplete event, kept at the start of the buffer
+  bool ok = true;
+  for (;;) {
+    struct epoll_event ready;
+    int count = polled ? epoll_wait(epollFd, &ready, 1, _handler.idleTimeout()) : 1;
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      perror("epoll_wait");
+      ok = false;
+      break;
+    }
+    if (count == 0) {
+      _handler.onIdle();
+      continue;
+    }
+    _wakeups++;
+    ssize_t size = read(_fd, buffer + pending, c_batchSize * eventSize - pending);
+    if (size < 0) {
+      if (errno == EINTR || errno == EAGAIN) continue;
+      perror("read");
+      ok = false;
+      break;
+    }
+    if (size == 0) {  // End of the input (the writer closed the pipe)
+      if (pending) fprintf(stderr, "Warning: the input ended with an incomplete event\n");
+      break;
+    }
+    size_t end = pending + size;
+    size_t position = 0;
+    for (; end - position >= eventSize; position += eventSize) event(buffer + position);
+    pending = end - position;
+    memmove(buffer, buffer + position, pending);
+  }
+  close(epollFd);
+  return ok;
+}
+
+
+template <class Handler>
+void IRsmallDGpioEventReader<Handler>::event(const uint8_t *data) {
+  uint64_t timestampNs;
+  uint32_t id;
+  if (_format == IR_GPIO_EVENTS_V1) {
+    struct gpioevent_data event;
+    memcpy(&event, data, sizeof(event));
+    timestampNs = event.timestamp;
+    id = event.id;
+  } else {
+    struct gpio_v2_line_event event;
+    memcpy(&event, data, sizeof(event));
+    timestampNs = event.timestamp_ns;
+    id = event.id;
+    if (_events && event.line_seqno > _lastSeqno + 1) _dropped += event.line_seqno - _lastSeqno - 1;
+    _lastSeqno = event.line_seqno;
+  }
+  _events++;
+  uint8_t level = (id == GPIOEVENT_EVENT_RISING_EDGE) ? 1 : 0;  // Same IDs in v1 and v2
+  _handler.onEdge(timestampNs / 1000, level ^ _invert);
+}
+
+#endif
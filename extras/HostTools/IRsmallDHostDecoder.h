@@ -0,0 +1,190 @@
+/* IRsmallDHostDecoder - Drives the decoder with timestamped edges (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Notes:
+ * - The protocol must be selected (e.g. -DIR_SMALLD_NEC) when compiling, just like in a sketch.
+ * - Each edge sets the simulated micros() and calls the library's ISR (if the edge matches the interrupt mode).
+ * - The main loop of a sketch is emulated by calling dataAvailable() after each edge, and also at the exact
+ *   moment the timeout expires, counted from the last ISR call (as if the loop was polling the decoder continuously;
+ *   with IR_SMALLD_DUAL_EDGE, from the last call on IR_FSM_EDGE).
+ * - With simulateSleep(), the loop is emulated as a low power sketch instead: after each poll it sleeps until the
+ *   next edge if isIdle(), or until nextDeadline() (or the next edge) if a frame is being received. The decoder's
+ *   output must be the same, and sleepStats() tells how long it slept in each case.
+ * - FSM state changes are tracked through the IRSMALLD_DEBUG_STATE prints, which are redirected by the host
+ *   Arduino.h. A frame is rejected when the FSM returns to standby without publishing any data, unless it was
+ *   one of the initial repeat codes, which the decoders ignore on purpose (they print "REPEAT IGNORED").
+ * - The ISRs keep their state in static variables, so there can only be one instance per process.
+ */
+
+#ifndef IRsmallD_HostDecoder_h
+#define IRsmallD_HostDecoder_h
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#define IRSMALLD_DEBUG_STATE
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+
+
+// Protocol name and FSM state names (for the reject messages):
+#if defined(IR_SMALLD_NEC)
+  #define IR_HOST_PROTOCOL "NEC"
+  static const char *const c_irStateNames[] = {"Standby", "StartPulse", "Receiving"};
+#elif defined(IR_SMALLD_NECx)
+  #define IR_HOST_PROTOCOL "NECx"
+  static const char *const c_irStateNames[] = {"Standby", "StartPulse", "Receiving"};
+#elif defined(IR_SMALLD_RC5)
+  #define IR_HOST_PROTOCOL "RC5"
+  static const char *const c_irStateNames[] = {"Standby", "RoseInSync", "RoseOffSync", "FellInSync", "FellOffSync"};
+#elif defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15) || defined(IR_SMALLD_SIRC20)
+  #define IR_HOST_PROTOCOL "SIRC" IR_HOST_SIRC_BITS
+  #if defined(IR_SMALLD_SIRC12)
+    #define IR_HOST_SIRC_BITS "12"
+  #elif defined(IR_SMALLD_SIRC15)
+    #define IR_HOST_SIRC_BITS "15"
+  #else
+    #define IR_HOST_SIRC_BITS "20"
+  #endif
+  static const char *const c_irStateNames[] = {"Standby", "Receiving"};
+#elif defined(IR_SMALLD_SIRC)
+  #define IR_HOST_PROTOCOL "SIRC"
+  static const char *const c_irStateNames[] = {"Standby", "Receiving"};
+#elif defined(IR_SMALLD_SAMSUNG)
+  #define IR_HOST_PROTOCOL "SAMSUNG"
+  static const char *const c_irStateNames[] = {"Standby", "StartPulse", "Receiving"};
+#elif defined(IR_SMALLD_SAMSUNG32)
+  #define IR_HOST_PROTOCOL "SAMSUNG32"
+  static const char *const c_irStateNames[] = {"Standby", "StartPulse", "Receiving"};
+#elif defined(IR_SMALLD_HASH)
+  #define IR_HOST_PROTOCOL "HASH"
+  static const char *const c_irStateNames[] = {"Standby", "Receiving"};
+#endif
+
+
+/**
+ * Feeds timestamped edges to the decoder and reports frames, rejects and timeouts through the Listener:
+ *   void onFrame(uint64_t timeUs, const irSmallD_t &irData);
+ *   void onReject(uint64_t timeUs, uint8_t state, uint32_t interval);  // state before the rejected interval
+ *   void onRepeatIgnored(uint64_t timeUs);
+ *   void onTimeout(uint64_t timeUs, uint8_t state);
+ */
+template <class Listener>
+class IRsmallDHostDecoder {
+  public:
+    IRsmallDHostDecoder(Listener &listener) : _listener(listener), _decoder(0) {
+      _self() = this;
+      IRsmallDHost::state().onPrintNumber = printedNumber;
+      IRsmallDHost::state().onPrintText = printedText;
+    }
+
+    struct SleepStats {
+      uint64_t idleUs;           // Time asleep waiting for an edge, with the decoder idle
+      uint64_t pendingUs;        // Time asleep while a frame was being received
+      uint64_t edgeWakeups;
+      uint64_t deadlineWakeups;  // Wake-ups by the timer set to nextDeadline()
+    };
+
+    void edge(uint64_t timeUs, uint8_t level) {
+      if (_sleeping) wakeOnDeadlines(timeUs);
+      #if not defined(IR_SMALLD_NO_TIMEOUT)
+        else if (_state && timeUs - _lastIsrTime >= IR_SMALLD_TIMEOUT) poll(_lastIsrTime + IR_SMALLD_TIMEOUT);
+      #endif
+      IRsmallDHost::setMicros((uint32_t)timeUs);
+      uint8_t stateBefore = _state;
+      _repeatIgnored = false;
+      if (!IRsmallDHost::edge(level)) return;  // The ISR was not called (other edge)
+      uint32_t interval = (uint32_t)(timeUs - _lastIsrTime);
+      #if defined(IR_SMALLD_DUAL_EDGE)  // The other edge only measures a pulse (the FSM and its timeout don't see it)
+        if ((IR_FSM_EDGE == RISING) == (level == HIGH)) _lastIsrTime = timeUs;
+      #else
+        _lastIsrTime = timeUs;
+      #endif
+      if (_sleeping) wakeUp(timeUs, _sleepStats.edgeWakeups);
+      bool published = poll(timeUs);
+      if (_repeatIgnored) _listener.onRepeatIgnored(timeUs);
+      else if (stateBefore != 0 && _state == 0 && !published) _listener.onReject(timeUs, stateBefore, interval);
+      if (_sleeping) sleep(timeUs);
+    }
+
+    // Lets the decoder time out after the last edge (call it at the end of the capture):
+    void finish() {
+      if (_sleeping) wakeOnDeadlines(UINT64_MAX);
+      #if not defined(IR_SMALLD_NO_TIMEOUT)
+        else if (_state) poll(_lastIsrTime + IR_SMALLD_TIMEOUT);
+      #endif
+    }
+
+    // Emulates a low power sketch from now on (see the notes above):
+    void simulateSleep() {
+      _sleeping = true;
+      sleep(_lastIsrTime);
+      _sleepStart = UINT64_MAX;  // Not counted until the first edge
+    }
+
+    uint8_t state() const { return _state; }
+    const SleepStats &sleepStats() const { return _sleepStats; }
+
+  private:
+    Listener &_listener;
+    IRsmallDecoder _decoder;
+    uint64_t _lastIsrTime = 0;  // Time of the previous ISR call (including the timeout resets)
+    uint8_t  _state = 0;        // FSM state, as printed by the ISR
+    bool     _repeatIgnored = false;  // Printed by the last ISR call
+    bool     _sleeping = false;
+    bool     _timerSet = false;   // The sketch is asleep until _wakeTime (or the next edge)
+    bool     _sleptIdle = false;
+    uint64_t _wakeTime = 0;
+    uint64_t _sleepStart = 0;
+    SleepStats _sleepStats = {0, 0, 0, 0};
+
+    static IRsmallDHostDecoder *&_self() { static IRsmallDHostDecoder *self; return self; }
+
+    bool poll(uint64_t timeUs) {
+      irSmallD_t irData;
+      IRsmallDHost::setMicros((uint32_t)timeUs);
+      bool available = _decoder.dataAvailable(irData);
+      if (available) _listener.onFrame(timeUs, irData);
+      return available;
+    }
+
+    void sleep(uint64_t timeUs) {
+      uint32_t deadline;
+      _sleptIdle = _decoder.isIdle();
+      _timerSet = _decoder.nextDeadline(deadline);
+      if (_timerSet) {
+        int32_t wait = (int32_t)(deadline - (uint32_t)timeUs);  // It may already have expired
+        _wakeTime = timeUs + (wait > 0 ? wait : 0);
+      }
+      _sleepStart = timeUs;
+    }
+
+    void wakeUp(uint64_t timeUs, uint64_t &wakeups) {
+      if (_sleepStart <= timeUs) (_sleptIdle ? _sleepStats.idleUs : _sleepStats.pendingUs) += timeUs - _sleepStart;
+      wakeups++;
+    }
+
+    void wakeOnDeadlines(uint64_t timeUs) {  // The timer wake-ups before an edge at timeUs
+      while (_timerSet && _wakeTime <= timeUs) {
+        wakeUp(_wakeTime, _sleepStats.deadlineWakeups);
+        poll(_wakeTime);
+        sleep(_wakeTime);
+      }
+    }
+
+    static void printedNumber(long value) { _self()->_state = (uint8_t)value; }
+
+    static void printedText(const char *text) {  // The FSM is reset by calling the ISR (see resetFSM())
+      IRsmallDHostDecoder *self = _self();
+      if (!strcmp(text, "\nTIMEOUT\n")) {
+        self->_lastIsrTime += IR_SMALLD_TIMEOUT;  // Polled exactly when the timeout expired
+        self->_listener.onTimeout(self->_lastIsrTime, self->_state);
+      }
+      else if (!strcmp(text, "\nREPEAT IGNORED\n")) self->_repeatIgnored = true;
+    }
+};
+
+#endif
@@ -0,0 +1,81 @@
+/* IRsmallDHostPrinter - Prints the decoder's frames, ignored repeats, rejects and timeouts (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Listener for IRsmallDHostDecoder, shared by the tools that print one line per event:
+ *   0.117562 frame addr=0x00 cmd=0x45 held=0
+ *   0.229480 repeat ignored
+ *   0.301114 reject state=Receiving interval=3021
+ *   0.352000 timeout state=StartPulse
+ * The times are in seconds. In quiet mode, only the frames are printed (the events are still counted).
+ */
+
+#ifndef IRsmallD_HostPrinter_h
+#define IRsmallD_HostPrinter_h
+
+#include "IRsmallDHostDecoder.h"
+#include <stdio.h>
+
+
+struct IRsmallDHostPrinter {
+  bool quiet = false;
+  uint64_t frames = 0, ignoredRepeats = 0, rejects = 0, timeouts = 0;
+
+  static void time(uint64_t timeUs) {
+    printf("%llu.%06llu ", (unsigned long long)(timeUs / 1000000), (unsigned long long)(timeUs % 1000000));
+  }
+
+  static const char *stateName(uint8_t state) {
+    return state < sizeof(c_irStateNames) / sizeof(c_irStateNames[0]) ? c_irStateNames[state] : "?";
+  }
+
+  void onFrame(uint64_t timeUs, const irSmallD_t &irData) {
+    frames++;
+    time(timeUs);
+    #if defined(IR_SMALLD_HASH)
+      printf("frame hash=0x%08lX", (unsigned long)irData.hash);
+    #else
+      #if defined(IR_SMALLD_SIRC20) || defined(IR_SMALLD_SIRC)
+        printf("frame ext=0x%02X ", irData.ext);
+      #else
+        printf("frame ");
+      #endif
+      printf("addr=0x%02X cmd=0x%02X", (unsigned)irData.addr, irData.cmd);
+      #if defined(IR_SMALLD_HAS_KEYHELD)
+        printf(" held=%d", irData.keyHeld);
+      #endif
+    #endif
+    #if defined(IR_SMALLD_TIMESTAMPS)
+      printf(" duration=%lu", (unsigned long)irData.duration);
+    #endif
+    #if defined(IR_SMALLD_QUALITY)
+      printf(" quality=%u dev=%u/%u margin=%u", irData.quality, irData.meanDeviation, irData.maxDeviation, irData.minMargin);
+    #endif
+    putchar('\n');
+  }
+
+  void onReject(uint64_t timeUs, uint8_t state, uint32_t interval) {
+    rejects++;
+    if (quiet) return;
+    time(timeUs);
+    printf("reject state=%s interval=%lu\n", stateName(state), (unsigned long)interval);
+  }
+
+  void onRepeatIgnored(uint64_t timeUs) {
+    ignoredRepeats++;
+    if (quiet) return;
+    time(timeUs);
+    printf("repeat ignored\n");
+  }
+
+  void onTimeout(uint64_t timeUs, uint8_t state) {
+    timeouts++;
+    if (quiet) return;
+    time(timeUs);
+    printf("timeout state=%s\n", stateName(state));
+  }
+};
+
+#endif
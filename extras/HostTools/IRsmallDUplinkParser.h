@@ -0,0 +1,139 @@
+/* IRsmallDUplinkParser - Parses the packets of the binary uplink (IRsmallDUplink.h) on the host (host tools)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Usage:
+ *   struct Printer {
+ *     void onRecord(const irUplinkRecord_t &record) { ... }
+ *   };
+ *   Printer printer;
+ *   IRsmallDUplinkParser<Printer> parser(printer);
+ *   parser.feed(buffer, bytesRead);  // any number of bytes, as they come from the serial port
+ *
+ * Notes:
+ *   - It doesn't depend on the protocol selection (or on IRsmallDecoder.h): each record has its protocol's ID, so
+ *     one receiver works with boards running different decoders;
+ *   - Packets are delimited by 0x00, so a packet that is cut (e.g. when the receiver starts in the middle of one)
+ *     or corrupted is dropped without affecting the next one. Lost packets are counted from the sequence numbers;
+ *   - The records of a packet are only delivered after its CRC is checked.
+ */
+
+#ifndef IRsmallD_UplinkParser_h
+#define IRsmallD_UplinkParser_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "IRsmallDProtocolIDs.h"
+#include "IRsmallDUplinkFormat.h"
+
+
+struct irUplinkRecord_t {
+  uint8_t  protocol;  // IR_SMALLD_ID_...
+  uint8_t  flags;     // IR_UPLINK_HELD, IR_UPLINK_HAS_HELD, IR_UPLINK_FRAME_TIME
+  uint16_t addr;
+  uint8_t  cmd;
+  uint8_t  ext;
+  uint32_t time;      // µs
+
+  bool keyHeld() const { return flags & IR_UPLINK_HELD; }
+  bool hasKeyHeld() const { return flags & IR_UPLINK_HAS_HELD; }
+  uint32_t hash() const { return addr | (uint32_t)cmd << 16 | (uint32_t)ext << 24; }  // HASH decoder only
+};
+
+
+inline const char *irUplinkProtocolName(uint8_t id) {
+  static const char *const c_names[] = {"unknown", "NEC", "NECx", "RC5", "SIRC12", "SIRC15", "SIRC20", "SIRC",
+                                        "SAMSUNG", "SAMSUNG32", "HASH"};
+  return id < sizeof(c_names) / sizeof(c_names[0]) ? c_names[id] : "unknown";
+}
+
+
+/**
+ * Parses the uplink's byte stream and reports each record through the Listener:
+ *   void onRecord(const irUplinkRecord_t &record);
+ */
+template <class Listener>
+class IRsmallDUplinkParser {
+  public:
+    struct Stats {
+      uint64_t bytes;
+      uint64_t packets;      // Good packets
+      uint64_t records;
+      uint64_t badPackets;   // Cut, corrupted (bad COBS encoding, length or CRC) or too long
+      uint64_t lostPackets;  // Missing sequence numbers between good packets
+    };
+
+    IRsmallDUplinkParser(Listener &listener) : _listener(listener) {}
+
+    void feed(const uint8_t *data, size_t size) {
+      _stats.bytes += size;
+      for (size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+        if (byte) {
+          if (_length < sizeof(_buffer)) _buffer[_length] = byte;
+          _length++;           // Counted even if it doesn't fit, so that the packet is rejected
+        } else {
+          if (_length) packet();
+          _length = 0;
+        }
+      }
+    }
+
+    const Stats &stats() const { return _stats; }
+
+  private:
+    Listener &_listener;
+    uint8_t   _buffer[IR_UPLINK_MAX_PACKET + 1];  // Encoded packet, without the delimiter
+    size_t    _length = 0;
+    bool      _synced = false;                    // A good packet was received (so _nextSequence is known)
+    uint8_t   _nextSequence = 0;
+    Stats     _stats = {0, 0, 0, 0, 0};
+
+    void packet() {
+      // COBS decoding, in place (the decoded packet is one byte shorter, and blocks of 254 bytes have no zero):
+      if (_length > sizeof(_buffer)) {
+        _stats.badPackets++;
+        return;
+      }
+      size_t in = 0, out = 0;
+      while (in < _length) {
+        uint8_t code = _buffer[in++];
+        if (in + code - 1 > _length) {  // The block goes beyond the delimiter
+          _stats.badPackets++;
+          return;
+        }
+        for (uint8_t i = 1; i < code; i++) _buffer[out++] = _buffer[in++];
+        if (code != 0xFF && in < _length) _buffer[out++] = 0;
+      }
+
+      if (out < 4 || _buffer[1] == 0 || _buffer[1] > IR_UPLINK_MAX_RECORDS ||
+          out != 4 + (size_t)_buffer[1] * IR_UPLINK_RECORD_SIZE ||
+          irUplinkCrc16(_buffer, out - 2) != (_buffer[out - 2] | (uint16_t)_buffer[out - 1] << 8)) {
+        _stats.badPackets++;
+        return;
+      }
+
+      uint8_t sequence = _buffer[0];
+      if (_synced) _stats.lostPackets += (uint8_t)(sequence - _nextSequence);
+      _synced = true;
+      _nextSequence = sequence + 1;
+      _stats.packets++;
+
+      const uint8_t *p = &_buffer[2];
+      for (uint8_t r = 0; r < _buffer[1]; r++, p += IR_UPLINK_RECORD_SIZE) {
+        irUplinkRecord_t record;
+        record.protocol = p[0];
+        record.flags = p[1];
+        record.addr = p[2] | (uint16_t)p[3] << 8;
+        record.cmd = p[4];
+        record.ext = p[5];
+        record.time = p[6] | (uint32_t)p[7] << 8 | (uint32_t)p[8] << 16 | (uint32_t)p[9] << 24;
+        _stats.records++;
+        _listener.onRecord(record);
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,189 @@
+/* irbatch - Batch decoding of NEC/NECx captures, checked against the ISR decoder (and benchmarked)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build:
+ *   g++ -O2 -std=c++11 -march=native -DIR_SMALLD_NEC -I. -I../../src irbatch.cpp -o irbatch_nec
+ *   (without -march=native, or -mavx2, the SSE2 classifier is used on x86-64; other CPUs use the scalar one)
+ *
+ * Usage:
+ *   irbatch_nec [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [-p] [capture file]
+ *     -n  number of timed runs of each batch pass (the fastest one is shown, default: 10)
+ *     -p  print the decoded frames (in the same format as irdecode -q)
+ *   The other options are the same as in irdecode.
+ *
+ * The capture is decoded by the ISR (as in irdecode) and by the batch decoder (IRsmallDBatchNEC.h), and the
+ * decoded frames are compared. The exit status is 0 only if they are identical.
+ */
+
+#include "IRsmallDHostDecoder.h"
+#include "IRsmallDCapture.h"
+#include "IRsmallDBatchNEC.h"
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+
+
+struct Frame {
+  uint64_t time;
+  irSmallD_t data;
+  bool operator==(const Frame &f) const {
+    return time == f.time && data.addr == f.data.addr && data.cmd == f.data.cmd && data.keyHeld == f.data.keyHeld;
+  }
+};
+
+// Collects the edges of the capture:
+struct Edges {
+  std::vector<uint64_t> times;
+  std::vector<uint8_t> levels;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    times.push_back(timeUs);
+    levels.push_back(level);
+  }
+};
+
+// Collects the frames decoded by the ISR:
+struct IsrFrames {
+  std::vector<Frame> frames;
+  void onFrame(uint64_t timeUs, const irSmallD_t &irData) { frames.push_back(Frame{timeUs, irData}); }
+  void onReject(uint64_t, uint8_t, uint32_t) {}
+  void onRepeatIgnored(uint64_t) {}
+  void onTimeout(uint64_t, uint8_t) {}
+};
+
+// Collects the frames decoded by the batch decoder:
+struct BatchFrames {
+  const std::vector<uint64_t> &isrTimes;  // Time of each duration's ending edge
+  std::vector<Frame> frames;
+  void operator()(size_t index, const irSmallD_t &irData) { frames.push_back(Frame{isrTimes[index], irData}); }
+};
+
+
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void printFrame(const Frame &f) {
+  printf("%llu.%06llu frame addr=0x%02X cmd=0x%02X held=%d\n", (unsigned long long)(f.time / 1000000),
+         (unsigned long long)(f.time % 1000000), (unsigned)f.data.addr, f.data.cmd, f.data.keyHeld);
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [-p] [capture file]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false, print = false;
+  int runs = 10, opt;
+  while ((opt = getopt(argc, argv, "f:c:r:in:ph")) != -1) {
+    switch (opt) {
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'n': runs = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+      case 'p': print = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1) return usage(argv[0]);
+
+  FILE *file = stdin;
+  if (optind < argc) {
+    file = fopen(argv[optind], "rb");
+    if (!file) {
+      perror(argv[optind]);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(argv[optind]);
+  }
+  Edges edges;
+  IRsmallDCaptureReader<Edges> reader(options, edges);
+  bool ok = reader.read(file);
+  if (file != stdin) fclose(file);
+  if (!ok) return 1;
+
+  // ISR (one call per edge, as in irdecode):
+  IsrFrames isr;
+  IRsmallDHostDecoder<IsrFrames> decoder(isr);
+  double start = now();
+  for (size_t i = 0; i < edges.times.size(); i++) decoder.edge(edges.times[i], edges.levels[i]);
+  decoder.finish();
+  double isrTime = now() - start;
+
+  // Batch (the durations between rising edges, just like the ones measured by the ISR):
+  std::vector<uint64_t> isrTimes;
+  for (size_t i = 0; i < edges.times.size(); i++) {
+    if (edges.levels[i] == HIGH) isrTimes.push_back(edges.times[i]);
+  }
+  size_t count = isrTimes.size();
+  std::vector<uint32_t> durations(count);
+  std::vector<uint8_t> symbols(count), scalarSymbols(count);
+  uint32_t previous = UINT32_MAX;  // As the ISR's _previousTime (so the first duration is the same)
+  for (size_t i = 0; i < count; i++) {
+    durations[i] = (uint32_t)isrTimes[i] - previous;
+    previous = (uint32_t)isrTimes[i];
+  }
+
+  double scalarTime = 1e9, simdTime = 1e9, fsmTime = 1e9;
+  BatchFrames batch = {isrTimes, {}};
+  for (int run = 0; run < runs; run++) {
+    start = now();
+    IRsmallDBatchNEC::classifyScalar(durations.data(), scalarSymbols.data(), count);
+    double t1 = now();
+    IRsmallDBatchNEC::classify(durations.data(), symbols.data(), count);
+    double t2 = now();
+    IRsmallDBatchNEC batchDecoder;
+    batch.frames.clear();
+    batchDecoder.decode(durations.data(), symbols.data(), count, batch);
+    double t3 = now();
+    if (t1 - start < scalarTime) scalarTime = t1 - start;
+    if (t2 - t1 < simdTime) simdTime = t2 - t1;
+    if (t3 - t2 < fsmTime) fsmTime = t3 - t2;
+  }
+
+  if (print) {
+    for (size_t i = 0; i < batch.frames.size(); i++) printFrame(batch.frames[i]);
+  }
+  bool same = (symbols == scalarSymbols) && (batch.frames == isr.frames);
+  if (!same) {
+    if (symbols != scalarSymbols) fprintf(stderr, "The SIMD and scalar symbols differ!\n");
+    size_t n = isr.frames.size() < batch.frames.size() ? isr.frames.size() : batch.frames.size();
+    size_t i = 0;
+    while (i < n && isr.frames[i] == batch.frames[i]) i++;
+    fprintf(stderr, "Frames differ at #%zu (ISR: %zu frames, batch: %zu frames)\n", i, isr.frames.size(), batch.frames.size());
+  }
+
+  #if defined(__AVX2__)
+    const char *simd = "AVX2";
+  #elif defined(__SSE2__)
+    const char *simd = "SSE2";
+  #else
+    const char *simd = "scalar";
+  #endif
+  fprintf(stderr, IR_HOST_PROTOCOL ": %zu edges, %zu durations, %zu frames (%s)\n", edges.times.size(), count,
+          batch.frames.size(), same ? "identical" : "DIFFERENT");
+  fprintf(stderr, "  ISR (as irdecode): %8.3f ms  (%7.1f M durations/s)\n", isrTime * 1e3, count / isrTime / 1e6);
+  fprintf(stderr, "  classify (scalar): %8.3f ms  (%7.1f M durations/s)\n", scalarTime * 1e3, count / scalarTime / 1e6);
+  fprintf(stderr, "  classify (%s):   %8.3f ms  (%7.1f M durations/s)\n", simd, simdTime * 1e3, count / simdTime / 1e6);
+  fprintf(stderr, "  FSM:               %8.3f ms  (%7.1f M durations/s)\n", fsmTime * 1e3, count / fsmTime / 1e6);
+  // Both batch paths run the same FSM pass, so it limits what a faster classifier can gain:
+  fprintf(stderr, "  batch (scalar):    %8.3f ms\n", (scalarTime + fsmTime) * 1e3);
+  fprintf(stderr, "  batch (%s):      %8.3f ms  (%.1fx the scalar batch, at most %.1fx with the FSM pass)\n", simd,
+          (simdTime + fsmTime) * 1e3, (scalarTime + fsmTime) / (simdTime + fsmTime), (scalarTime + fsmTime) / fsmTime);
+  return same ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+/* irbench - Times the ISR on a capture (host nanoseconds per edge), to compare the cost of the library's options
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (one binary per protocol and set of options, e.g. with and without IR_SMALLD_DUAL_EDGE):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -I. -I../../src irbench.cpp -o irbench_nec
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -DIR_SMALLD_DUAL_EDGE -I. -I../../src irbench.cpp -o irbench_nec_dual
+ *
+ * Usage:
+ *   irbench_nec [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [capture file]
+ *     -n  number of timed runs (the fastest one is shown, default: 10)
+ *   The other options are the same as in irdecode.
+ *
+ * The capture is read into memory, and each run feeds all of its edges to the ISR through the host Arduino.h, with
+ * the library's debug prints disabled (unlike irdecode, which tracks the FSM through them). dataAvailable() is only
+ * called in the gaps between frames (10ms after the last edge, and when the FSM would time out), as a sleeping
+ * sketch would, so the time is the ISR's, plus the host's edge dispatch, which doesn't depend on the options. The time per edge is
+ * divided by all the edges of the capture (whether they call the ISR or not), and the time per frame by the frames
+ * decoded, so both can be compared between interrupt modes. Each run starts where the previous one ended (the ISR's
+ * statics can't be reset), with the times shifted so that they keep going forward.
+ */
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+#include "IRsmallDCapture.h"
+#include "IRsmallDProtocolIDs.h"
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+
+
+static const char *const c_protocolNames[] = {"?", "NEC", "NECx", "RC5", "SIRC12", "SIRC15", "SIRC20", "SIRC",
+                                              "SAMSUNG", "SAMSUNG32", "HASH"};  // By IR_SMALLD_PROTOCOL_ID
+
+// Collects the edges of the capture:
+struct Edges {
+  std::vector<uint64_t> times;
+  std::vector<uint8_t> levels;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    times.push_back(timeUs);
+    levels.push_back(level);
+  }
+};
+
+
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+const uint32_t c_pollGap = 10000;  // µs, longer than any pulse or space inside a frame
+
+// Calls dataAvailable() at the given times after the last edge, if they come before the next edge (at gap µs):
+static uint32_t poll(IRsmallDecoder &decoder, uint32_t last, uint32_t gap) {
+  const uint32_t first = c_pollGap < (uint32_t)IR_SMALLD_TIMEOUT ? c_pollGap : (uint32_t)IR_SMALLD_TIMEOUT;
+  const uint32_t second = c_pollGap < (uint32_t)IR_SMALLD_TIMEOUT ? (uint32_t)IR_SMALLD_TIMEOUT : c_pollGap;
+  irSmallD_t irData;
+  uint32_t frames = 0;
+  if (gap >= first) {
+    IRsmallDHost::setMicros(last + first);
+    frames += decoder.dataAvailable(irData);
+  }
+  if (gap >= second) {
+    IRsmallDHost::setMicros(last + second);
+    frames += decoder.dataAvailable(irData);
+  }
+  return frames;
+}
+
+// Feeds the edges to the ISR (shifted by offset µs) and returns the number of frames decoded:
+static uint32_t decode(IRsmallDecoder &decoder, const Edges &edges, uint32_t offset) {
+  uint32_t frames = 0, last = offset;
+  for (size_t i = 0; i < edges.times.size(); i++) {
+    uint32_t time = (uint32_t)edges.times[i] + offset;
+    if (time - last >= c_pollGap) frames += poll(decoder, last, time - last);  // Only between frames
+    IRsmallDHost::setMicros(time);
+    IRsmallDHost::edge(edges.levels[i]);
+    last = time;
+  }
+  return frames + poll(decoder, last, UINT32_MAX);
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [capture file]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false;
+  int runs = 10, opt;
+  while ((opt = getopt(argc, argv, "f:c:r:in:h")) != -1) {
+    switch (opt) {
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'n': runs = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1) return usage(argv[0]);
+
+  FILE *file = stdin;
+  if (optind < argc) {
+    file = fopen(argv[optind], "rb");
+    if (!file) {
+      perror(argv[optind]);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(argv[optind]);
+  }
+  Edges edges;
+  IRsmallDCaptureReader<Edges> reader(options, edges);
+  bool ok = reader.read(file);
+  if (file != stdin) fclose(file);
+  if (!ok) return 1;
+  if (edges.times.empty()) {
+    fprintf(stderr, "No edges in the capture\n");
+    return 1;
+  }
+
+  IRsmallDecoder decoder(0);
+  uint32_t span = (uint32_t)edges.times.back() + 1000000;  // Each run starts 1s after the previous one ended
+  uint32_t frames = 0;
+  double best = 1e9;
+  for (int run = 0; run < runs; run++) {
+    double start = now();
+    uint32_t decoded = decode(decoder, edges, (uint32_t)run * span);
+    double time = now() - start;
+    if (run == 0) frames = decoded;
+    if (time < best) best = time;
+  }
+
+  size_t count = edges.times.size();
+  fprintf(stderr, "%s (ISR on %s edges): %zu edges, %u frames, fastest of %d runs: %.3f ms (%.1f ns/edge",
+          c_protocolNames[IR_SMALLD_PROTOCOL_ID], IR_ISR_MODE == CHANGE ? "both" : (IR_ISR_MODE == RISING ? "rising" : "falling"),
+          count, frames, runs, best * 1e3, best / count * 1e9);
+  if (frames) fprintf(stderr, ", %.0f ns/frame", best / frames * 1e9);
+  fprintf(stderr, ")\n");
+  return 0;
+}
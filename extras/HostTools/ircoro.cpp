@@ -0,0 +1,196 @@
+/* ircoro - Decodes a capture with the ISR and with the coroutine decoder, compares them and benchmarks both
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (NEC, NECx or RC5):
+ *   g++ -O2 -std=c++20 -DIR_SMALLD_NEC -I. -I../../src ircoro.cpp -o ircoro_nec
+ *
+ * Usage:
+ *   ircoro_nec [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [-p] [capture file]
+ *     -n  number of timed runs of each decoder (the fastest one is shown, default: 10)
+ *     -p  print the frames decoded by the coroutine (in the same format as irdecode -q)
+ *   The other options are the same as in irdecode.
+ *
+ * Both decoders get the same edges: the ISR through the host Arduino.h (with dataAvailable() called after each
+ * ISR call, and when nextDeadline() expires, as a sketch would) and the coroutine (IRsmallDCoProtocols.h) through
+ * IRsmallDCoRunner. The decoded frames are compared and the exit status is 0 only if they are identical.
+ * The timed runs are separate from that comparison, and do the same work for both decoders: one call per edge,
+ * through the host's edge dispatch (IRsmallDHost::edge(), which filters the edges as the runner does, and calls the
+ * ISR) or IRsmallDCoRunner::edge(). Neither decoder is polled, and the frames are not collected.
+ */
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+#include "IRsmallDCapture.h"
+#include "IRsmallDCoProtocols.h"
+#include <unistd.h>
+#include <time.h>
+#include <vector>
+
+#if defined(IR_SMALLD_NEC)
+  #define IR_CORO_PROTOCOL "NEC"
+#elif defined(IR_SMALLD_NECx)
+  #define IR_CORO_PROTOCOL "NECx"
+#else
+  #define IR_CORO_PROTOCOL "RC5"
+#endif
+
+
+struct Frame {
+  uint64_t time;
+  irSmallD_t data;
+  bool operator==(const Frame &f) const {
+    return time == f.time && data.addr == f.data.addr && data.cmd == f.data.cmd && data.keyHeld == f.data.keyHeld;
+  }
+};
+
+// Collects the edges of the capture:
+struct Edges {
+  std::vector<uint64_t> times;
+  std::vector<uint8_t> levels;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    times.push_back(timeUs);
+    levels.push_back(level);
+  }
+};
+
+
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void printFrame(const Frame &f) {
+  printf("%llu.%06llu frame addr=0x%02X cmd=0x%02X held=%d\n", (unsigned long long)(f.time / 1000000),
+         (unsigned long long)(f.time % 1000000), (unsigned)f.data.addr, f.data.cmd, f.data.keyHeld);
+}
+
+// Polls the decoder if its deadline expired before timeUs (the FSM is reset by dataAvailable()):
+static void pollDeadline(IRsmallDecoder &decoder, uint64_t timeUs, std::vector<Frame> &frames) {
+  uint32_t deadline;
+  if (!decoder.nextDeadline(deadline)) return;
+  int32_t late = (int32_t)((uint32_t)timeUs - deadline);
+  if (late < 0) return;
+  irSmallD_t irData;
+  IRsmallDHost::setMicros(deadline);
+  if (decoder.dataAvailable(irData)) frames.push_back(Frame{timeUs - late, irData});
+}
+
+static void decodeIsr(IRsmallDecoder &decoder, const Edges &edges, std::vector<Frame> &frames) {
+  irSmallD_t irData;
+  for (size_t i = 0; i < edges.times.size(); i++) {
+    uint64_t time = edges.times[i];
+    pollDeadline(decoder, time, frames);
+    IRsmallDHost::setMicros((uint32_t)time);
+    if (IRsmallDHost::edge(edges.levels[i]) && decoder.dataAvailable(irData)) frames.push_back(Frame{time, irData});
+  }
+  if (!edges.times.empty()) pollDeadline(decoder, edges.times.back() + IR_SMALLD_TIMEOUT, frames);
+}
+
+static void decodeCoroutine(const Edges &edges, std::vector<Frame> &frames) {
+  IRsmallDCoRunner<IRsmallDCoDecoder> runner;
+  for (size_t i = 0; i < edges.times.size(); i++) {
+    if (runner.edge(edges.times[i], edges.levels[i])) frames.push_back(Frame{edges.times[i], runner.data()});
+  }
+}
+
+// Timed runs (the ISR's times are shifted by offset, so that they keep going forward from the previous run):
+static void timeIsr(const Edges &edges, uint32_t offset) {
+  for (size_t i = 0; i < edges.times.size(); i++) {
+    IRsmallDHost::setMicros((uint32_t)edges.times[i] + offset);
+    IRsmallDHost::edge(edges.levels[i]);
+  }
+}
+
+static void timeCoroutine(const Edges &edges) {
+  IRsmallDCoRunner<IRsmallDCoDecoder> runner;
+  for (size_t i = 0; i < edges.times.size(); i++) runner.edge(edges.times[i], edges.levels[i]);
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n runs] [-p] [capture file]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false, print = false;
+  int runs = 10, opt;
+  while ((opt = getopt(argc, argv, "f:c:r:in:ph")) != -1) {
+    switch (opt) {
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'n': runs = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+      case 'p': print = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1) return usage(argv[0]);
+
+  FILE *file = stdin;
+  if (optind < argc) {
+    file = fopen(argv[optind], "rb");
+    if (!file) {
+      perror(argv[optind]);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(argv[optind]);
+  }
+  Edges edges;
+  IRsmallDCaptureReader<Edges> reader(options, edges);
+  bool ok = reader.read(file);
+  if (file != stdin) fclose(file);
+  if (!ok) return 1;
+
+  // The comparison comes first: the ISR's statics can't be reset, so the timed runs start where it ended.
+  IRsmallDecoder decoder(0);
+  std::vector<Frame> isrFrames, coFrames;
+  decodeIsr(decoder, edges, isrFrames);
+  decodeCoroutine(edges, coFrames);
+
+  uint32_t span = edges.times.empty() ? 0 : (uint32_t)edges.times.back() + 1000000;  // 1s after the previous run
+  double isrTime = 1e9, coTime = 1e9;
+  for (int run = 0; run < runs; run++) {
+    double start = now();
+    timeIsr(edges, (uint32_t)(run + 1) * span);
+    double t1 = now();
+    timeCoroutine(edges);
+    double t2 = now();
+    if (t1 - start < isrTime) isrTime = t1 - start;
+    if (t2 - t1 < coTime) coTime = t2 - t1;
+  }
+
+  if (print) {
+    for (size_t i = 0; i < coFrames.size(); i++) printFrame(coFrames[i]);
+  }
+  bool same = (isrFrames == coFrames);
+  if (!same) {
+    size_t n = isrFrames.size() < coFrames.size() ? isrFrames.size() : coFrames.size();
+    size_t i = 0;
+    while (i < n && isrFrames[i] == coFrames[i]) i++;
+    fprintf(stderr, "Frames differ at #%zu (ISR: %zu frames, coroutine: %zu frames)\n", i, isrFrames.size(), coFrames.size());
+  }
+
+  size_t count = edges.times.size();
+  fprintf(stderr, IR_CORO_PROTOCOL ": %zu edges, %zu frames (%s)\n", count, coFrames.size(), same ? "identical" : "DIFFERENT");
+  fprintf(stderr, "  ISR:        %8.3f ms  (%6.1f ns/edge)\n", isrTime * 1e3, isrTime / count * 1e9);
+  fprintf(stderr, "  coroutine:  %8.3f ms  (%6.1f ns/edge, %.2fx the ISR's time)\n", coTime * 1e3, coTime / count * 1e9,
+          coTime / isrTime);
+  return same ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/* irdecode - Offline decoder for logic analyzer captures of an IR receiver's output
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (one binary per protocol, selected just like in a sketch):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -I. -I../../src irdecode.cpp -o irdecode_nec
+ *
+ * Usage:
+ *   irdecode_nec [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-q] [-s] [capture file]
+ *     -f  capture format (by default, it's guessed from the file's extension: .csv, .vcd, .irrec, other = list)
+ *     -c  channel: CSV column name or number, VCD signal name or identifier (default: the first one)
+ *     -r  CSV sample rate in Hz (if the file has no "Time" column and no "; Samplerate:" comment)
+ *     -i  invert the signal levels
+ *     -q  quiet: only print the decoded frames
+ *     -s  poll the decoder as a low power sketch would (sleeping with isIdle() and nextDeadline()), and report how
+ *         long it could sleep; the decoded output must be the same
+ *   The capture is read from the standard input if no file is given.
+ *
+ * Output (one line per event, times in seconds from the start of the capture):
+ *   0.117562 frame addr=0x00 cmd=0x45 held=0
+ *   0.301114 reject state=Receiving interval=3021
+ *   0.352000 timeout state=StartPulse
+ */
+
+#include "IRsmallDHostPrinter.h"
+#include "IRsmallDCapture.h"
+#include <unistd.h>
+#include <time.h>
+
+
+struct EdgeCounter {
+  IRsmallDHostDecoder<IRsmallDHostPrinter> &decoder;
+  uint64_t count;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    count++;
+    decoder.edge(timeUs, level);
+  }
+};
+
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-q] [-s] [capture file]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false;
+  IRsmallDHostPrinter printer;
+  bool sleep = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "f:c:r:iqsh")) != -1) {
+    switch (opt) {
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'q': printer.quiet = true; break;
+      case 's': sleep = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1) return usage(argv[0]);
+
+  FILE *file = stdin;
+  if (optind < argc) {
+    file = fopen(argv[optind], "rb");
+    if (!file) {
+      perror(argv[optind]);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(argv[optind]);
+  }
+
+  static char outBuffer[1 << 16];
+  setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+
+  IRsmallDHostDecoder<IRsmallDHostPrinter> decoder(printer);
+  if (sleep) decoder.simulateSleep();
+  EdgeCounter counter = {decoder, 0};
+  IRsmallDCaptureReader<EdgeCounter> reader(options, counter);
+  clock_t start = clock();
+  bool ok = reader.read(file);
+  decoder.finish();
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  fflush(stdout);
+  if (file != stdin) fclose(file);
+
+  if (reader.recorderProtocol() && reader.recorderProtocol() != IR_SMALLD_PROTOCOL_ID) {
+    fprintf(stderr, "Warning: the recording was made with another protocol (ID %u)\n", reader.recorderProtocol());
+  }
+  fprintf(stderr, IR_HOST_PROTOCOL ": %llu edges, %llu frames, %llu ignored repeats, %llu rejects, %llu timeouts",
+          (unsigned long long)counter.count, (unsigned long long)printer.frames, (unsigned long long)printer.ignoredRepeats,
+          (unsigned long long)printer.rejects, (unsigned long long)printer.timeouts);
+  if (seconds > 0) fprintf(stderr, " (%.1f M edges/s)", counter.count / seconds / 1e6);
+  fputc('\n', stderr);
+  if (sleep) {
+    const IRsmallDHostDecoder<IRsmallDHostPrinter>::SleepStats &stats = decoder.sleepStats();
+    fprintf(stderr, "Asleep: %.3f s idle, %.3f s with a frame pending; woken up by %llu edges and %llu deadlines\n",
+            stats.idleUs / 1e6, stats.pendingUs / 1e6, (unsigned long long)stats.edgeWakeups,
+            (unsigned long long)stats.deadlineWakeups);
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+/* irfleet - Decodes many captures in parallel and aggregates their statistics (for fleet logs)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (one binary per protocol, as irdecode; add -DIR_SMALLD_QUALITY for the signal quality distribution):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -DIR_SMALLD_QUALITY -I. -I../../src irfleet.cpp -o irfleet_nec
+ *
+ * Usage:
+ *   irfleet_nec [-j jobs] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-l] [file or folder...]
+ *     -j  number of files decoded at the same time (default: the number of CPUs)
+ *     -l  also print one CSV line per file (to the standard output, before the summary)
+ *   Folders are searched recursively (hidden files are skipped). Without files or folders, the file names are
+ *   read from the standard input, one per line (e.g. from find). The format is guessed from each file's extension,
+ *   unless -f is given. The other options are the same as in irdecode.
+ *
+ * How it works:
+ *   The ISRs keep their state in static variables, so there can only be one decoder per process. So, each file is
+ *   decoded by its own process, forked from a process that never used the decoder: each file starts with a fresh
+ *   FSM, and a file that crashes the decoder doesn't stop the others. Up to "jobs" processes run at the same time,
+ *   and the largest files are started first, so that the last ones to finish are small. The results are written to
+ *   shared memory (one slot per file) and the summary is printed when all of them are done.
+ *
+ * Summary (to the standard error):
+ *   - files, edges, frames (and held frames), ignored repeats, rejects and timeouts;
+ *   - decode rate: frames / (frames + rejects + timeouts), for all the files and its distribution over the files (the
+ *     initial repeat codes, which the decoders ignore on purpose, are not attempts);
+ *   - rejects by FSM state and by the interval that didn't fit (powers of 2, in µs);
+ *   - signal quality of the frames (with IR_SMALLD_QUALITY), in steps of 10.
+ */
+
+#include "IRsmallDHostDecoder.h"
+#include "IRsmallDCapture.h"
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+const uint8_t c_maxStates = 8;
+const uint8_t c_intervalBins = 18;  // < 2^6 µs, [2^6, 2^7[, ... , >= 2^22 µs
+const uint8_t c_qualityBins = 11;   // 0-9, 10-19, ..., 90-99, 100
+
+enum irFileStatus_t : uint8_t { FILE_PENDING, FILE_DONE, FILE_UNREADABLE, FILE_BAD_FORMAT, FILE_CRASHED };
+
+// Results of a file (in shared memory, so only plain data):
+struct FileStats {
+  irFileStatus_t status;
+  uint64_t edges, frames, heldFrames, ignoredRepeats, rejects, timeouts;
+  uint64_t rejectsByState[c_maxStates];
+  uint64_t rejectsByInterval[c_intervalBins];
+  uint64_t quality[c_qualityBins];
+
+  void add(const FileStats &s) {
+    edges += s.edges;
+    frames += s.frames;
+    heldFrames += s.heldFrames;
+    ignoredRepeats += s.ignoredRepeats;
+    rejects += s.rejects;
+    timeouts += s.timeouts;
+    for (uint8_t i = 0; i < c_maxStates; i++) rejectsByState[i] += s.rejectsByState[i];
+    for (uint8_t i = 0; i < c_intervalBins; i++) rejectsByInterval[i] += s.rejectsByInterval[i];
+    for (uint8_t i = 0; i < c_qualityBins; i++) quality[i] += s.quality[i];
+  }
+  uint64_t attempts() const { return frames + rejects + timeouts; }
+};
+
+
+struct FleetListener {
+  FileStats &stats;
+
+  void onFrame(uint64_t, const irSmallD_t &irData) {
+    stats.frames++;
+    #if defined(IR_SMALLD_HAS_KEYHELD)
+      if (irData.keyHeld) stats.heldFrames++;
+    #endif
+    #if defined(IR_SMALLD_QUALITY)
+      stats.quality[irData.quality / 10 < c_qualityBins ? irData.quality / 10 : c_qualityBins - 1]++;
+    #endif
+    (void)irData;
+  }
+
+  void onReject(uint64_t, uint8_t state, uint32_t interval) {
+    stats.rejects++;
+    stats.rejectsByState[state < c_maxStates ? state : c_maxStates - 1]++;
+    uint8_t bin = 0;
+    for (uint32_t limit = 64; bin < c_intervalBins - 1 && interval >= limit; limit <<= 1) bin++;
+    stats.rejectsByInterval[bin]++;
+  }
+
+  void onRepeatIgnored(uint64_t) { stats.ignoredRepeats++; }
+
+  void onTimeout(uint64_t, uint8_t) { stats.timeouts++; }
+};
+
+struct EdgeCounter {
+  IRsmallDHostDecoder<FleetListener> &decoder;
+  uint64_t &count;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    count++;
+    decoder.edge(timeUs, level);
+  }
+};
+
+
+// Decodes a file (in a child process):
+static irFileStatus_t decodeFile(const char *name, const irCaptureOptions_t &defaults, bool formatGiven, FileStats &stats) {
+  FILE *file = fopen(name, "rb");
+  if (!file) return FILE_UNREADABLE;
+  irCaptureOptions_t options = defaults;
+  if (!formatGiven) options.format = irCaptureFormatFromName(name);
+  FleetListener listener = {stats};
+  IRsmallDHostDecoder<FleetListener> decoder(listener);
+  EdgeCounter counter = {decoder, stats.edges};
+  IRsmallDCaptureReader<EdgeCounter> reader(options, counter);
+  bool ok = reader.read(file);
+  decoder.finish();
+  fclose(file);
+  return ok ? FILE_DONE : FILE_BAD_FORMAT;
+}
+
+
+struct CaptureFile {
+  std::string name;
+  off_t size;
+};
+
+static void addPath(const std::string &path, std::vector<CaptureFile> &files) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) {
+    files.push_back(CaptureFile{path, 0});  // Reported as unreadable
+    return;
+  }
+  if (!S_ISDIR(st.st_mode)) {
+    files.push_back(CaptureFile{path, st.st_size});
+    return;
+  }
+  DIR *dir = opendir(path.c_str());
+  if (!dir) return;
+  std::vector<std::string> names;
+  while (struct dirent *entry = readdir(dir)) {
+    if (entry->d_name[0] != '.') names.push_back(entry->d_name);
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+  for (size_t i = 0; i < names.size(); i++) addPath(path + "/" + names[i], files);
+}
+
+
+static double now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static const char *stateName(uint8_t state) {
+  return state < sizeof(c_irStateNames) / sizeof(c_irStateNames[0]) ? c_irStateNames[state] : "?";
+}
+
+static double percent(uint64_t part, uint64_t total) { return total ? 100.0 * part / total : 0; }
+
+static void bar(const char *label, uint64_t count, uint64_t total) {
+  double p = percent(count, total);
+  fprintf(stderr, "    %-14s %10llu %5.1f%% ", label, (unsigned long long)count, p);
+  for (int i = 0; i < (int)(p / 2.5 + 0.5); i++) fputc('#', stderr);
+  fputc('\n', stderr);
+}
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-j jobs] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-l] [file or folder...]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false, perFile = false;
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  int opt;
+  while ((opt = getopt(argc, argv, "j:f:c:r:ilh")) != -1) {
+    switch (opt) {
+      case 'j': jobs = atol(optarg); break;
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'l': perFile = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (jobs < 1) jobs = 1;
+
+  std::vector<CaptureFile> files;
+  if (optind < argc) {
+    for (int i = optind; i < argc; i++) addPath(argv[i], files);
+  } else {
+    char line[4096];
+    while (fgets(line, sizeof(line), stdin)) {
+      line[strcspn(line, "\r\n")] = 0;
+      if (line[0]) addPath(line, files);
+    }
+  }
+  if (files.empty()) {
+    fprintf(stderr, "No capture files\n");
+    return 1;
+  }
+
+  // One slot per file, shared with the child processes:
+  size_t count = files.size();
+  FileStats *results = (FileStats *)mmap(nullptr, count * sizeof(FileStats), PROT_READ | PROT_WRITE,
+                                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (results == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }  // (anonymous mappings are zero-filled, so every slot starts as FILE_PENDING)
+
+  std::vector<size_t> order(count);  // Largest files first
+  for (size_t i = 0; i < count; i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return files[a].size > files[b].size; });
+
+  fflush(stdout);
+  double start = now();
+  std::vector<std::pair<pid_t, size_t>> running;
+  size_t next = 0;
+  while (next < count || !running.empty()) {
+    while (next < count && (long)running.size() < jobs) {
+      size_t index = order[next++];
+      pid_t pid = fork();
+      if (pid == 0) {
+        if (!freopen("/dev/null", "w", stderr)) _exit(1);  // The reader's parsing errors are reported by the status
+        results[index].status = decodeFile(files[index].name.c_str(), options, formatGiven, results[index]);
+        _exit(0);
+      }
+      if (pid < 0) {
+        perror("fork");
+        results[index].status = FILE_CRASHED;
+        continue;
+      }
+      running.push_back(std::make_pair(pid, index));
+    }
+    int status;
+    pid_t pid = wait(&status);
+    if (pid < 0) break;
+    for (size_t i = 0; i < running.size(); i++) {
+      if (running[i].first != pid) continue;
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || results[running[i].second].status == FILE_PENDING) {
+        results[running[i].second].status = FILE_CRASHED;
+      }
+      running.erase(running.begin() + i);
+      break;
+    }
+  }
+  double seconds = now() - start;
+
+  // Per file lines and totals:
+  static const char *const c_statusNames[] = {"pending", "ok", "unreadable", "bad format", "crashed"};
+  if (perFile) printf("file,status,edges,frames,held,ignored_repeats,rejects,timeouts,decode_rate\n");
+  FileStats total = {};
+  size_t statusCount[5] = {0, 0, 0, 0, 0}, silent = 0;
+  std::vector<double> rates;
+  for (size_t i = 0; i < count; i++) {
+    const FileStats &s = results[i];
+    statusCount[s.status]++;
+    if (s.status == FILE_DONE) {
+      total.add(s);
+      if (s.attempts()) rates.push_back(percent(s.frames, s.attempts()));
+      if (!s.frames) silent++;
+    }
+    if (perFile) {
+      printf("%s,%s,%llu,%llu,%llu,%llu,%llu,%llu,%.2f\n", files[i].name.c_str(), c_statusNames[s.status],
+             (unsigned long long)s.edges, (unsigned long long)s.frames, (unsigned long long)s.heldFrames,
+             (unsigned long long)s.ignoredRepeats, (unsigned long long)s.rejects, (unsigned long long)s.timeouts, percent(s.frames, s.attempts()));
+    }
+  }
+  fflush(stdout);
+
+  fprintf(stderr, IR_HOST_PROTOCOL ": %zu files (%zu decoded", count, statusCount[FILE_DONE]);
+  if (statusCount[FILE_UNREADABLE]) fprintf(stderr, ", %zu unreadable", statusCount[FILE_UNREADABLE]);
+  if (statusCount[FILE_BAD_FORMAT]) fprintf(stderr, ", %zu with format errors", statusCount[FILE_BAD_FORMAT]);
+  if (statusCount[FILE_CRASHED]) fprintf(stderr, ", %zu CRASHED", statusCount[FILE_CRASHED]);
+  fprintf(stderr, ", %zu without frames)\n", silent);
+  fprintf(stderr, "  %llu edges, %llu frames", (unsigned long long)total.edges, (unsigned long long)total.frames);
+  #if defined(IR_SMALLD_HAS_KEYHELD)
+    fprintf(stderr, " (%llu held)", (unsigned long long)total.heldFrames);
+  #endif
+  fprintf(stderr, ", %llu ignored repeats, %llu rejects, %llu timeouts\n", (unsigned long long)total.ignoredRepeats,
+          (unsigned long long)total.rejects, (unsigned long long)total.timeouts);
+  fprintf(stderr, "  decode rate: %.2f%%", percent(total.frames, total.attempts()));
+  if (!rates.empty()) {
+    std::sort(rates.begin(), rates.end());
+    size_t n = rates.size() - 1;
+    fprintf(stderr, " (per file: min %.1f%%, 10%% %.1f%%, median %.1f%%, 90%% %.1f%%, max %.1f%%)", rates[0],
+            rates[n / 10], rates[n / 2], rates[n - n / 10], rates[n]);
+  }
+  fputc('\n', stderr);
+
+  if (total.rejects) {
+    fprintf(stderr, "  rejects by state:\n");
+    for (uint8_t i = 0; i < c_maxStates; i++) {
+      if (total.rejectsByState[i]) bar(stateName(i), total.rejectsByState[i], total.rejects);
+    }
+    fprintf(stderr, "  rejects by interval (µs):\n");
+    for (uint8_t i = 0; i < c_intervalBins; i++) {
+      if (!total.rejectsByInterval[i]) continue;
+      char label[24];
+      if (i == 0) snprintf(label, sizeof(label), "< 64");
+      else if (i == c_intervalBins - 1) snprintf(label, sizeof(label), ">= %lu", 32ul << i);
+      else snprintf(label, sizeof(label), "%lu-%lu", 32ul << i, (64ul << i) - 1);
+      bar(label, total.rejectsByInterval[i], total.rejects);
+    }
+  }
+  #if defined(IR_SMALLD_QUALITY)
+    if (total.frames) {
+      fprintf(stderr, "  signal quality:\n");
+      for (uint8_t i = 0; i < c_qualityBins; i++) {
+        char label[24];
+        if (i == c_qualityBins - 1) snprintf(label, sizeof(label), "100");
+        else snprintf(label, sizeof(label), "%u-%u", i * 10, i * 10 + 9);
+        bar(label, total.quality[i], total.frames);
+      }
+    }
+  #endif
+  fprintf(stderr, "  %.3f s with %ld jobs (%.1f M edges/s)\n", seconds, jobs, seconds > 0 ? total.edges / seconds / 1e6 : 0);
+
+  munmap(results, count * sizeof(FileStats));
+  return statusCount[FILE_DONE] == count ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/* irhandoff - Stress test of the multi-core handoff (IR_SMALLD_MULTICORE), to be run with ThreadSanitizer
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (with ThreadSanitizer, which reports any data race between the two threads):
+ *   g++ -O1 -g -std=c++11 -fsanitize=thread -pthread -DIR_SMALLD_NEC -DIR_SMALLD_MULTICORE -I. -I../../src \
+ *       irhandoff.cpp -o irhandoff
+ *
+ * Usage:
+ *   irhandoff [-n frames] [-s seed]
+ *     -n  number of frames sent (default: 20000)
+ *     -s  seed of the random generator (default: 1)
+ *
+ * How it works:
+ *   A producer thread plays the ISR's core: it sends NEC frames, edge by edge, through the host Arduino.h, with a
+ *   random busy wait after each edge (and, sometimes, a yield: with a single CPU, the threads only interleave
+ *   then). One frame in four is cut short, and the clock then jumps past the timeout, so that the timeout reset
+ *   (run by dataAvailable()) races with the next frame's edges, which the ISR queues while the reset has the FSM
+ *   locked. A consumer thread calls dataAvailable() in a loop, as loop() would on the other core, and checks every
+ *   frame it gets (the command of each address is known, so a frame mixed with another one by a torn copy is
+ *   caught). The decoder's debug prints count the frames published by the ISR, and the ones it replaced before
+ *   they were read: every published frame must be either received or replaced. At the end, the FSM must be idle
+ *   (no edge left in the queue).
+ *   The exit status is 1 if a frame was wrong, if a published frame is missing (or was received twice), or if
+ *   the FSM is not idle.
+ */
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#define IRSMALLD_DEBUG_STATE  // For the PUBLISHED and OVERWRITTEN prints
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+
+static IRsmallDecoder g_decoder(0);
+static std::atomic<bool> g_done(false);
+static std::atomic<uint32_t> g_published(0);    // Frames published by the ISR (or by the timeout reset)
+static std::atomic<uint32_t> g_overwritten(0);  // Published frames replaced before being read
+
+static uint64_t g_random = 0x9E3779B97F4A7C15ULL ^ 1;  // xorshift64* (only used by the producer)
+static uint32_t random(uint32_t range) {
+  g_random ^= g_random >> 12;
+  g_random ^= g_random << 25;
+  g_random ^= g_random >> 27;
+  return (uint32_t)((g_random * 2685821657736338717ULL) >> 32) % range;
+}
+
+static uint8_t commandOf(uint8_t addr) { return addr * 37 + 5; }
+
+// The debug prints come from both threads (the other FSM states are ignored):
+static void onPrintText(const char *text) {
+  if (!strcmp(text, "\nPUBLISHED\n")) g_published++;
+  else if (!strcmp(text, "\nOVERWRITTEN\n")) g_overwritten++;
+}
+
+// Busy wait, and sometimes a yield (so that the threads also interleave on a single CPU):
+static void busyWait(uint32_t loops) {
+  for (volatile uint32_t i = 0; i < loops; i = i + 1) {}
+  if (random(16) == 0) std::this_thread::yield();
+}
+
+// Sends a mark (pulse, then space) starting at time t, as the receiver's output (active low):
+static void mark(uint32_t &t, uint32_t pulse, uint32_t space) {
+  IRsmallDHost::setMicros(t);
+  IRsmallDHost::edge(LOW);
+  busyWait(random(200));
+  t += pulse;
+  IRsmallDHost::setMicros(t);
+  IRsmallDHost::edge(HIGH);
+  busyWait(random(200));
+  t += space;
+}
+
+// Sends the first bits of a NEC frame (all 32 and the stop pulse, for a whole frame):
+static void sendFrame(uint32_t &t, uint8_t addr, int bits) {
+  uint32_t data = addr | (uint32_t)(uint8_t)~addr << 8 | (uint32_t)commandOf(addr) << 16
+                | (uint32_t)(uint8_t)~commandOf(addr) << 24;
+  mark(t, 9000, 4500);
+  for (int i = 0; i < bits; i++) mark(t, 560, (data >> i) & 1 ? 1690 : 560);
+  if (bits == 32) mark(t, 560, 0);
+}
+
+static void producer(uint32_t frames, uint32_t *sent) {
+  uint32_t t = 1000000;
+  for (uint32_t i = 0; i < frames; i++) {
+    if (random(4) == 0) {  // Cut short, then a jump past the timeout
+      sendFrame(t, i, 1 + random(31));
+      t += IR_SMALLD_TIMEOUT + 1000;
+      IRsmallDHost::setMicros(t);
+      busyWait(random(2000));  // The consumer may or may not reset the FSM before the next frame
+    }
+    sendFrame(t, i, 32);
+    (*sent)++;
+    t += 40000;
+  }
+  IRsmallDHost::setMicros(t + IR_SMALLD_TIMEOUT + 1000);
+  g_done.store(true);
+}
+
+static void consumer(uint32_t *received, uint32_t *wrong) {
+  irSmallD_t irData;
+  bool done = false;
+  while (!done) {
+    done = g_done.load();  // One more call after the producer is done
+    if (g_decoder.dataAvailable(irData)) {
+      if (irData.cmd != commandOf(irData.addr) || irData.keyHeld) {
+        if ((*wrong)++ < 10) printf("Wrong frame: addr=0x%02X cmd=0x%02X held=%d\n", irData.addr, irData.cmd, irData.keyHeld);
+      }
+      else (*received)++;
+    }
+    else std::this_thread::yield();
+  }
+}
+
+
+int main(int argc, char *argv[]) {
+  uint32_t frames = 20000;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:s:h")) != -1) {
+    switch (opt) {
+      case 'n': frames = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+      case 's': g_random = 0x9E3779B97F4A7C15ULL ^ strtoull(optarg, NULL, 0); break;
+      default:
+        fprintf(stderr, "Usage: %s [-n frames] [-s seed]\n", argv[0]);
+        return 2;
+    }
+  }
+
+  IRsmallDHost::state().onPrintText = onPrintText;
+  uint32_t sent = 0, received = 0, wrong = 0;
+  std::thread consumerThread(consumer, &received, &wrong);
+  std::thread producerThread(producer, frames, &sent);
+  producerThread.join();
+  consumerThread.join();
+
+  bool idle = g_decoder.isIdle();
+  uint32_t published = g_published, overwritten = g_overwritten;
+  bool accounted = received + wrong + overwritten == published;
+  printf("%u frames sent, %u published, %u received (%.1f%%), %u overwritten, %u wrong, FSM %s at the end\n",
+         sent, published, received, 100.0 * received / sent, overwritten, wrong, idle ? "idle" : "NOT idle");
+  if (!accounted) printf("%d published frames missing\n", (int)(published - received - wrong - overwritten));
+  return (wrong || !accounted || !idle) ? 1 : 0;
+}
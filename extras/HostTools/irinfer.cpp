@@ -0,0 +1,496 @@
+/* irinfer - Infers the timings of an unknown remote control from a capture, and writes them as a decoder header
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (it doesn't use the decoders, so no protocol is selected):
+ *   g++ -O2 -std=c++11 -I. irinfer.cpp -o irinfer
+ *
+ * Usage:
+ *   irinfer [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n name] [-g gap] [capture file] > IRsmallD_NAME.h
+ *     -f, -c, -r, -i  same as irdecode's
+ *     -n  protocol name, used in the header's defines (default: REMOTE)
+ *     -g  minimum gap between frames in µs (default: 5000); shorter spaces are part of a frame
+ *   The capture should have several key presses, with different keys, and at least one held key.
+ *
+ * How it works:
+ *   The capture is split into frames (at the spaces longer than the gap) and the frames into key presses: a frame
+ *   less than c_pressGap after the previous one is a repetition if it's a repeat code or the same code (a different
+ *   code is another key). Only the repetitions give the gaps and the repetition period. The durations of the pulses (IR on, receiver's output LOW) and spaces
+ *   are clustered with a logarithmic histogram: each run of non-empty bins is a peak, and the tiny ones are noise.
+ *   Then, the clusters of the data pulses and spaces (after the leading ones, if they are longer) tell the encoding:
+ *     pulse distance - one pulse length, two space lengths (NEC, SAMSUNG);
+ *     pulse width    - two pulse lengths, one space length (SIRC);
+ *     Manchester     - two pulse and two space lengths, the long ones twice the short ones (RC5).
+ *   The frames with less than half the pulses of the longest ones are taken as repeat codes.
+ *
+ * Output:
+ *   A header in the style of the library's decoders is written to the standard output: the nominal timings, as
+ *   defines, and the thresholds derived from them, as the constants that the decoders declare in their ISRs. It has
+ *   no ISR, since the FSM can't be inferred: the header names the decoder whose FSM decodes the same kind of signal,
+ *   to be adapted by hand. The intervals are measured as the ISRs measure them: between the ends of the IR pulses
+ *   for pulse distance and pulse width (RISING mode), and between all the edges for Manchester (CHANGE mode). The
+ *   clusters, frame structures and received codes are printed to the standard error.
+ *   The header is a starting point for a new decoder: the values are measured, not the manufacturer's.
+ */
+
+#include "IRsmallDCapture.h"
+#include <unistd.h>
+#include <math.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+
+static const uint32_t c_pressGap = 250000;  // Frames closer than this (µs) are repetitions within a key press
+static const double   c_binRatio = 1.04;    // Histogram bins are 4% wide
+static const double   c_leadRatio = 1.5;    // A leading pulse (or space) is at least 1.5 times the longest data one
+static const size_t   c_maxCodes = 16;      // Codes listed in the analysis
+
+enum Encoding { ENC_UNKNOWN, ENC_PULSE_DISTANCE, ENC_PULSE_WIDTH, ENC_MANCHESTER };
+
+
+struct Frame {
+  uint64_t start = 0;
+  std::vector<uint32_t> pulses;  // IR on (receiver's output LOW)
+  std::vector<uint32_t> spaces;  // IR off, between the pulses
+  uint32_t gapAfter = 0;         // Space after the frame, if the next one is a repetition (0 otherwise)
+  std::string code;              // Bits (or, for Manchester, the halves of each pulse and space) of a data frame
+};
+
+
+struct FrameCollector {
+  uint32_t frameGap;
+  std::vector<Frame> frames;
+  uint64_t lastEdge = 0;
+  bool inFrame = false;
+
+  void operator()(uint64_t timeUs, uint8_t level) {
+    uint64_t elapsed = timeUs - lastEdge;
+    uint32_t duration = elapsed > UINT32_MAX ? UINT32_MAX : (uint32_t)elapsed;
+    lastEdge = timeUs;
+    if (level == 0) {  // Falling edge: a pulse begins, after a space
+      if (!inFrame || duration > frameGap) {
+        if (inFrame && duration < c_pressGap) frames.back().gapAfter = duration;
+        frames.push_back(Frame());
+        frames.back().start = timeUs;
+        inFrame = true;
+      } else frames.back().spaces.push_back(duration);
+    } else if (inFrame) frames.back().pulses.push_back(duration);  // Rising edge: the pulse ended
+  }
+};
+
+
+struct Cluster {
+  uint32_t nominal;  // Median
+  uint32_t min, max;
+  size_t count;
+};
+
+
+static uint32_t median(std::vector<uint32_t> values) {
+  if (values.empty()) return 0;
+  std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+  return values[values.size() / 2];
+}
+
+
+static std::vector<Cluster> findClusters(const std::vector<uint32_t> &values) {
+  std::map<int, std::vector<uint32_t>> bins;  // Logarithmic histogram
+  for (uint32_t value : values) bins[(int)floor(log((double)value + 1) / log(c_binRatio))].push_back(value);
+  std::vector<Cluster> clusters;
+  std::vector<uint32_t> peak;
+  int lastBin = 0;
+  size_t noise = std::max<size_t>(2, values.size() / 50);  // Peaks with less than 2% of the values are ignored
+  for (auto bin = bins.begin();; ++bin) {
+    if (bin == bins.end() || (!peak.empty() && bin->first > lastBin + 1)) {  // End of a run of non-empty bins
+      if (peak.size() >= noise) {
+        Cluster cluster = {median(peak), *std::min_element(peak.begin(), peak.end()),
+                           *std::max_element(peak.begin(), peak.end()), peak.size()};
+        clusters.push_back(cluster);
+      }
+      peak.clear();
+      if (bin == bins.end()) break;
+    }
+    peak.insert(peak.end(), bin->second.begin(), bin->second.end());
+    lastBin = bin->first;
+  }
+  return clusters;
+}
+
+
+static size_t nearest(const std::vector<Cluster> &clusters, uint32_t value) {
+  size_t best = 0;
+  for (size_t i = 1; i < clusters.size(); i++) {
+    if (fabs(log((double)value / clusters[i].nominal)) < fabs(log((double)value / clusters[best].nominal))) best = i;
+  }
+  return best;
+}
+
+
+static void printClusters(const char *what, const std::vector<Cluster> &clusters) {
+  fprintf(stderr, "%s:", what);
+  for (const Cluster &c : clusters) fprintf(stderr, "  %lu µs (%lu..%lu, %lu)", (unsigned long)c.nominal,
+                                            (unsigned long)c.min, (unsigned long)c.max, (unsigned long)c.count);
+  fputc('\n', stderr);
+}
+
+
+static uint32_t mostFrequent(const std::vector<uint32_t> &values) {
+  std::map<uint32_t, size_t> counts;
+  for (uint32_t value : values) counts[value]++;
+  uint32_t best = 0;
+  size_t bestCount = 0;
+  for (auto &count : counts) if (count.second > bestCount) { best = count.first; bestCount = count.second; }
+  return best;
+}
+
+
+static double ratio(const Cluster &a, const Cluster &b) { return (double)a.nominal / b.nominal; }
+
+
+// ****************************************************************************
+// Header output
+// ****************************************************************************
+
+struct Header {
+  std::string name;
+
+  std::string def(const char *suffix) const { return name + "_" + suffix; }
+
+  void define(const char *suffix, uint32_t value, const char *comment) const {
+    printf("#define %-16s %6lu  /* %s */\n", def(suffix).c_str(), (unsigned long)value, comment);
+  }
+
+  // No ISR is written: its FSM has to be adapted from a decoder of the same kind of signal, by hand
+  void thresholdsBegin(const char *mode, const char *similar) const {
+    printf("\n\n// %s thresholds in microseconds (the decoders declare them at the beginning of their irISR()).\n", name.c_str());
+    printf("// The ISR is triggered %s; its FSM can be adapted from %s.\n", mode, similar);
+  }
+
+  // A threshold constant: the expression uses the defines (#NAME is replaced by the name), the value is the computed one
+  void threshold(const char *constant, std::string expression, double value) const {
+    size_t at;
+    while ((at = expression.find("#NAME")) != std::string::npos) expression.replace(at, 5, name);
+    if (value < 0) fprintf(stderr, "Warning: %s is negative, the clusters are too close\n", constant);
+    printf("const %s %-11s = %-52s  // %6ld\n", value > 65535 ? "uint32_t" : "uint16_t", constant,
+           (expression + ";").c_str(), (long)value);
+  }
+};
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false;
+  Header header;
+  header.name = "REMOTE";
+  FrameCollector collector;
+  collector.frameGap = 5000;
+  int opt;
+  while ((opt = getopt(argc, argv, "f:c:r:in:g:h")) != -1) {
+    switch (opt) {
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return 2;
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      case 'n': header.name = optarg; break;
+      case 'g': collector.frameGap = (uint32_t)atol(optarg); break;
+      default:
+        fprintf(stderr, "Usage: %s [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [-n name] [-g gap] "
+                        "[capture file]\n", argv[0]);
+        return 2;
+    }
+  }
+  if (argc - optind > 1) return 2;
+
+  FILE *file = stdin;
+  const char *fileName = "stdin";
+  if (optind < argc) {
+    fileName = argv[optind];
+    file = fopen(fileName, "rb");
+    if (!file) {
+      perror(fileName);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(fileName);
+  }
+  IRsmallDCaptureReader<FrameCollector> reader(options, collector);
+  bool ok = reader.read(file);
+  if (file != stdin) fclose(file);
+  if (!ok) return 1;
+
+  // Data frames and repeat codes:
+  std::vector<Frame> &frames = collector.frames;
+  size_t maxPulses = 0;
+  for (const Frame &f : frames) maxPulses = std::max(maxPulses, f.pulses.size());
+  std::vector<bool> isData(frames.size());
+  size_t dataCount = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    isData[i] = frames[i].pulses.size() >= std::max<size_t>(4, maxPulses / 2);
+    dataCount += isData[i];
+  }
+  fprintf(stderr, "%lu frames (%lu data frames)\n", (unsigned long)frames.size(), (unsigned long)dataCount);
+  if (dataCount < 3) {
+    fprintf(stderr, "Not enough frames: capture several key presses\n");
+    return 1;
+  }
+
+  // Leading pulse and space:
+  std::vector<uint32_t> firstPulses, restPulses, firstSpaces, restSpaces;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!isData[i]) continue;
+    firstPulses.push_back(frames[i].pulses[0]);
+    restPulses.insert(restPulses.end(), frames[i].pulses.begin() + 1, frames[i].pulses.end());
+  }
+  std::vector<Cluster> restPulseClusters = findClusters(restPulses);
+  bool leadingPulse = !restPulseClusters.empty() && median(firstPulses) > c_leadRatio * restPulseClusters.back().nominal;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!isData[i] || frames[i].spaces.empty()) continue;
+    firstSpaces.push_back(frames[i].spaces[0]);
+    restSpaces.insert(restSpaces.end(), frames[i].spaces.begin() + 1, frames[i].spaces.end());
+  }
+  std::vector<Cluster> restSpaceClusters = findClusters(restSpaces);
+  bool leadingSpace = leadingPulse && !restSpaceClusters.empty() &&
+                      median(firstSpaces) > c_leadRatio * restSpaceClusters.back().nominal;
+  uint32_t leadPulse = median(firstPulses), leadSpace = median(firstSpaces);
+
+  // Data pulses and spaces:
+  std::vector<uint32_t> dataPulses, dataSpaces;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!isData[i]) continue;
+    dataPulses.insert(dataPulses.end(), frames[i].pulses.begin() + leadingPulse, frames[i].pulses.end());
+    if (frames[i].spaces.size() > leadingSpace) {
+      dataSpaces.insert(dataSpaces.end(), frames[i].spaces.begin() + leadingSpace, frames[i].spaces.end());
+    }
+  }
+  std::vector<Cluster> pulses = findClusters(dataPulses), spaces = findClusters(dataSpaces);
+  if (leadingPulse) fprintf(stderr, "Leading pulse: %lu µs\n", (unsigned long)leadPulse);
+  if (leadingSpace) fprintf(stderr, "Leading space: %lu µs\n", (unsigned long)leadSpace);
+  printClusters("Data pulses", pulses);
+  printClusters("Data spaces", spaces);
+
+  Encoding encoding = ENC_UNKNOWN;
+  if (pulses.size() == 1 && spaces.size() == 2) encoding = ENC_PULSE_DISTANCE;
+  else if (pulses.size() == 2 && spaces.size() == 1) encoding = ENC_PULSE_WIDTH;
+  else if (pulses.size() == 2 && spaces.size() == 2 && ratio(pulses[1], pulses[0]) > 1.6 && ratio(pulses[1], pulses[0]) < 2.4
+           && ratio(spaces[1], spaces[0]) > 1.6 && ratio(spaces[1], spaces[0]) < 2.4
+           && ratio(pulses[0], spaces[0]) > 0.67 && ratio(pulses[0], spaces[0]) < 1.5) encoding = ENC_MANCHESTER;
+  if (encoding == ENC_UNKNOWN) {
+    fprintf(stderr, "Unknown encoding (capture more keys, or a cleaner signal)\n");
+    return 1;
+  }
+
+  // Bits and codes (LSB first, as sent by NEC and SIRC remotes):
+  std::vector<uint32_t> bitCounts;
+  std::map<std::string, size_t> codes;
+  uint32_t halfBit = 0;
+  if (encoding == ENC_MANCHESTER) {
+    halfBit = (pulses[0].nominal + spaces[0].nominal + (pulses[1].nominal + spaces[1].nominal) / 2) / 4;
+  }
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (!isData[i]) continue;
+    Frame &f = frames[i];
+    if (encoding == ENC_MANCHESTER) {  // The first half of the first bit, or the last half of the last one, may be a space
+      uint32_t halves = 0;
+      for (size_t k = 0; k < f.pulses.size(); k++) {
+        uint32_t pulse = (f.pulses[k] + halfBit / 2) / halfBit, space = 0;
+        if (k < f.spaces.size()) space = (f.spaces[k] + halfBit / 2) / halfBit;
+        halves += pulse + space;
+        f.code += (char)('0' + std::min<uint32_t>(pulse, 9));
+        f.code += (char)('0' + std::min<uint32_t>(space, 9));
+      }
+      bitCounts.push_back((halves + 1) / 2);
+      continue;
+    }
+    std::string &bits = f.code;
+    if (encoding == ENC_PULSE_DISTANCE) {
+      for (size_t k = leadingSpace; k < f.spaces.size(); k++) bits += nearest(spaces, f.spaces[k]) ? '1' : '0';
+    } else {
+      for (size_t k = leadingPulse; k < f.pulses.size(); k++) bits += nearest(pulses, f.pulses[k]) ? '1' : '0';
+    }
+    bitCounts.push_back(bits.size());
+    codes[bits]++;
+  }
+  uint32_t bitCount = encoding == ENC_MANCHESTER ? *std::max_element(bitCounts.begin(), bitCounts.end())
+                                                 : mostFrequent(bitCounts);
+  fprintf(stderr, "Encoding: %s, %lu bits\n", encoding == ENC_PULSE_DISTANCE ? "pulse distance" :
+          encoding == ENC_PULSE_WIDTH ? "pulse width" : "Manchester", (unsigned long)bitCount);
+  std::vector<std::pair<size_t, std::string>> byCount;
+  for (auto &code : codes) byCount.push_back(std::make_pair(code.second, code.first));
+  std::sort(byCount.rbegin(), byCount.rend());
+  if (byCount.size() > c_maxCodes) {
+    fprintf(stderr, "  (the %lu most frequent of %lu codes)\n", (unsigned long)c_maxCodes, (unsigned long)byCount.size());
+    byCount.resize(c_maxCodes);
+  }
+  for (auto &code : byCount) {
+    uint64_t value = 0;
+    const std::string &bits = code.second;
+    for (size_t k = bits.size(); k-- > 0;) value = (value << 1) | (bits[k] == '1');
+    fprintf(stderr, "  code 0x%0*llX (%lu bits, LSB first) x%lu\n", (int)(bits.size() + 3) / 4,
+            (unsigned long long)value, (unsigned long)bits.size(), (unsigned long)code.first);
+  }
+
+  // Key presses: a data frame with another code is another key, even if it comes less than c_pressGap after the
+  // previous frame (a repeat code, or the same code, is a repetition):
+  size_t presses = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (i + 1 < frames.size() && isData[i + 1] && frames[i + 1].code != frames[i].code) frames[i].gapAfter = 0;
+    if (i == 0 || !frames[i - 1].gapAfter) presses++;
+  }
+  fprintf(stderr, "%lu key presses\n", (unsigned long)presses);
+
+  // Repeat codes (the most common structure of the short frames):
+  std::vector<uint32_t> repeatSizes;
+  for (size_t i = 0; i < frames.size(); i++) if (!isData[i]) repeatSizes.push_back(frames[i].pulses.size());
+  uint32_t repeatSize = repeatSizes.empty() ? 0 : mostFrequent(repeatSizes);
+  std::vector<uint32_t> repeatPulses[2], repeatSpace;
+  for (size_t i = 0; i < frames.size(); i++) {
+    if (isData[i] || frames[i].pulses.size() != repeatSize || repeatSize != 2) continue;
+    repeatPulses[0].push_back(frames[i].pulses[0]);
+    repeatPulses[1].push_back(frames[i].pulses[1]);
+    repeatSpace.push_back(frames[i].spaces[0]);
+  }
+  bool repeatCode = !repeatSpace.empty();
+  if (repeatSize && !repeatCode) fprintf(stderr, "Warning: short frames with %lu pulses are not supported as repeat codes\n",
+                                         (unsigned long)repeatSize);
+
+  // Gaps, as intervals between rising edges (the gap and the next frame's first pulse), and repetition periods:
+  std::vector<uint32_t> gaps1, gaps2, spaceGaps, periods;
+  for (size_t i = 0; i + 1 < frames.size(); i++) {
+    if (!frames[i].gapAfter) continue;
+    uint32_t gap = frames[i].gapAfter + frames[i + 1].pulses[0];
+    if (isData[i]) gaps1.push_back(gap);
+    else if (!isData[i + 1]) gaps2.push_back(gap);
+    spaceGaps.push_back(frames[i].gapAfter);
+    if (isData[i] == isData[i + 1]) periods.push_back((uint32_t)(frames[i + 1].start - frames[i].start));
+  }
+  if (gaps1.empty()) fprintf(stderr, "Warning: no repetitions were captured (hold a key), the gap thresholds are missing\n");
+  uint32_t period = median(periods);
+
+  // ****** Header ******
+  const char *n = header.name.c_str();
+  printf("/* IRsmallD_%s - %s protocol timings\n", n, n);
+  printf(" *\n * This file is part of the IRsmallDecoder library for Arduino\n * Copyright (c) 2020 Luis Carvalho\n *\n *\n");
+  printf(" * Inferred by irinfer (extras/HostTools) from %s: %lu frames, %lu key presses.\n", fileName,
+         (unsigned long)frames.size(), (unsigned long)presses);
+  printf(" *\n * Protocol specifications (as measured):\n * ------------------------\n");
+  if (encoding == ENC_MANCHESTER) {
+    printf(" * Modulation type: Manchester code (bi-phase).\n");
+    printf(" * Bit period: %luµs; the pulses and spaces are %luµs or %luµs long.\n", (unsigned long)(2 * halfBit),
+           (unsigned long)halfBit, (unsigned long)(2 * halfBit));
+    printf(" * %lu bit signal.\n", (unsigned long)bitCount);
+  } else {
+    printf(" * Modulation type: %s.\n", encoding == ENC_PULSE_DISTANCE ? "pulse distance" : "pulse width");
+    if (leadingPulse) printf(" * The signal starts with a %luµs leading pulse, followed by a %luµs space.\n",
+                             (unsigned long)leadPulse, (unsigned long)(leadingSpace ? leadSpace : spaces[0].nominal));
+    const Cluster &p0 = pulses[0], &p1 = pulses.back(), &s0 = spaces[0], &s1 = spaces.back();
+    if (encoding == ENC_PULSE_DISTANCE) {
+      printf(" *   Logical '0' - a %luµs pulse followed by a %luµs space (total: %luµs).\n", (unsigned long)p0.nominal,
+             (unsigned long)s0.nominal, (unsigned long)(p0.nominal + s0.nominal));
+      printf(" *   Logical '1' - a %luµs pulse followed by a %luµs space (total: %luµs).\n", (unsigned long)p0.nominal,
+             (unsigned long)s1.nominal, (unsigned long)(p0.nominal + s1.nominal));
+      printf(" * %lu bits, followed by an extra %luµs pulse.\n", (unsigned long)bitCount, (unsigned long)p0.nominal);
+    } else {
+      printf(" *   Logical '0' - a %luµs space followed by a %luµs pulse (total: %luµs).\n", (unsigned long)s0.nominal,
+             (unsigned long)p0.nominal, (unsigned long)(s0.nominal + p0.nominal));
+      printf(" *   Logical '1' - a %luµs space followed by a %luµs pulse (total: %luµs).\n", (unsigned long)s0.nominal,
+             (unsigned long)p1.nominal, (unsigned long)(s0.nominal + p1.nominal));
+      printf(" * %lu bits.\n", (unsigned long)bitCount);
+    }
+  }
+  printf(" *\n * Repetitions:\n");
+  if (repeatCode) {
+    printf(" *   If a key is held, a repeat code is sent every %luµs.\n", (unsigned long)median(gaps2.empty() ? periods : gaps2));
+    printf(" *   It consists of a %luµs pulse, followed by a %luµs space, and then a %luµs pulse.\n",
+           (unsigned long)median(repeatPulses[0]), (unsigned long)median(repeatSpace), (unsigned long)median(repeatPulses[1]));
+  } else if (period) {
+    printf(" *   If a key is held, the frame is repeated every %luµs.\n", (unsigned long)period);
+  } else {
+    printf(" *   None captured.\n");
+  }
+  printf(" */\n\n\n");
+
+  const double jitter = 0;  // IR_SMALLD_JITTER's default value, for the comments
+  if (encoding == ENC_MANCHESTER) {
+    printf("// %s timings in microseconds (between all the edges):\n", n);
+    header.define("BIT_PERIOD", 2 * halfBit, "Bit period (two halves)");
+    header.define("BITS", bitCount, "Number of bits");
+    if (!spaceGaps.empty()) {
+      header.define("GAP", *std::min_element(spaceGaps.begin(), spaceGaps.end()), "Shortest gap between two frames");
+      header.define("RPT_PERIOD", *std::max_element(periods.begin(), periods.end()), "Longest repetition period");
+    }
+    header.thresholdsBegin("on every edge (CHANGE)", "IRsmallD_RC5.h");
+    if (!spaceGaps.empty()) {
+      header.threshold("c_rptPmax", "#NAME_RPT_PERIOD * 1.2 + IR_SMALLD_JITTER",
+                       *std::max_element(periods.begin(), periods.end()) * 1.2 + jitter);
+      header.threshold("c_gapMin", "#NAME_GAP * 0.8 - IR_SMALLD_JITTER",
+                       *std::min_element(spaceGaps.begin(), spaceGaps.end()) * 0.8 - jitter);
+    }
+    double bitPeriod = 2 * halfBit, tolerance = (uint32_t)bitPeriod / 4;
+    header.threshold("c_bitPeriod", "#NAME_BIT_PERIOD", bitPeriod);
+    header.threshold("c_tolerance", "#NAME_BIT_PERIOD / 4", tolerance);
+    header.threshold("c_longMax", "c_bitPeriod + c_tolerance + IR_SMALLD_JITTER", bitPeriod + tolerance + jitter);
+    header.threshold("c_shortMax", "c_bitPeriod / 2 + c_tolerance", (uint32_t)bitPeriod / 2 + tolerance);
+    header.threshold("c_shortMin", "c_bitPeriod / 2 - c_tolerance - IR_SMALLD_JITTER", (uint32_t)bitPeriod / 2 - tolerance - jitter);
+    return 0;
+  }
+
+  uint32_t mark0 = encoding == ENC_PULSE_DISTANCE ? pulses[0].nominal + spaces[0].nominal : spaces[0].nominal + pulses[0].nominal;
+  uint32_t mark1 = encoding == ENC_PULSE_DISTANCE ? pulses[0].nominal + spaces[1].nominal : spaces[0].nominal + pulses[1].nominal;
+  uint32_t leadMark = leadingSpace ? leadSpace + pulses[0].nominal : 0;  // Leading space + first bit's pulse
+  uint32_t repeatMark = repeatCode ? median(repeatSpace) + median(repeatPulses[1]) : 0;
+  printf("// %s timings in microseconds (between the ends of the IR pulses, i.e. the rising edges):\n", n);
+  if (leadMark) header.define("L_MARK", leadMark, "Leading Mark (leading space + first pulse)");
+  if (repeatMark) header.define("R_MARK", repeatMark, "Repeat Mark");
+  header.define("MARK_0", mark0, "Bit 0 Mark");
+  header.define("MARK_1", mark1, "Bit 1 Mark");
+  printf("#define %-16s ((%s_MARK_1 - %s_MARK_0) / 2)  /* = %lu */\n", header.def("BIT_TOLERANCE").c_str(), n, n,
+         (unsigned long)((mark1 - mark0) / 2));
+  header.define("BITS", bitCount, "Number of bits");
+  uint32_t gap1 = 0, gap2 = 0, gapMax = 0;
+  if (repeatCode) {  // Gap1 (before the first repeat mark) and Gap2 (between repeat marks), including the leading pulse
+    gap1 = gaps1.empty() ? 0 : *std::min_element(gaps1.begin(), gaps1.end());
+    gap2 = gaps2.empty() ? gap1 : *std::max_element(gaps2.begin(), gaps2.end());
+    if (gap1) header.define("GAP_1", gap1, "Gap1 (before the first repeat mark, with its leading pulse)");
+    if (gap2) header.define("GAP_2", gap2, "Gap2 (between repeat marks, with their leading pulse)");
+  } else if (!gaps1.empty()) {  // The whole frame is repeated
+    gap1 = *std::min_element(gaps1.begin(), gaps1.end());
+    gapMax = *std::max_element(gaps1.begin(), gaps1.end());
+    header.define("GAP_MIN", gap1, "Shortest gap between frames, with the leading pulse");
+    header.define("GAP_MAX", gapMax, "Longest gap between frames, with the leading pulse");
+  }
+
+  double tolerance = (mark1 - mark0) / 2;
+  header.thresholdsBegin("on each rising edge (RISING)",
+                         encoding == ENC_PULSE_DISTANCE ? "IRsmallD_NEC.h" : "IRsmallD_SIRC_multi.h");
+  if (repeatCode) {
+    if (gap1) header.threshold("c_GapMin", "#NAME_GAP_1 * 0.7 - IR_SMALLD_JITTER", gap1 * 0.7 - jitter);
+    if (gap2) header.threshold("c_GapMax", "#NAME_GAP_2 * 1.3 + IR_SMALLD_JITTER", gap2 * 1.3 + jitter);
+    header.threshold("c_RMmin", "#NAME_R_MARK * 0.7 - IR_SMALLD_JITTER", repeatMark * 0.7 - jitter);
+    if (leadMark > repeatMark) {  // Both are expected in the same state: the limit between them is halfway
+      header.threshold("c_RMmax", "(#NAME_R_MARK + #NAME_L_MARK) / 2", (uint32_t)((repeatMark + leadMark) / 2));
+    } else {
+      header.threshold("c_RMmax", "#NAME_R_MARK * 1.3 + IR_SMALLD_JITTER", repeatMark * 1.3 + jitter);
+    }
+  } else if (gap1) {
+    header.threshold("c_GapMax", "#NAME_GAP_MAX * 1.2 + IR_SMALLD_JITTER", gapMax * 1.2 + jitter);
+    header.threshold("c_GapMin", "#NAME_GAP_MIN * 0.8 - IR_SMALLD_JITTER", gap1 * 0.8 - jitter);
+  }
+  if (leadMark) {
+    if (repeatCode && leadMark > repeatMark) header.threshold("c_LMmin", "c_RMmax + 1", (uint32_t)((repeatMark + leadMark) / 2) + 1);
+    else header.threshold("c_LMmin", "#NAME_L_MARK * 0.7 - IR_SMALLD_JITTER", leadMark * 0.7 - jitter);
+    header.threshold("c_LMmax", "#NAME_L_MARK * 1.3 + IR_SMALLD_JITTER", leadMark * 1.3 + jitter);
+  }
+  header.threshold("c_M1max", "#NAME_MARK_1 + #NAME_BIT_TOLERANCE + IR_SMALLD_JITTER", mark1 + tolerance + jitter);
+  header.threshold("c_M1min", "#NAME_MARK_1 - #NAME_BIT_TOLERANCE", mark1 - tolerance);
+  header.threshold("c_M0min", "#NAME_MARK_0 - #NAME_BIT_TOLERANCE - IR_SMALLD_JITTER", mark0 - tolerance - jitter);
+  return 0;
+}
@@ -0,0 +1,94 @@
+/* irkeymap - Compile test for the largest keymaps (254 keys), with a check of their dispatch
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (building it is the test: it fails if a keymap has no perfect hash, or if its search exceeds the compiler's
+ * constexpr limits):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NECx -I. -I../../src irkeymap.cpp -o irkeymap
+ *
+ * Usage:
+ *   irkeymap
+ *   Dispatches every key of each keymap, and every other command of their addresses (which must not call any
+ *   handler), and prints the bytes used by each keymap's hash tables. The exit status is 1 if any key called
+ *   the wrong handler (or none).
+ *
+ * The keymaps have the maximum number of keys, with the commands of one remote, of three remotes, and with
+ * scattered addresses and commands.
+ */
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+#include <IRsmallDKeymap.h>
+#include <stdio.h>
+
+
+static int g_handler = -1;  // The last handler called
+void onKey0(const irSmallD_t &) { g_handler = 0; }
+void onKey1(const irSmallD_t &) { g_handler = 1; }
+void onKey2(const irSmallD_t &) { g_handler = 2; }
+void onKey3(const irSmallD_t &) { g_handler = 3; }
+constexpr irSmallD_handler_t c_handlers[] = {onKey0, onKey1, onKey2, onKey3};  // Key i calls c_handlers[i & 3]
+
+const uint16_t c_keys = 254;
+
+// Address and command of key i, in each keymap:
+constexpr uint16_t oneAddr(uint16_t) { return 0x00FF; }
+constexpr uint8_t oneCmd(uint16_t i) { return i; }
+constexpr uint16_t threeAddr(uint16_t i) { return i < 85 ? 0x10EF : (i < 170 ? 0x20DF : 0x807F); }
+constexpr uint8_t threeCmd(uint16_t i) { return i % 85; }
+constexpr uint16_t scatteredAddr(uint16_t i) { return (i * 167 + 3) & 0xFF; }  // All different
+constexpr uint8_t scatteredCmd(uint16_t i) { return i * 91 + 11; }
+
+#define IRK_4(K, i)   K(i), K((i) + 1), K((i) + 2), K((i) + 3)
+#define IRK_16(K, i)  IRK_4(K, i), IRK_4(K, (i) + 4), IRK_4(K, (i) + 8), IRK_4(K, (i) + 12)
+#define IRK_64(K, i)  IRK_16(K, i), IRK_16(K, (i) + 16), IRK_16(K, (i) + 32), IRK_16(K, (i) + 48)
+#define IRK_254(K)    IRK_64(K, 0), IRK_64(K, 64), IRK_64(K, 128), IRK_16(K, 192), IRK_16(K, 208), IRK_16(K, 224), \
+                      IRK_4(K, 240), IRK_4(K, 244), IRK_4(K, 248), K(252), K(253)
+
+#define ONE_KEY(i)        {oneAddr(i), oneCmd(i), IR_KEY_PRESS, c_handlers[(i) & 3]}
+#define THREE_KEY(i)      {threeAddr(i), threeCmd(i), IR_KEY_PRESS, c_handlers[(i) & 3]}
+#define SCATTERED_KEY(i)  {scatteredAddr(i), scatteredCmd(i), IR_KEY_PRESS, c_handlers[(i) & 3]}
+
+IR_SMALLD_KEYMAP(oneRemote, IRK_254(ONE_KEY));
+IR_SMALLD_KEYMAP(threeRemotes, IRK_254(THREE_KEY));
+IR_SMALLD_KEYMAP(scattered, IRK_254(SCATTERED_KEY));
+
+
+// Dispatches all the commands of the keymap's addresses, and returns the number of errors:
+template <class T> static int check(const char *name, IRsmallDKeymap<T> &keymap, uint16_t (*addrOf)(uint16_t),
+                                    uint8_t (*cmdOf)(uint16_t)) {
+  int errors = 0;
+  irSmallD_t irData = {};
+  for (uint16_t i = 0; i < c_keys; i++) {
+    irData.addr = addrOf(i);
+    for (uint16_t cmd = 0; cmd < 256; cmd++) {
+      int expected = -1;
+      for (uint16_t j = 0; j < c_keys; j++)
+        if (addrOf(j) == irData.addr && cmdOf(j) == cmd) expected = j & 3;
+      irData.cmd = cmd;
+      g_handler = -1;
+      bool called = keymap.dispatch(irData);
+      if (g_handler != expected || called != (expected >= 0)) {
+        if (errors++ < 10) printf("%s: addr=0x%04X cmd=0x%02X called handler %d instead of %d\n", name, irData.addr, cmd, g_handler, expected);
+      }
+    }
+  }
+  size_t bytes = sizeof(IRsmallDKeymapDetail::Params<T>::params) + sizeof(IRsmallDKeymapDetail::Offsets<T>::offsets)
+               + sizeof(IRsmallDKeymapDetail::Slots<T>::slots);
+  printf("%s: %u keys, %u buckets, %zu bytes of hash tables (+%zu of keymap table): %s\n", name, c_keys,
+         IRsmallDKeymapDetail::Buckets<T>::count, bytes, sizeof(T::keys), errors ? "FAILED" : "ok");
+  return errors;
+}
+
+
+int main() {
+  int errors = check("one remote", oneRemote, oneAddr, oneCmd);
+  errors += check("three remotes", threeRemotes, threeAddr, threeCmd);
+  errors += check("scattered", scattered, scatteredAddr, scatteredCmd);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/* irlive - Live decoder for Linux boards, fed by GPIO line events with kernel timestamps
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (one binary per protocol, selected just like in a sketch):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -I. -I../../src irlive.cpp -o irlive_nec
+ *
+ * Usage:
+ *   irlive_nec [-v 1|2] [-l line] [-i] [-q] [source]
+ *     -v  event format: 1 (struct gpioevent_data) or 2 (struct gpio_v2_line_event, the default)
+ *     -l  line offset, when the source is a GPIO chip (e.g. /dev/gpiochip0 -l 17)
+ *     -i  invert the signal levels
+ *     -q  quiet: only print the decoded frames
+ *   The source is a GPIO chip, a FIFO or a file with events, "fd:N" for an inherited file descriptor
+ *   (e.g. one end of a socketpair), or the standard input if none is given.
+ *
+ *   irlive_nec -w [-v 1|2] [-i] capture
+ *     Converts a capture (any format read by irdecode, guessed from the file's extension) into events, written to
+ *     the standard output, for testing without hardware:  irlive_nec -w capture.vcd | irlive_nec
+ *
+ * The output is the same as irdecode's, with the times (in seconds) counted from 1s before the first event.
+ */
+
+#include "IRsmallDHostPrinter.h"
+#include "IRsmallDGpioEvents.h"
+#include "IRsmallDCapture.h"
+#include <fcntl.h>
+#include <stdlib.h>
+
+
+struct LiveInput {
+  IRsmallDHostDecoder<IRsmallDHostPrinter> &decoder;
+  uint64_t startUs;
+  bool started;
+
+  void onEdge(uint64_t timeUs, uint8_t level) {
+    if (!started) {  // The line was idle before the first event (so the first frame's leading gap is there)
+      startUs = timeUs - 1000000;
+      started = true;
+    }
+    decoder.edge(timeUs - startUs, level);
+    fflush(stdout);
+  }
+
+  int idleTimeout() {  // Lets the decoder time out if the signal stops in the middle of a frame
+    #if not defined(IR_SMALLD_NO_TIMEOUT)
+      if (decoder.state()) return IR_SMALLD_TIMEOUT / 1000 + 1;
+    #endif
+    return -1;
+  }
+
+  void onIdle() {
+    decoder.finish();
+    fflush(stdout);
+  }
+};
+
+
+// Writes each level change of a capture as a GPIO event:
+struct EventWriter {
+  irGpioEventFormat_t format;
+  uint32_t seqno;
+
+  void operator()(uint64_t timeUs, uint8_t level) {
+    uint32_t id = level ? GPIOEVENT_EVENT_RISING_EDGE : GPIOEVENT_EVENT_FALLING_EDGE;
+    if (format == IR_GPIO_EVENTS_V1) {
+      struct gpioevent_data event;
+      memset(&event, 0, sizeof(event));
+      event.timestamp = timeUs * 1000;
+      event.id = id;
+      fwrite(&event, sizeof(event), 1, stdout);
+    } else {
+      struct gpio_v2_line_event event;
+      memset(&event, 0, sizeof(event));
+      event.timestamp_ns = timeUs * 1000;
+      event.id = id;
+      event.seqno = event.line_seqno = ++seqno;
+      fwrite(&event, sizeof(event), 1, stdout);
+    }
+  }
+};
+
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-v 1|2] [-l line] [-i] [-q] [source]\n"
+                  "       %s -w [-v 1|2] [-i] capture\n", name, name);
+  return 2;
+}
+
+
+static int writeEvents(const char *fileName, irGpioEventFormat_t format, bool invert) {
+  FILE *file = fopen(fileName, "rb");
+  if (!file) {
+    perror(fileName);
+    return 1;
+  }
+  irCaptureOptions_t options;
+  options.format = irCaptureFormatFromName(fileName);
+  options.invert = invert;
+  EventWriter writer = {format, 0};
+  IRsmallDCaptureReader<EventWriter> reader(options, writer);
+  bool ok = reader.read(file);
+  fclose(file);
+  return ok ? 0 : 1;
+}
+
+
+int main(int argc, char *argv[]) {
+  irGpioEventFormat_t format = IR_GPIO_EVENTS_V2;
+  long line = -1;
+  bool invert = false, write = false;
+  IRsmallDHostPrinter printer;
+  int opt;
+  while ((opt = getopt(argc, argv, "v:l:iqwh")) != -1) {
+    switch (opt) {
+      case 'v':
+        if (!strcmp(optarg, "1")) format = IR_GPIO_EVENTS_V1;
+        else if (!strcmp(optarg, "2")) format = IR_GPIO_EVENTS_V2;
+        else return usage(argv[0]);
+      break;
+      case 'l': line = atol(optarg); break;
+      case 'i': invert = true; break;
+      case 'q': printer.quiet = true; break;
+      case 'w': write = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1) return usage(argv[0]);
+  if (write) return optind < argc ? writeEvents(argv[optind], format, invert) : usage(argv[0]);
+
+  int fd = STDIN_FILENO;
+  if (optind < argc) {
+    const char *source = argv[optind];
+    if (!strncmp(source, "fd:", 3)) fd = atoi(source + 3);
+    else if ((fd = open(source, O_RDONLY | O_CLOEXEC)) < 0) {
+      perror(source);
+      return 1;
+    }
+    if (line >= 0) {  // It's a GPIO chip: request the line's events
+      int eventsFd = irGpioRequestEvents(fd, (unsigned)line, format, "irlive");
+      if (eventsFd < 0) {
+        perror("GPIO line request");
+        return 1;
+      }
+      close(fd);
+      fd = eventsFd;
+    }
+  }
+
+  IRsmallDHostDecoder<IRsmallDHostPrinter> decoder(printer);
+  LiveInput input = {decoder, 0, false};
+  IRsmallDGpioEventReader<LiveInput> reader(fd, format, invert, input);
+  bool ok = reader.run();
+  decoder.finish();
+  fflush(stdout);
+
+  fprintf(stderr, IR_HOST_PROTOCOL ": %llu events (%llu wakeups, %llu dropped), %llu frames, %llu ignored repeats, "
+          "%llu rejects, %llu timeouts\n", (unsigned long long)reader.events(), (unsigned long long)reader.wakeups(),
+          (unsigned long long)reader.dropped(), (unsigned long long)printer.frames,
+          (unsigned long long)printer.ignoredRepeats, (unsigned long long)printer.rejects,
+          (unsigned long long)printer.timeouts);
+  return ok ? 0 : 1;
+}
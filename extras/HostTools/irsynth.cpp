@@ -0,0 +1,272 @@
+/* irsynth - Generates synthetic captures (clean frames, noise, interference and held keys) for the host tools
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (it doesn't use the library, so there's only one binary):
+ *   g++ -O2 -std=c++11 irsynth.cpp -o irsynth
+ *
+ * Usage:
+ *   irsynth [-p protocol] [-k kind] [-n count] [-r spikes] [-s seed]
+ *     -p  nec, samsung, samsung32, sirc12, sirc15 or sirc20 (default: nec)
+ *     -k  kind of capture (default: clean):
+ *           clean   frames with random codes, pulse stretching (0 to 120µs, as the receivers do) and jitter
+ *                   (20µs standard deviation), 30 to 230ms apart (at least one repetition period);
+ *           random  bursts of 40 random pulses and spaces (exponential, 600µs and 1500µs mean), without frames;
+ *           period  interference with the protocol's timing: the leading pulse (±10%) and the marks of a random
+ *                   code, each one split at random (5% to 95%) into a pulse and a space, so that the marks seen by
+ *                   the decoder's interrupt edge have the right lengths (as with a single edge per mark);
+ *           hold    key presses (address 0x10, 0x01 for SIRC), each one held for 12 repetitions at the protocol's
+ *                   repetition period (NEC sends repeat codes, SIRC two more frames), 0.5s apart, with jitter;
+ *     -n  number of frames, bursts or key presses (default: 2000, or 20 key presses)
+ *     -r  noise spikes per second (30 to 250µs of IR light at random times), added to any kind (default: 0)
+ *     -s  random seed (default: 1); the same seed always gives the same capture, on any computer
+ *   The capture is written to the standard output, in the list format with levels (see README.md), starting 200ms
+ *   after time 0.
+ *
+ * Examples (the corpus used for the figures of IR_SMALLD_HOLD_GATE and IR_SMALLD_DUAL_EDGE, in the README):
+ *   ./irsynth -p sirc12 -k period | ./irdecode_sirc12 -q
+ *   ./irsynth -p nec -k hold -r 5 -s 3 > hold_nec_3.txt
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+
+enum irSynthKind_t : uint8_t { SYNTH_CLEAN, SYNTH_RANDOM, SYNTH_PERIOD, SYNTH_HOLD };
+
+struct Protocol {
+  const char *name;
+  double leadPulse, leadSpace;
+  double pulse0, pulse1, space0, space1;  // Bit pulses and spaces
+  uint8_t bits;
+  double period;       // Repetition period (µs)
+  bool stopPulse;      // The frame ends with a pulse after the last bit's space (otherwise, with the last bit's pulse)
+  bool risingEdge;     // The decoder's FSM runs on the rising edges (a mark is a space followed by a pulse)
+};
+
+static const Protocol c_protocols[] = {
+  {"nec",       9000, 4500,  562.5,  562.5, 562.5, 1687.5, 32, 108000, true,  true},
+  {"samsung",   4500, 4500,  562.5,  562.5, 562.5, 1687.5, 20,  60000, true,  false},
+  {"samsung32", 4500, 4500,  562.5,  562.5, 562.5, 1687.5, 32, 108000, true,  false},
+  {"sirc12",    2400,  600,  600,   1200,   600,    600,   12,  45000, false, true},
+  {"sirc15",    2400,  600,  600,   1200,   600,    600,   15,  45000, false, true},
+  {"sirc20",    2400,  600,  600,   1200,   600,    600,   20,  45000, false, true},
+};
+
+const uint8_t c_held = 12;            // Repetitions of each key press
+const double  c_minDuration = 20;     // Shortest pulse or space (µs)
+
+
+// xorshift64* generator, so that a seed gives the same capture with any compiler and C library:
+class Random {
+  public:
+    Random(uint64_t seed) : _s(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+    double uniform(double a, double b) { return a + (b - a) * ((next() >> 11) * (1.0 / 9007199254740992.0)); }
+    uint32_t bits(uint8_t n) { return (uint32_t)(next() >> (64 - n)); }
+    double exponential(double mean) { return -mean * log(1 - uniform(0, 1)); }
+    double gauss(double sigma) {  // Box-Muller
+      double u = uniform(1e-12, 1);
+      return sigma * sqrt(-2 * log(u)) * cos(2 * M_PI * uniform(0, 1));
+    }
+
+  private:
+    uint64_t _s;
+    uint64_t next() {
+      _s ^= _s >> 12;
+      _s ^= _s << 25;
+      _s ^= _s >> 27;
+      return _s * 2685821657736338717ULL;
+    }
+};
+
+
+class Synth {
+  public:
+    Synth(const Protocol &p, uint64_t seed) : _p(p), _r(seed) {}
+
+    // Pulses and spaces of a frame, alternated, starting and ending with a pulse (nominal durations):
+    std::vector<double> frame(uint32_t addr, uint32_t cmd) const {
+      std::vector<uint8_t> bits;
+      if (isNec()) addBytes(bits, {addr, addr ^ 0xFF, cmd, cmd ^ 0xFF});
+      else if (!strcmp(_p.name, "samsung32")) addBytes(bits, {addr, addr, cmd, cmd ^ 0xFF});
+      else if (!strcmp(_p.name, "samsung")) {
+        addBits(bits, addr, 12);
+        addBits(bits, cmd, 8);
+      } else {  // SIRC: 7 bit command, 5 or 8 bit address (and 8 bit extended data, for SIRC20, here always 0)
+        addBits(bits, cmd, 7);
+        addBits(bits, addr, _p.bits == 15 ? 8 : 5);
+        if (_p.bits == 20) addBits(bits, 0, 8);
+      }
+      std::vector<double> d = {_p.leadPulse, _p.leadSpace};
+      for (uint8_t b : bits) {
+        d.push_back(b ? _p.pulse1 : _p.pulse0);
+        d.push_back(b ? _p.space1 : _p.space0);
+      }
+      if (_p.stopPulse) d.push_back(_p.pulse0);
+      else d.pop_back();
+      return d;
+    }
+
+    std::vector<double> randomCode() {
+      uint8_t addrBits = isSirc() ? (_p.bits == 15 ? 8 : 5) : (_p.bits == 20 ? 12 : 8);
+      return frame(_r.bits(addrBits), _r.bits(isSirc() ? 7 : 8));
+    }
+
+    // Pulse stretching (the receiver's output stays low a bit longer than the IR light) and jitter:
+    void distort(std::vector<double> &d, double stretch) {
+      for (size_t i = 0; i < d.size(); i++) d[i] += (i % 2 ? -stretch : stretch) + _r.gauss(20);
+    }
+
+    // Keeps the marks seen by the decoder, but splits each one at random into a pulse and a space:
+    void resplit(std::vector<double> &d) {
+      std::vector<double> s = {d[0] * _r.uniform(0.9, 1.1)};
+      if (_p.risingEdge) {  // Marks from rising edge to rising edge: a space and the next pulse
+        for (size_t k = 1; k + 1 < d.size(); k += 2) {
+          double mark = d[k] + d[k + 1], f = _r.uniform(0.05, 0.95);
+          s.push_back(mark * (1 - f));
+          s.push_back(mark * f);
+        }
+      } else {              // Marks from falling edge to falling edge, after the leading mark
+        s.push_back(d[1]);
+        for (size_t k = 2; k + 1 < d.size(); k += 2) {
+          double mark = d[k] + d[k + 1], f = _r.uniform(0.05, 0.95);
+          s.push_back(mark * f);
+          s.push_back(mark * (1 - f));
+        }
+        s.push_back(_r.uniform(50, 1000));
+      }
+      d.swap(s);
+    }
+
+    std::vector<double> randomBurst() {
+      std::vector<double> d;
+      for (uint8_t i = 0; i < 40; i++) {
+        d.push_back(_r.exponential(600));
+        d.push_back(_r.exponential(1500));
+      }
+      d.pop_back();
+      return d;
+    }
+
+    void add(const std::vector<double> &d) {  // Adds a sequence of pulses and spaces, at the current time
+      for (size_t i = 0; i < d.size(); i++) {
+        double duration = std::max(c_minDuration, d[i]);
+        if (i % 2 == 0) _on.push_back({_t, _t + duration});
+        _t += duration;
+      }
+    }
+
+    void generate(irSynthKind_t kind, uint32_t count) {
+      for (uint32_t n = 0; n < count; n++) {
+        double start = _t;
+        if (kind == SYNTH_RANDOM) add(randomBurst());
+        else if (kind == SYNTH_HOLD) {
+          std::vector<double> d = frame(isSirc() ? 0x01 : 0x10, _r.bits(7));
+          uint8_t frames = 1 + c_held + (isSirc() ? 2 : 0);  // A Sony remote always sends 2 more frames
+          for (uint8_t i = 0; i < frames; i++) {
+            _t = start + i * _p.period;
+            std::vector<double> f = (i && isNec()) ? std::vector<double>{9000, 2250, 562.5} : d;  // Repeat code
+            distort(f, 0);
+            add(f);
+          }
+          _t = start + (frames - 1) * _p.period + 500000;
+          continue;
+        } else {
+          std::vector<double> d = randomCode();
+          if (kind == SYNTH_PERIOD) resplit(d);
+          else distort(d, _r.uniform(0, 120));
+          add(d);
+        }
+        _t = std::max(_t + 30000, start + _p.period) + _r.uniform(0, 200000);
+      }
+    }
+
+    void addSpikes(double perSecond) {
+      uint32_t count = (uint32_t)(perSecond * _t / 1e6);
+      for (uint32_t i = 0; i < count; i++) {
+        double start = _r.uniform(100000, _t);
+        _on.push_back({start, start + _r.uniform(30, 250)});
+      }
+    }
+
+    void print() {  // Merges the overlapping pulses and prints the edges (falling when the IR light starts)
+      std::sort(_on.begin(), _on.end());
+      std::vector<std::pair<double, double>> merged;
+      for (const auto &on : _on) {
+        if (!merged.empty() && on.first < merged.back().second + 1) merged.back().second = std::max(merged.back().second, on.second);
+        else merged.push_back(on);
+      }
+      for (const auto &on : merged) printf("%llu 0\n%llu 1\n", (unsigned long long)on.first, (unsigned long long)on.second);
+    }
+
+  private:
+    const Protocol &_p;
+    Random _r;
+    double _t = 200000;
+    std::vector<std::pair<double, double>> _on;  // Intervals with IR light (the receiver's output is low)
+
+    bool isNec() const { return !strcmp(_p.name, "nec"); }
+    bool isSirc() const { return !_p.stopPulse; }
+
+    static void addBits(std::vector<uint8_t> &bits, uint32_t value, uint8_t n) {  // LSB first
+      for (uint8_t i = 0; i < n; i++) bits.push_back((value >> i) & 1);
+    }
+    static void addBytes(std::vector<uint8_t> &bits, std::initializer_list<uint32_t> bytes) {
+      for (uint32_t b : bytes) addBits(bits, b, 8);
+    }
+};
+
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-p nec|samsung|samsung32|sirc12|sirc15|sirc20] [-k clean|random|period|hold] [-n count] "
+                  "[-r spikes] [-s seed]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  const Protocol *protocol = &c_protocols[0];
+  irSynthKind_t kind = SYNTH_CLEAN;
+  long count = -1;
+  double spikes = 0;
+  uint64_t seed = 1;
+  int opt;
+  while ((opt = getopt(argc, argv, "p:k:n:r:s:h")) != -1) {
+    switch (opt) {
+      case 'p':
+        protocol = NULL;
+        for (const Protocol &p : c_protocols) if (!strcmp(optarg, p.name)) protocol = &p;
+        if (!protocol) return usage(argv[0]);
+      break;
+      case 'k':
+        if (!strcmp(optarg, "clean")) kind = SYNTH_CLEAN;
+        else if (!strcmp(optarg, "random")) kind = SYNTH_RANDOM;
+        else if (!strcmp(optarg, "period")) kind = SYNTH_PERIOD;
+        else if (!strcmp(optarg, "hold")) kind = SYNTH_HOLD;
+        else return usage(argv[0]);
+      break;
+      case 'n': count = atol(optarg); break;
+      case 'r': spikes = atof(optarg); break;
+      case 's': seed = strtoull(optarg, NULL, 0); break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (optind < argc) return usage(argv[0]);
+  if (count < 0) count = (kind == SYNTH_HOLD) ? 20 : 2000;
+
+  static char outBuffer[1 << 16];
+  setvbuf(stdout, outBuffer, _IOFBF, sizeof(outBuffer));
+  Synth synth(*protocol, seed);
+  synth.generate(kind, (uint32_t)count);
+  synth.addSpikes(spikes);
+  synth.print();
+  return 0;
+}
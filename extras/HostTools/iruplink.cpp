@@ -0,0 +1,367 @@
+/* iruplink - Receives the decoded frames sent by IRsmallDUplink.h through a serial port, or sends a capture's
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Build (the protocol is only used by -s and -t; the receiver accepts the records of any protocol):
+ *   g++ -O2 -std=c++11 -DIR_SMALLD_NEC -I. -I../../src iruplink.cpp -o iruplink_nec -lutil
+ *
+ * Usage:
+ *   iruplink_nec [-b baud] [device]
+ *     Receives the packets from a serial device (or from the standard input) and prints one line per record:
+ *       12.345678 NEC addr=0x00 cmd=0x45 held=0
+ *     The summary (packets, records, bad and lost packets) is printed to the standard error at the end of the
+ *     input, or on Ctrl+C.
+ *
+ *   iruplink_nec -s [-d delay] [-o device] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [capture file]
+ *     Decodes a capture, as a board would, and sends the frames with IRsmallDUplink (with the given maximum delay,
+ *     in ms) to the standard output or to a serial device.
+ *
+ *   iruplink_nec -t [-d delay] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [capture file]
+ *     End-to-end test: a child process sends the capture's frames through a pseudo-terminal pair (in raw mode, as
+ *     a serial port would be set up), while this one parses them. The records are compared with the frames decoded
+ *     directly, and the exit status is 0 only if they are identical. The batch size is set at build time, so the
+ *     largest one is tested by a second build, with a long delay to fill the batches:
+ *       g++ -O2 -std=c++11 -DIR_SMALLD_NEC -DIR_SMALLD_UPLINK_BATCH=25 -I. -I../../src iruplink.cpp -o iruplink_nec25 -lutil
+ *       ./iruplink_nec25 -t -d 100000 capture.vcd
+ */
+
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
+#include "Arduino.h"
+#include <IRsmallDecoder.h>
+#include <IRsmallDUplink.h>
+#include "IRsmallDHostDecoder.h"
+#include "IRsmallDCapture.h"
+#include "IRsmallDUplinkParser.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <pty.h>
+#include <vector>
+
+
+// ****************************************************************************
+// Receiver
+
+struct RecordPrinter {
+  void onRecord(const irUplinkRecord_t &record) {
+    printf("%lu.%06lu %s ", (unsigned long)(record.time / 1000000), (unsigned long)(record.time % 1000000),
+           irUplinkProtocolName(record.protocol));
+    if (record.protocol == IR_SMALLD_ID_HASH) printf("hash=0x%08lX", (unsigned long)record.hash());
+    else {
+      if (record.protocol == IR_SMALLD_ID_SIRC20 || record.protocol == IR_SMALLD_ID_SIRC) printf("ext=0x%02X ", record.ext);
+      printf("addr=0x%02X cmd=0x%02X", record.addr, record.cmd);
+      if (record.hasKeyHeld()) printf(" held=%d", record.keyHeld());
+    }
+    putchar('\n');
+    fflush(stdout);
+  }
+};
+
+static volatile sig_atomic_t g_stop = 0;
+static void onSignal(int) { g_stop = 1; }
+
+static speed_t baudRate(long baud) {
+  static const struct { long baud; speed_t speed; } c_rates[] = {
+    {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200}, {230400, B230400},
+    {460800, B460800}, {921600, B921600}, {1000000, B1000000}, {2000000, B2000000}
+  };
+  for (size_t i = 0; i < sizeof(c_rates) / sizeof(c_rates[0]); i++) if (c_rates[i].baud == baud) return c_rates[i].speed;
+  return 0;
+}
+
+// Sets a terminal (a serial port or a pseudo-terminal) to raw mode, so that no byte is changed or swallowed:
+static bool setRaw(int fd, speed_t speed) {
+  struct termios t;
+  if (tcgetattr(fd, &t) < 0) return false;
+  cfmakeraw(&t);
+  t.c_cflag |= CLOCAL | CREAD;
+  t.c_cc[VMIN] = 1;
+  t.c_cc[VTIME] = 0;
+  if (speed) {
+    cfsetispeed(&t, speed);
+    cfsetospeed(&t, speed);
+  }
+  return tcsetattr(fd, TCSANOW, &t) == 0;
+}
+
+template <class Listener>
+static void receive(int fd, IRsmallDUplinkParser<Listener> &parser) {
+  uint8_t buffer[4096];
+  while (!g_stop) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n > 0) parser.feed(buffer, n);
+    else if (n == 0 || errno != EINTR) break;  // End of the input (EIO on a pseudo-terminal, when the other side is closed)
+  }
+}
+
+static void printStats(const IRsmallDUplinkParser<RecordPrinter>::Stats &stats) {
+  fprintf(stderr, "%llu bytes, %llu packets, %llu records, %llu bad packets, %llu lost packets\n",
+          (unsigned long long)stats.bytes, (unsigned long long)stats.packets, (unsigned long long)stats.records,
+          (unsigned long long)stats.badPackets, (unsigned long long)stats.lostPackets);
+}
+
+
+// ****************************************************************************
+// Sender
+
+struct FdPrint : public Print {
+  int fd;
+  uint64_t bytes = 0, writes = 0;
+  bool ok = true;
+  FdPrint(int fd) : fd(fd) {}
+  size_t write(uint8_t byte) override { return write(&byte, 1); }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    writes++;
+    size_t done = 0;
+    while (done < size) {
+      ssize_t n = ::write(fd, buffer + done, size - done);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) {
+        ok = false;
+        break;
+      }
+      done += n;
+    }
+    bytes += done;
+    return done;
+  }
+};
+
+// Collects the edges of the capture:
+struct Edges {
+  std::vector<uint64_t> times;
+  std::vector<uint8_t> levels;
+  void operator()(uint64_t timeUs, uint8_t level) {
+    times.push_back(timeUs);
+    levels.push_back(level);
+  }
+};
+
+// Listener that adds each frame to the uplink, as a sketch would do after dataAvailable():
+struct UplinkSender {
+  IRsmallDUplink &uplink;
+  void onFrame(uint64_t, const irSmallD_t &irData) { uplink.add(irData); }
+  void onReject(uint64_t, uint8_t, uint32_t) {}
+  void onRepeatIgnored(uint64_t) {}
+  void onTimeout(uint64_t, uint8_t) {}
+};
+
+struct Frame {
+  uint64_t time;
+  irSmallD_t data;
+};
+
+struct FrameCollector {
+  std::vector<Frame> frames;
+  void onFrame(uint64_t timeUs, const irSmallD_t &irData) { frames.push_back(Frame{timeUs, irData}); }
+  void onReject(uint64_t, uint8_t, uint32_t) {}
+  void onRepeatIgnored(uint64_t) {}
+  void onTimeout(uint64_t, uint8_t) {}
+};
+
+// Decodes the edges and sends the frames, with poll()'s policy: the batch is sent when the decoder is in standby
+// (and the batch is due), or when it's full:
+static bool send(const Edges &edges, FdPrint &output, uint16_t maxDelay) {
+  IRsmallDUplink uplink(output, maxDelay);
+  UplinkSender sender = {uplink};
+  IRsmallDHostDecoder<UplinkSender> decoder(sender);
+  for (size_t i = 0; i < edges.times.size() && output.ok; i++) {
+    decoder.edge(edges.times[i], edges.levels[i]);
+    if (decoder.state() == 0) uplink.flushIfDue();
+  }
+  decoder.finish();
+  uplink.flush();
+  return output.ok;
+}
+
+
+// ****************************************************************************
+// End-to-end test
+
+struct RecordCollector {
+  std::vector<irUplinkRecord_t> records;
+  void onRecord(const irUplinkRecord_t &record) { records.push_back(record); }
+};
+
+static bool sameFrame(const irUplinkRecord_t &record, const Frame &frame) {
+  const irSmallD_t &irData = frame.data;
+  #if defined(IR_SMALLD_TIMESTAMPS)
+    uint32_t time = irData.time;
+  #else
+    uint32_t time = (uint32_t)frame.time;
+  #endif
+  #if defined(IR_SMALLD_HASH)
+    bool same = record.hash() == irData.hash;
+  #else
+    bool same = record.addr == irData.addr && record.cmd == irData.cmd;
+    #if defined(IR_SMALLD_SIRC20) || defined(IR_SMALLD_SIRC)
+      same = same && record.ext == irData.ext;
+    #endif
+    #if defined(IR_SMALLD_HAS_KEYHELD)
+      same = same && record.hasKeyHeld() && record.keyHeld() == irData.keyHeld;
+    #endif
+  #endif
+  return same && record.protocol == IR_SMALLD_PROTOCOL_ID && record.time == time;
+}
+
+static int test(const Edges &edges, uint16_t maxDelay) {
+  int master, slave;
+  if (openpty(&master, &slave, NULL, NULL, NULL) < 0 || !setRaw(slave, 0)) {
+    perror("openpty");
+    return 1;
+  }
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {  // The "board"
+    close(master);
+    FdPrint output(slave);
+    bool ok = send(edges, output, maxDelay);
+    tcdrain(slave);
+    close(slave);
+    _exit(ok ? 0 : 1);
+  }
+  close(slave);
+  RecordCollector collector;
+  IRsmallDUplinkParser<RecordCollector> parser(collector);
+  receive(master, parser);
+  close(master);
+  int status;
+  waitpid(pid, &status, 0);
+
+  FrameCollector expected;  // This process never used the decoder, so it starts from scratch, as the child did
+  IRsmallDHostDecoder<FrameCollector> decoder(expected);
+  for (size_t i = 0; i < edges.times.size(); i++) decoder.edge(edges.times[i], edges.levels[i]);
+  decoder.finish();
+
+  const IRsmallDUplinkParser<RecordCollector>::Stats &stats = parser.stats();
+  size_t n = collector.records.size() < expected.frames.size() ? collector.records.size() : expected.frames.size();
+  size_t i = 0;
+  while (i < n && sameFrame(collector.records[i], expected.frames[i])) i++;
+  bool same = i == collector.records.size() && i == expected.frames.size() && !stats.badPackets && !stats.lostPackets;
+  if (!same) {
+    fprintf(stderr, "Records differ at #%zu (%zu frames decoded, %zu records received)\n", i, expected.frames.size(),
+            collector.records.size());
+  }
+  fprintf(stderr, IR_HOST_PROTOCOL ": %zu frames, %llu records in %llu packets, %llu bytes (%.1f bytes/frame), "
+          "%llu bad, %llu lost (%s)\n", expected.frames.size(), (unsigned long long)stats.records,
+          (unsigned long long)stats.packets, (unsigned long long)stats.bytes,
+          expected.frames.empty() ? 0.0 : (double)stats.bytes / expected.frames.size(),
+          (unsigned long long)stats.badPackets, (unsigned long long)stats.lostPackets, same ? "identical" : "DIFFERENT");
+  if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+    fprintf(stderr, "The sender failed\n");
+    return 1;
+  }
+  return same ? 0 : 1;
+}
+
+
+// ****************************************************************************
+
+static int usage(const char *name) {
+  fprintf(stderr, "Usage: %s [-b baud] [device]\n", name);
+  fprintf(stderr, "       %s -s [-d delay] [-o device] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [capture file]\n", name);
+  fprintf(stderr, "       %s -t [-d delay] [-f list|csv|vcd|rec] [-c channel] [-r samplerate] [-i] [capture file]\n", name);
+  return 2;
+}
+
+
+int main(int argc, char *argv[]) {
+  irCaptureOptions_t options;
+  bool formatGiven = false, sendMode = false, testMode = false;
+  const char *outName = NULL;
+  long baud = 0;
+  uint16_t maxDelay = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:std:o:f:c:r:ih")) != -1) {
+    switch (opt) {
+      case 'b': baud = atol(optarg); break;
+      case 's': sendMode = true; break;
+      case 't': testMode = true; break;
+      case 'd': maxDelay = atoi(optarg); break;
+      case 'o': outName = optarg; break;
+      case 'f':
+        formatGiven = true;
+        if (!strcmp(optarg, "csv")) options.format = IR_CAPTURE_CSV;
+        else if (!strcmp(optarg, "vcd")) options.format = IR_CAPTURE_VCD;
+        else if (!strcmp(optarg, "list")) options.format = IR_CAPTURE_LIST;
+        else if (!strcmp(optarg, "rec")) options.format = IR_CAPTURE_REC;
+        else return usage(argv[0]);
+      break;
+      case 'c': options.channel = optarg; break;
+      case 'r': options.sampleRate = atof(optarg); break;
+      case 'i': options.invert = true; break;
+      default: return usage(argv[0]);
+    }
+  }
+  if (argc - optind > 1 || (sendMode && testMode)) return usage(argv[0]);
+  speed_t speed = 0;
+  if (baud && !(speed = baudRate(baud))) {
+    fprintf(stderr, "Unsupported baud rate: %ld\n", baud);
+    return 2;
+  }
+
+  if (!sendMode && !testMode) {  // Receiver
+    int fd = STDIN_FILENO;
+    if (optind < argc) {
+      fd = open(argv[optind], O_RDONLY | O_NOCTTY);
+      if (fd < 0) {
+        perror(argv[optind]);
+        return 1;
+      }
+    }
+    if (isatty(fd) && !setRaw(fd, speed)) perror("tcsetattr");
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;  // No SA_RESTART: read() is interrupted
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    RecordPrinter printer;
+    IRsmallDUplinkParser<RecordPrinter> parser(printer);
+    receive(fd, parser);
+    printStats(parser.stats());
+    return 0;
+  }
+
+  FILE *file = stdin;
+  if (optind < argc) {
+    file = fopen(argv[optind], "rb");
+    if (!file) {
+      perror(argv[optind]);
+      return 1;
+    }
+    if (!formatGiven) options.format = irCaptureFormatFromName(argv[optind]);
+  }
+  Edges edges;
+  IRsmallDCaptureReader<Edges> reader(options, edges);
+  bool ok = reader.read(file);
+  if (file != stdin) fclose(file);
+  if (!ok) return 1;
+
+  if (testMode) return test(edges, maxDelay);
+
+  int fd = STDOUT_FILENO;
+  if (outName) {
+    fd = open(outName, O_WRONLY | O_NOCTTY);
+    if (fd < 0) {
+      perror(outName);
+      return 1;
+    }
+  }
+  if (isatty(fd) && !setRaw(fd, speed)) perror("tcsetattr");
+  FdPrint output(fd);
+  ok = send(edges, output, maxDelay);
+  if (isatty(fd)) tcdrain(fd);
+  fprintf(stderr, IR_HOST_PROTOCOL ": %llu bytes in %llu writes\n", (unsigned long long)output.bytes,
+          (unsigned long long)output.writes);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+/* IRsmallDIndices - Compile-time index sequences (used by the keymaps and the key sequences)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Notes:
+ * - C++11 doesn't have std::index_sequence (and AVR boards don't have the standard library anyway);
+ * - MakeIndices<N>::type is Indices<0, 1, ..., N-1>, built with logarithmic template depth, so it can be used
+ *   to fill arrays of a few hundred elements with constexpr functions ({ f(I)... }).
+ */
+
+#ifndef IRsmallD_Indices_h
+#define IRsmallD_Indices_h
+
+namespace IRsmallDIndices {
+  template <uint16_t... I> struct Indices {};
+  template <class A, class B> struct Concat;
+  template <uint16_t... A, uint16_t... B> struct Concat<Indices<A...>, Indices<B...>> {
+    typedef Indices<A..., (sizeof...(A) + B)...> type;
+  };
+  template <uint16_t N> struct MakeIndices {
+    typedef typename Concat<typename MakeIndices<N / 2>::type, typename MakeIndices<N - N / 2>::type>::type type;
+  };
+  template <> struct MakeIndices<0> { typedef Indices<> type; };
+  template <> struct MakeIndices<1> { typedef Indices<0> type; };
+}
+
+#endif
@@ -0,0 +1,289 @@
+/* IRsmallDKeymap - Compile-time keymap (maps addr/cmd pairs to handler functions)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Usage (after the #include <IRsmallDecoder.h>):
+ *
+ *   #include <IRsmallDKeymap.h>
+ *
+ *   void onPower(const irSmallD_t &irData) { ... }
+ *   void onVolUp(const irSmallD_t &irData) { ... }
+ *
+ *   IR_SMALLD_KEYMAP(tvKeys,                      // name of the keymap
+ *     {0x00, 0x45, IR_KEY_PRESS,  onPower},       // {addr, cmd, keyHeld policy, handler}
+ *     {0x00, 0x46, IR_KEY_REPEAT, onVolUp}
+ *   );
+ *
+ *   void loop() {
+ *     tvKeys.dispatch(irDecoder);  // or: if (irDecoder.dataAvailable(irData)) tvKeys.dispatch(irData);
+ *   }
+ *
+ * KeyHeld policies:
+ *   IR_KEY_PRESS  - the handler is only called when the key is pressed (held key repetitions are ignored);
+ *   IR_KEY_REPEAT - the handler is called when the key is pressed and again for each held key repetition;
+ *   IR_KEY_HELD   - the handler is only called for held key repetitions.
+ *   Protocols without the keyHeld member (SIRC12, SIRC15 and SIRC20, unless IR_SMALLD_SIRC_KEYHELD is defined)
+ *   treat all keys as IR_KEY_PRESS.
+ *
+ * How it works:
+ *   At compile time, the keys are split into buckets (between n/2 and n of them) by a hash function
+ *   (h = key x multiplier, keeping the top bits), and, for each bucket, another multiplier and number of bits are
+ *   searched for, such that no two keys of the bucket share the same slot (a two-level perfect hash). Each bucket has
+ *   a few keys, so the searches are short. The buckets' parameters (3 bytes each) and the slot table (one byte per
+ *   slot: the table index + 1, or 0 if empty) are stored in PROGMEM, along with the keymap table.
+ *   At runtime, a dispatch is just two multiplications, three table lookups and one key comparison (no RAM is used).
+ *   Duplicate keys, or tables for which no perfect hash is found, result in a compilation error.
+ *
+ * Notes:
+ *   - It requires C++11 (the default in the Arduino IDE);
+ *   - Up to 254 keys per keymap, which take about 3 bytes each besides the keymap table (657 to 674 bytes for
+ *     254 keys, as measured by extras/HostTools/irkeymap; 671 for scattered ones). A keymap that large takes a few seconds to compile (about 2.5 s with g++ 12 on a PC);
+ *   - Multiple keymaps (one for each remote, for instance) can be used in the same sketch;
+ *   - The HASH decoder has no addr/cmd, so it can't be used with keymaps.
+ */
+
+#ifndef IRsmallD_Keymap_h
+#define IRsmallD_Keymap_h
+
+#if !defined(IRsmallDecoder_h)
+  #error IRsmallDKeymap.h must be included after IRsmallDecoder.h
+#endif
+#if defined(IR_SMALLD_HASH)
+  #error IRsmallDKeymap.h cannot be used with the HASH decoder (it has no addr and cmd)
+#endif
+
+#include "IRsmallDIndices.h"
+
+
+// KeyHeld policies:
+#define IR_KEY_PRESS  0
+#define IR_KEY_REPEAT 1
+#define IR_KEY_HELD   2
+
+// Keymap declaration (creates the table and an IRsmallDKeymap object with the given name):
+#define IR_SMALLD_KEYMAP(name, ...)                                             \
+  struct name##_keymapTable {                                                   \
+    static constexpr irSmallD_key_t keys[] PROGMEM = { __VA_ARGS__ };           \
+  };                                                                            \
+  constexpr irSmallD_key_t name##_keymapTable::keys[];                          \
+  IRsmallDKeymap<name##_keymapTable> name
+
+
+typedef void (*irSmallD_handler_t)(const irSmallD_t &irData);
+
+struct irSmallD_key_t {
+  uint16_t addr;
+  uint8_t  cmd;
+  uint8_t  policy;
+  irSmallD_handler_t handler;
+};
+
+
+// ****************************************************************************
+// Compile-time functions (C++11 constexpr functions can only have one return statement, hence the recursion).
+// The intermediate results are kept in constexpr arrays, so each one is only computed once.
+namespace IRsmallDKeymapDetail {
+  const uint8_t c_bucketSeeds = 16;  // Number of multipliers tried for each bucket (the seed is stored in 4 bits)
+  const uint8_t c_maxSlotBits = 8;   // A bucket can have up to 2^8 slots
+  const uint8_t c_noParams = 0xFF;   // Bucket without a perfect hash
+
+  using IRsmallDIndices::Indices;
+  using IRsmallDIndices::MakeIndices;
+
+  constexpr uint32_t key(uint16_t addr, uint8_t cmd) { return ((uint32_t)addr << 8) | cmd; }
+
+  constexpr uint32_t multiplier(uint8_t seed) { return (2654435761UL + seed * 0x7F4A7C16UL) | 1; }
+
+  constexpr uint32_t hash(uint32_t k, uint8_t seed) { return (uint32_t)(k * multiplier(seed)); }
+
+  // Bucket of a key (the top bits of the hash with seed 0):
+  constexpr uint16_t bucket(uint32_t k, uint8_t bits) { return hash(k, 0) >> (32 - bits); }
+
+  // Slot of a key in its bucket (the top bits of the top byte of the hash with seed + 1, 0 to 8 bits):
+  constexpr uint8_t slot(uint32_t k, uint8_t seed, uint8_t bits) { return (uint8_t)(hash(k, seed + 1) >> 24) >> (8 - bits); }
+
+  constexpr uint8_t minBits(uint16_t n, uint8_t bits = 0) {
+    return ((uint16_t)1 << bits) >= n ? bits : minBits(n, bits + 1);
+  }
+
+  template <class T> constexpr uint8_t size() { return sizeof(T::keys) / sizeof(T::keys[0]); }
+
+  template <class T> struct Buckets {  // Between n/2 and n buckets (at least 2)
+    static constexpr uint8_t bits = minBits(size<T>()) > 1 ? minBits(size<T>()) - 1 : 1;
+    static constexpr uint16_t count = 1 << bits;
+  };
+
+  template <class T, class I = typename MakeIndices<size<T>()>::type> struct Keys;
+  template <class T, uint16_t... I> struct Keys<T, Indices<I...>> {
+    static constexpr uint32_t key[sizeof...(I)] = { IRsmallDKeymapDetail::key(T::keys[I].addr, T::keys[I].cmd)... };
+    static constexpr uint16_t bucket[sizeof...(I)] = { IRsmallDKeymapDetail::bucket(key[I], Buckets<T>::bits)... };
+  };
+
+  template <class T> constexpr uint32_t keyAt(uint16_t i) { return Keys<T>::key[i]; }
+
+  template <class T> constexpr uint16_t bucketOf(uint16_t i) { return Keys<T>::bucket[i]; }
+
+  // Number of keys, from the i-th on, in a bucket before b (4 keys per call, to keep the recursion shallow):
+  template <class T> constexpr uint16_t countBefore(uint16_t b, uint16_t i) {
+    return i >= size<T>() ? 0
+         : (bucketOf<T>(i) < b) + (i + 1 < size<T>() && bucketOf<T>(i + 1) < b) + (i + 2 < size<T>() && bucketOf<T>(i + 2) < b)
+           + (i + 3 < size<T>() && bucketOf<T>(i + 3) < b) + countBefore<T>(b, i + 4);
+  }
+
+  // Position of the first key of each bucket, with the keys sorted by bucket (and the number of keys, at the end):
+  template <class T, class I = typename MakeIndices<Buckets<T>::count + 1>::type> struct Starts;
+  template <class T, uint16_t... I> struct Starts<T, Indices<I...>> {
+    static constexpr uint16_t start[sizeof...(I)] = { countBefore<T>(I, 0)... };
+  };
+
+  template <class T> constexpr uint8_t bucketSize(uint16_t b) { return Starts<T>::start[b + 1] - Starts<T>::start[b]; }
+
+  // Last element of a sorted array, in [lo, hi[, that is less than or equal to v:
+  constexpr uint16_t lastAtOrBelow(const uint16_t *array, uint16_t v, uint16_t lo, uint16_t hi) {
+    return hi - lo == 1 ? lo
+         : array[(lo + hi) / 2] <= v ? lastAtOrBelow(array, v, (lo + hi) / 2, hi) : lastAtOrBelow(array, v, lo, (lo + hi) / 2);
+  }
+
+  // Index of the r-th key in bucket b (from the i-th key on):
+  template <class T> constexpr uint8_t nthInBucket(uint16_t b, uint8_t r, uint16_t i = 0) {
+    return bucketOf<T>(i) != b ? nthInBucket<T>(b, r, i + 1) : r ? nthInBucket<T>(b, r - 1, i + 1) : i;
+  }
+
+  template <class T> constexpr uint8_t keyAtPosition(uint16_t p, uint16_t b) { return nthInBucket<T>(b, p - Starts<T>::start[b]); }
+
+  // Key indices sorted by bucket (the keys of each bucket keep their order):
+  template <class T, class I = typename MakeIndices<size<T>()>::type> struct Sorted;
+  template <class T, uint16_t... I> struct Sorted<T, Indices<I...>> {
+    static constexpr uint8_t index[sizeof...(I)] = { keyAtPosition<T>(I, lastAtOrBelow(Starts<T>::start, I, 0, Buckets<T>::count))... };
+  };
+
+  template <class T> constexpr uint8_t memberIndex(uint16_t b, uint8_t r) { return Sorted<T>::index[Starts<T>::start[b] + r]; }
+
+  template <class T> constexpr uint32_t member(uint16_t b, uint8_t r) { return keyAt<T>(memberIndex<T>(b, r)); }
+
+  // Is the r-th key of bucket b equal to (or, if slots is true, in the same slot as) any of the keys before it?
+  template <class T> constexpr bool collides(uint16_t b, bool slots, uint8_t seed, uint8_t bits, uint8_t r, uint8_t q = 0) {
+    return q >= r ? false
+         : (slots ? slot(member<T>(b, r), seed, bits) == slot(member<T>(b, q), seed, bits) : member<T>(b, r) == member<T>(b, q))
+           || collides<T>(b, slots, seed, bits, r, q + 1);
+  }
+
+  template <class T> constexpr bool isPerfect(uint16_t b, bool slots, uint8_t seed, uint8_t bits, uint8_t r = 1) {
+    return r >= bucketSize<T>(b) ? true : !collides<T>(b, slots, seed, bits, r) && isPerfect<T>(b, slots, seed, bits, r + 1);
+  }
+
+  template <class T> constexpr bool hasDuplicates(uint16_t lo, uint16_t hi) {  // In buckets [lo, hi[
+    return hi - lo == 1 ? !isPerfect<T>(lo, false, 0, 0) : hasDuplicates<T>(lo, (lo + hi) / 2) || hasDuplicates<T>((lo + hi) / 2, hi);
+  }
+
+  // Bits (high nibble) and seed (low nibble) of the bucket's slot hash, with the fewest bits:
+  template <class T> constexpr uint8_t findParams(uint16_t b, uint8_t bits, uint8_t seed = 0) {
+    return bits > c_maxSlotBits ? c_noParams
+         : seed >= c_bucketSeeds ? findParams<T>(b, bits + 1)
+         : isPerfect<T>(b, true, seed, bits) ? (bits << 4 | seed) : findParams<T>(b, bits, seed + 1);
+  }
+
+  template <class T, class I = typename MakeIndices<Buckets<T>::count>::type> struct Params;
+  template <class T, uint16_t... I> struct Params<T, Indices<I...>> {
+    static constexpr uint8_t params[sizeof...(I)] PROGMEM = { findParams<T>(I, minBits(bucketSize<T>(I)))... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t Params<T, Indices<I...>>::params[sizeof...(I)];
+
+  template <class T> constexpr bool allFound(uint16_t lo, uint16_t hi) {  // For buckets [lo, hi[
+    return hi - lo == 1 ? Params<T>::params[lo] != c_noParams : allFound<T>(lo, (lo + hi) / 2) && allFound<T>((lo + hi) / 2, hi);
+  }
+
+  template <class T> constexpr uint16_t slotCount(uint16_t b) {  // Empty buckets have no slots
+    return (!bucketSize<T>(b) || Params<T>::params[b] == c_noParams) ? 0 : 1 << (Params<T>::params[b] >> 4);
+  }
+
+  template <class T> constexpr uint16_t slotsBefore(uint16_t b, uint16_t lo = 0) {  // Slots of buckets [lo, b[
+    return b - lo == 0 ? 0 : b - lo == 1 ? slotCount<T>(lo) : slotsBefore<T>((lo + b) / 2, lo) + slotsBefore<T>(b, (lo + b) / 2);
+  }
+
+  // First slot of each bucket (and the number of slots, at the end):
+  template <class T, class I = typename MakeIndices<Buckets<T>::count + 1>::type> struct Offsets;
+  template <class T, uint16_t... I> struct Offsets<T, Indices<I...>> {
+    static constexpr uint16_t offsets[sizeof...(I)] PROGMEM = { slotsBefore<T>(I)... };
+  };
+  template <class T, uint16_t... I> constexpr uint16_t Offsets<T, Indices<I...>>::offsets[sizeof...(I)];
+
+  // Index + 1 of the key of bucket b (from its r-th key on) that is in slot s of the bucket, or 0 if there's none:
+  template <class T> constexpr uint8_t keyInSlot(uint16_t b, uint16_t s, uint8_t r = 0) {
+    return r >= bucketSize<T>(b) ? 0
+         : slot(member<T>(b, r), Params<T>::params[b] & 0x0F, Params<T>::params[b] >> 4) == s ? memberIndex<T>(b, r) + 1
+         : keyInSlot<T>(b, s, r + 1);
+  }
+
+  template <class T> constexpr uint8_t slotContent(uint16_t s, uint16_t b) { return keyInSlot<T>(b, s - Offsets<T>::offsets[b]); }
+
+  // Slot table (table index + 1, or 0 if the slot is empty), with an empty slot after the last one, for empty buckets:
+  template <class T, class I = typename MakeIndices<Offsets<T>::offsets[Buckets<T>::count] + 1>::type> struct Slots;
+  template <class T, uint16_t... I> struct Slots<T, Indices<I...>> {
+    static constexpr uint8_t slots[sizeof...(I)] PROGMEM = { slotContent<T>(I, lastAtOrBelow(Offsets<T>::offsets, I, 0, Buckets<T>::count))... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t Slots<T, Indices<I...>>::slots[sizeof...(I)];
+}
+
+
+// ****************************************************************************
+/**
+ * Keymap class, created by the IR_SMALLD_KEYMAP macro.
+ * Calls the handler function associated with the address and command of the decoded data.
+ */
+template <class T> class IRsmallDKeymap {
+  private:
+    typedef IRsmallDKeymapDetail::Buckets<T> Buckets;
+
+    static_assert(IRsmallDKeymapDetail::size<T>() <= 254, "IR keymap: too many keys (maximum is 254)");
+    static_assert(!IRsmallDKeymapDetail::hasDuplicates<T>(0, Buckets::count), "IR keymap: duplicate key (the same addr and cmd is used more than once)");
+    static_assert(IRsmallDKeymapDetail::hasDuplicates<T>(0, Buckets::count) || IRsmallDKeymapDetail::allFound<T>(0, Buckets::count),
+                  "IR keymap: no perfect hash found (try splitting the keymap)");
+
+  public:
+    bool dispatch(const irSmallD_t &irData);
+    bool dispatch(IRsmallDecoder &irDecoder);
+};
+
+
+/**
+ * Calls the handler of the key that matches the decoded data (if its keyHeld policy allows it).
+ *
+ * @param irData the decoded data (retrieved with the dataAvailable() method).
+ * @return true if a handler was called; false if not.
+ */
+template <class T> bool IRsmallDKeymap<T>::dispatch(const irSmallD_t &irData) {
+  using namespace IRsmallDKeymapDetail;
+  uint32_t k = key(irData.addr, irData.cmd);
+  uint16_t b = bucket(k, Buckets::bits);
+  uint8_t params = pgm_read_byte(&Params<T>::params[b]);
+  uint16_t s = pgm_read_word(&Offsets<T>::offsets[b]) + slot(k, params & 0x0F, params >> 4);
+  uint8_t index = pgm_read_byte(&Slots<T>::slots[s]);
+  if (!index) return false;  // Empty slot, unknown key
+
+  irSmallD_key_t entry;
+  memcpy_P(&entry, &T::keys[index - 1], sizeof(entry));
+  if (entry.addr != irData.addr || entry.cmd != irData.cmd) return false;  // Same slot, but unknown key
+
+  #if defined(IR_SMALLD_HAS_KEYHELD)
+    if (irData.keyHeld ? entry.policy == IR_KEY_PRESS : entry.policy == IR_KEY_HELD) return false;
+  #endif
+  entry.handler(irData);
+  return true;
+}
+
+
+/**
+ * Retrieves the decoded data, if available, and calls the corresponding handler.
+ *
+ * @param irDecoder the decoder to check.
+ * @return true if a handler was called; false if not.
+ */
+template <class T> bool IRsmallDKeymap<T>::dispatch(IRsmallDecoder &irDecoder) {
+  irSmallD_t irData;
+  return irDecoder.dataAvailable(irData) && dispatch(irData);
+}
+
+#endif
@@ -57,6 +57,11 @@
       #undef  IR_SMALLD_SAMSUNG32
       #define IR_SMALLD_SAMSUNG32 1
   #endif
+
+  #ifdef      IR_SMALLD_HASH
+      #undef  IR_SMALLD_HASH
+      #define IR_SMALLD_HASH 1
+  #endif
   
   
   #define IR_SMALLD_CHECKSUM \
@@ -68,7 +73,8 @@
       + IR_SMALLD_SIRC20    \
       + IR_SMALLD_SIRC      \
       + IR_SMALLD_SAMSUNG   \
-      + IR_SMALLD_SAMSUNG32 )
+      + IR_SMALLD_SAMSUNG32 \
+      + IR_SMALLD_HASH      )
 
   #if IR_SMALLD_CHECKSUM == 0
       #error No protocol defined or misspelled. Check the IRsmallDecoder library documentation
@@ -78,4 +84,28 @@
 
   // If no errors, then there's one and only one protocol macro defined (IR_SMALLD_CHECKSUM == 1)
 
+  // ID of the selected protocol (the values are listed in IRsmallDProtocolIDs.h):
+  #include "IRsmallDProtocolIDs.h"
+  #if defined(IR_SMALLD_NEC)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_NEC
+  #elif defined(IR_SMALLD_NECx)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_NECx
+  #elif defined(IR_SMALLD_RC5)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_RC5
+  #elif defined(IR_SMALLD_SIRC12)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SIRC12
+  #elif defined(IR_SMALLD_SIRC15)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SIRC15
+  #elif defined(IR_SMALLD_SIRC20)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SIRC20
+  #elif defined(IR_SMALLD_SIRC)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SIRC
+  #elif defined(IR_SMALLD_SAMSUNG)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SAMSUNG
+  #elif defined(IR_SMALLD_SAMSUNG32)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_SAMSUNG32
+  #elif defined(IR_SMALLD_HASH)
+    #define IR_SMALLD_PROTOCOL_ID IR_SMALLD_ID_HASH
+  #endif
+
 #endif
\ No newline at end of file
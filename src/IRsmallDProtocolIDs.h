@@ -0,0 +1,30 @@
+/* IRsmallDProtocolIDs - Protocol identification numbers
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Notes:
+ * - Each protocol has a small, fixed ID that fits in one byte (0 means unknown / not detected).
+ * - These values will not change between releases, so they can be stored in EEPROM and compared at startup
+ *   with IR_SMALLD_PROTOCOL_ID, to check which protocol a firmware was built for. They only identify the compiled
+ *   decoder: detecting the protocol at runtime, or switching to another one, is out of the library's scope.
+ * - This file does not depend on the protocol selection, so it can be included on its own.
+ */
+
+#ifndef IRsmallD_ProtocolIDs_h
+#define IRsmallD_ProtocolIDs_h
+
+  #define IR_SMALLD_ID_UNKNOWN    0
+  #define IR_SMALLD_ID_NEC        1
+  #define IR_SMALLD_ID_NECx       2
+  #define IR_SMALLD_ID_RC5        3
+  #define IR_SMALLD_ID_SIRC12     4
+  #define IR_SMALLD_ID_SIRC15     5
+  #define IR_SMALLD_ID_SIRC20     6
+  #define IR_SMALLD_ID_SIRC       7
+  #define IR_SMALLD_ID_SAMSUNG    8
+  #define IR_SMALLD_ID_SAMSUNG32  9
+  #define IR_SMALLD_ID_HASH      10
+
+#endif
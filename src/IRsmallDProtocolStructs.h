@@ -7,11 +7,54 @@
 #ifndef IRsmallD_ProtocolStructs_h
 #define IRsmallD_ProtocolStructs_h
 
+  // Optional frame timing members (if IR_SMALLD_TIMESTAMPS is defined):
+  //   time     - micros() value of the frame's last edge;
+  //   duration - time between the first and the last edge of the frame (µs);
+  //   latency  - time the data waited to be retrieved by dataAvailable() (µs).
+  #if defined(IR_SMALLD_TIMESTAMPS)
+    #define IR_SMALLD_TIMING_MEMBERS \
+      uint32_t time;                 \
+      uint32_t duration;             \
+      uint32_t latency;
+  #else
+    #define IR_SMALLD_TIMING_MEMBERS  //nothing
+  #endif
+
+  // Optional signal quality members (if IR_SMALLD_QUALITY is defined), measured on the frame's bit marks:
+  //   meanDeviation - mean difference between the bit marks and their nominal duration (µs);
+  //   maxDeviation  - largest difference between a bit mark and its nominal duration (µs);
+  //   minMargin     - smallest distance between a bit mark and the thresholds that accepted it (µs);
+  //   quality       - score from 0 (a bit mark was on a threshold) to 100 (all bit marks were nominal).
+  #if defined(IR_SMALLD_QUALITY)
+    #define IR_SMALLD_QUALITY_MEMBERS \
+      uint16_t meanDeviation;         \
+      uint16_t maxDeviation;          \
+      uint16_t minMargin;             \
+      uint8_t  quality;
+  #else
+    #define IR_SMALLD_QUALITY_MEMBERS  //nothing
+  #endif
+
+  // The basic SIRC12, SIRC15 and SIRC20 decoders only detect held keys if IR_SMALLD_SIRC_KEYHELD is defined.
+  // IR_SMALLD_HAS_KEYHELD is defined for the protocols that have the keyHeld member (it's all of them, except HASH):
+  #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15) || defined(IR_SMALLD_SIRC20)
+    #if defined(IR_SMALLD_SIRC_KEYHELD)
+      #define IR_SMALLD_SIRC_KEYHELD_MEMBER  bool keyHeld;
+      #define IR_SMALLD_HAS_KEYHELD
+    #else
+      #define IR_SMALLD_SIRC_KEYHELD_MEMBER  //nothing
+    #endif
+  #elif !defined(IR_SMALLD_HASH)
+    #define IR_SMALLD_HAS_KEYHELD
+  #endif
+
   #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_RC5) || defined(IR_SMALLD_SAMSUNG32)
     struct irSmallD_t {
       uint8_t addr;
       uint8_t cmd;
       bool    keyHeld;
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
     };
 
   #elif defined(IR_SMALLD_NECx) || defined(IR_SMALLD_SAMSUNG)
@@ -19,12 +62,17 @@
       uint16_t addr;
       uint8_t  cmd;
       bool     keyHeld;
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
     };
 
   #elif defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15)
     struct irSmallD_t {
       uint8_t addr;
       uint8_t cmd;
+      IR_SMALLD_SIRC_KEYHELD_MEMBER
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
     };
 
   #elif defined(IR_SMALLD_SIRC20)
@@ -32,6 +80,9 @@
       uint8_t ext;  //extended data
       uint8_t addr;
       uint8_t cmd;
+      IR_SMALLD_SIRC_KEYHELD_MEMBER
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
     };
 
   #elif defined(IR_SMALLD_SIRC)
@@ -40,6 +91,15 @@
       uint8_t addr;
       uint8_t cmd;
       bool    keyHeld;
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
+    };
+
+  #elif defined(IR_SMALLD_HASH)
+    struct irSmallD_t {
+      uint32_t hash;  //hash of the frame's intervals
+      IR_SMALLD_TIMING_MEMBERS
+      IR_SMALLD_QUALITY_MEMBERS
     };
 
   #else
@@ -0,0 +1,425 @@
+/* IRsmallDSequence - Compile-time key sequence recognizer (service codes, key combinations...)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Usage (after the #include <IRsmallDecoder.h>):
+ *
+ *   #include <IRsmallDSequence.h>
+ *
+ *   IR_SMALLD_SEQUENCES(serviceCodes,            // name of the sequence set
+ *     0x00, 3000,                                 // address of the remote, maximum time between keys (ms)
+ *     IR_SEQ(0x47, 0x0C, 0x4A, 0x42, 0x1C),       // sequence 0: MENU 1 9 7 OK
+ *     IR_SEQ(0x0C, 0x18, 0x1C)                    // sequence 1: 1 2 OK
+ *   );
+ *
+ *   void loop() {
+ *     switch (serviceCodes.update(irDecoder)) {   // or: if (irDecoder.dataAvailable(irData)) serviceCodes.update(irData)
+ *       case 0: ... break;
+ *       case 1: ... break;
+ *     }                                           // -1 (IR_SEQ_NONE) if no sequence was completed
+ *   }
+ *
+ * Each sequence is a list of commands. A sequence is recognized when its keys are pressed in order, with no more
+ * than the given time between two keys (otherwise, the sequence starts over). Keys that don't fit are allowed before
+ * a sequence (e.g. 2 2 1 2 OK completes "1 2 OK"). After a sequence is recognized, the next one starts from scratch.
+ * Held keys count as a single key press, frames from other addresses are ignored.
+ *
+ * How it works:
+ *   At compile time, the sequences are turned into an Aho-Corasick automaton: a tree with a node for each distinct
+ *   beginning of a sequence (the states), and the failure links folded into a transition table, so every
+ *   state has a next state for every key used in the sequences. Keys are mapped to table columns by a perfect hash
+ *   (as in the keymaps). The tables are stored in PROGMEM. At runtime, each key takes one multiplication and
+ *   three table lookups, regardless of the number and length of the sequences, and the only RAM used is the
+ *   current state (one byte) and the time of the last key (two bytes).
+ *
+ * Notes:
+ *   - It requires C++11 (the default in the Arduino IDE);
+ *   - Up to 127 sequences, with up to 254 keys in total (the transition table has states x distinct keys bytes);
+ *   - A sequence cannot contain another one, unless it ends with it (e.g. "1 2 OK" and "2 OK" are allowed,
+ *     the longest one is reported, but "1 2" and "1 2 OK" are not), nor be repeated. These are compilation errors;
+ *   - SIRC12, SIRC15 and SIRC20 don't have the keyHeld member (unless IR_SMALLD_SIRC_KEYHELD is defined), so
+ *     frames less than 100ms apart are taken as repetitions of the same key;
+ *   - The HASH decoder has no addr/cmd, so it can't be used with key sequences.
+ */
+
+#ifndef IRsmallD_Sequence_h
+#define IRsmallD_Sequence_h
+
+#if !defined(IRsmallDecoder_h)
+  #error IRsmallDSequence.h must be included after IRsmallDecoder.h
+#endif
+#if defined(IR_SMALLD_HASH)
+  #error IRsmallDSequence.h cannot be used with the HASH decoder (it has no addr and cmd)
+#endif
+
+#include "IRsmallDIndices.h"
+
+
+#define IR_SEQ_END  0xFFFF  // End of a sequence, in the symbols table
+#define IR_SEQ_NONE -1      // Returned by update() when no sequence was completed
+
+// Sequence declaration (a list of commands):
+#define IR_SEQ(...) __VA_ARGS__, IR_SEQ_END
+
+// Sequence set declaration (creates the table and an IRsmallDSequences object with the given name):
+#define IR_SMALLD_SEQUENCES(name, address, timeoutMs, ...)                     \
+  struct name##_sequenceTable {                                                 \
+    static const uint16_t addr = address;                                       \
+    static const uint16_t timeout = timeoutMs;                                  \
+    static constexpr uint16_t symbols[] = { __VA_ARGS__ };                      \
+  };                                                                            \
+  constexpr uint16_t name##_sequenceTable::symbols[];                           \
+  IRsmallDSequences<name##_sequenceTable> name
+
+
+// ****************************************************************************
+// Compile-time functions (C++11 constexpr functions can only have one return statement, hence the recursion).
+// A position is an index in the symbols table; each position that isn't an IR_SEQ_END is the last key of the
+// beginning of a sequence, and the first position where each distinct beginning appears creates a state.
+namespace IRsmallDSequenceDetail {
+  using IRsmallDIndices::Indices;
+  using IRsmallDIndices::MakeIndices;
+
+  const uint16_t c_notFound = 0xFFFF;
+  const uint8_t  c_maxBits = 8;        // The key hash table can have up to 256 slots
+  const uint8_t  c_maxSeeds = 128;     // Number of multipliers tried for each hash table size
+
+  // The loops over positions (or keys) split their range [from, to) in two halves, so the recursion depth
+  // is logarithmic (the compilers limit the depth of constexpr calls, usually to 512):
+  constexpr uint16_t half(uint16_t from, uint16_t to) { return from + (to - from) / 2; }
+
+  constexpr uint16_t firstFound(uint16_t a, uint16_t b) { return a != c_notFound ? a : b; }
+
+  template <class T> constexpr uint16_t length() { return sizeof(T::symbols) / sizeof(T::symbols[0]); }
+
+  template <class T> constexpr bool isEnd(uint16_t k) { return T::symbols[k] == IR_SEQ_END; }
+
+  template <class T> constexpr uint8_t countEnds(uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && isEnd<T>(from)) : countEnds<T>(from, half(from, to)) + countEnds<T>(half(from, to), to);
+  }
+
+  template <class T> constexpr bool hasEmptySequence(uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && isEnd<T>(from) && (from == 0 || isEnd<T>(from - 1)))
+                          : hasEmptySequence<T>(from, half(from, to)) || hasEmptySequence<T>(half(from, to), to);
+  }
+
+  template <class T> constexpr bool hasInvalidCommand(uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && !isEnd<T>(from) && T::symbols[from] > 0xFF)
+                          : hasInvalidCommand<T>(from, half(from, to)) || hasInvalidCommand<T>(half(from, to), to);
+  }
+
+  // Are the keys ending at position j the same as the ones ending at position k? (keys from..to-1, counting back)
+  template <class T> constexpr bool sameKeys(uint16_t j, uint16_t k, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from >= to || T::symbols[j - from] == T::symbols[k - from])
+                          : sameKeys<T>(j, k, from, half(from, to)) && sameKeys<T>(j, k, half(from, to), to);
+  }
+
+  // Number of keys from the beginning of the sequence to position k (inclusive):
+  template <class T> constexpr uint8_t depthAt(uint16_t k) {
+    return (k == 0 || isEnd<T>(k - 1)) ? 1 : depthAt<T>(k - 1) + 1;
+  }
+
+  // Stage 1, for each position: the number of keys from the beginning of its sequence (0 for the ends).
+  template <class T, class I> struct Depths;
+  template <class T, uint16_t... I> struct Depths<T, Indices<I...>> {
+    static constexpr uint8_t at[sizeof...(I)] = { (isEnd<T>(I) ? (uint8_t)0 : depthAt<T>(I))... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t Depths<T, Indices<I...>>::at[sizeof...(I)];
+  template <class T> struct Depth : Depths<T, typename MakeIndices<length<T>()>::type> {};
+
+  // A position whose last n keys are the same as the last n keys up to position p (n is at most its depth):
+  template <class T> constexpr uint16_t findKeys(uint16_t p, uint8_t n, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && Depth<T>::at[from] == n && sameKeys<T>(from, p, 0, n)) ? from : c_notFound)
+                          : firstFound(findKeys<T>(p, n, from, half(from, to)), findKeys<T>(p, n, half(from, to), to));
+  }
+
+  // Stage 2, for each position: where the beginning of its sequence (up to it) appears for the first time.
+  template <class T, class I> struct FirstPositions;
+  template <class T, uint16_t... I> struct FirstPositions<T, Indices<I...>> {
+    static constexpr uint16_t at[sizeof...(I)] = { (isEnd<T>(I) ? (uint16_t)I : findKeys<T>(I, Depth<T>::at[I], 0, I + 1))... };
+  };
+  template <class T, uint16_t... I> constexpr uint16_t FirstPositions<T, Indices<I...>>::at[sizeof...(I)];
+  template <class T> struct First : FirstPositions<T, typename MakeIndices<length<T>()>::type> {};
+
+  template <class T> constexpr bool createsState(uint16_t k) { return !isEnd<T>(k) && First<T>::at[k] == k; }
+
+  template <class T> constexpr uint8_t statesIn(uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && createsState<T>(from)) : statesIn<T>(from, half(from, to)) + statesIn<T>(half(from, to), to);
+  }
+
+  // Stage 3, for each position: the state reached after its key (state 0 is the initial one).
+  template <class T, class I> struct StatePositions;
+  template <class T, uint16_t... I> struct StatePositions<T, Indices<I...>> {
+    static constexpr uint8_t at[sizeof...(I)] = { (isEnd<T>(I) ? (uint8_t)0 : (uint8_t)(1 + statesIn<T>(0, First<T>::at[I])))... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t StatePositions<T, Indices<I...>>::at[sizeof...(I)];
+  template <class T> struct StateAt : StatePositions<T, typename MakeIndices<length<T>()>::type> {};
+
+  template <class T> constexpr uint16_t stateCount() { return 1 + statesIn<T>(0, length<T>()); }
+
+  // Position that created state s:
+  template <class T> constexpr uint16_t positionOf(uint8_t s, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && createsState<T>(from) && StateAt<T>::at[from] == s) ? from : c_notFound)
+                          : firstFound(positionOf<T>(s, from, half(from, to)), positionOf<T>(s, half(from, to), to));
+  }
+
+  // State of the longest ending, with n keys or less, of the keys up to position p (found is where the n keys are):
+  template <class T> constexpr uint8_t stateOrShorter(uint16_t p, uint8_t n, uint16_t found) {
+    return found != c_notFound ? StateAt<T>::at[found]
+         : (n <= 1 ? 0 : stateOrShorter<T>(p, n - 1, findKeys<T>(p, n - 1, 0, length<T>())));
+  }
+
+  // Failure link: the state of the longest ending of the keys up to position p (not counting the whole beginning):
+  template <class T> constexpr uint8_t failureAt(uint16_t p) {
+    return Depth<T>::at[p] <= 1 ? 0 : stateOrShorter<T>(p, Depth<T>::at[p] - 1, findKeys<T>(p, Depth<T>::at[p] - 1, 0, length<T>()));
+  }
+
+  // Stage 4, for each state: its failure link.
+  template <class T, class I> struct FailureLinks;
+  template <class T, uint16_t... I> struct FailureLinks<T, Indices<I...>> {
+    static constexpr uint8_t of[sizeof...(I)] = { (I == 0 ? (uint8_t)0 : failureAt<T>(positionOf<T>(I, 0, length<T>())))... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t FailureLinks<T, Indices<I...>>::of[sizeof...(I)];
+  template <class T> struct Failure : FailureLinks<T, typename MakeIndices<stateCount<T>()>::type> {};
+
+  // Next state, if state s has a child with the given key (c_notFound otherwise):
+  template <class T> constexpr uint16_t child(uint8_t s, uint16_t key, uint16_t from, uint16_t to) {
+    return to - from <= 1
+         ? ((from < to && createsState<T>(from) && T::symbols[from] == key && (Depth<T>::at[from] == 1 ? 0 : StateAt<T>::at[from - 1]) == s)
+            ? StateAt<T>::at[from] : c_notFound)
+         : firstFound(child<T>(s, key, from, half(from, to)), child<T>(s, key, half(from, to), to));
+  }
+
+  // Next state after the key: the child of s or, if there's none, of the first state in its failure links that has one:
+  template <class T> constexpr uint8_t nextState(uint8_t s, uint16_t key, uint16_t next) {
+    return next != c_notFound ? next
+         : (s == 0 ? 0 : nextState<T>(Failure<T>::of[s], key, child<T>(Failure<T>::of[s], key, 0, length<T>())));
+  }
+
+  // Last position of a sequence that ends in state s:
+  template <class T> constexpr uint16_t endOf(uint8_t s, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && !isEnd<T>(from) && isEnd<T>(from + 1) && StateAt<T>::at[from] == s) ? from : c_notFound)
+                          : firstFound(endOf<T>(s, from, half(from, to)), endOf<T>(s, half(from, to), to));
+  }
+
+  // Sequence completed in state s, or 0xFF (with no sequence inside another, only the last state of a sequence has one):
+  template <class T> constexpr uint8_t completedAt(uint16_t end) { return end == c_notFound ? 0xFF : countEnds<T>(0, end); }
+
+  // Does another sequence end inside the sequence of position p, at p? (p is not the last position of its sequence)
+  template <class T> constexpr bool endsInside(uint16_t p, uint16_t from, uint16_t to) {
+    return to - from <= 1
+         ? (from < to && !isEnd<T>(from) && isEnd<T>(from + 1) && Depth<T>::at[from] <= Depth<T>::at[p] && sameKeys<T>(from, p, 0, Depth<T>::at[from]))
+         : endsInside<T>(p, from, half(from, to)) || endsInside<T>(p, half(from, to), to);
+  }
+
+  // Is the sequence that ends at position p the same as one before it? (first is the first position with its keys)
+  template <class T> constexpr bool isRepeated(uint16_t p, uint16_t first) { return first != p && isEnd<T>(first + 1); }
+
+  template <class T> constexpr bool badSequence(uint16_t from, uint16_t to) {
+    return to - from <= 1
+         ? (from < to && !isEnd<T>(from) && (isEnd<T>(from + 1) ? isRepeated<T>(from, First<T>::at[from]) : endsInside<T>(from, 0, length<T>())))
+         : badSequence<T>(from, half(from, to)) || badSequence<T>(half(from, to), to);
+  }
+
+  // Alphabet (the distinct keys used in the sequences, in order of appearance):
+  template <class T> constexpr uint16_t findKey(uint16_t key, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && T::symbols[from] == key) ? from : c_notFound)
+                          : firstFound(findKey<T>(key, from, half(from, to)), findKey<T>(key, half(from, to), to));
+  }
+
+  template <class T> constexpr bool isNewKey(uint16_t k) { return !isEnd<T>(k) && findKey<T>(T::symbols[k], 0, k) == c_notFound; }
+
+  template <class T> constexpr uint8_t newKeysIn(uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && isNewKey<T>(from)) : newKeysIn<T>(from, half(from, to)) + newKeysIn<T>(half(from, to), to);
+  }
+
+  template <class T> constexpr uint16_t keyCount() { return newKeysIn<T>(0, length<T>()); }
+
+  // Stage 5, for each position: the alphabet index of its key, if it's the first time it appears (or 0xFF).
+  template <class T, class I> struct KeyNumbers;
+  template <class T, uint16_t... I> struct KeyNumbers<T, Indices<I...>> {
+    static constexpr uint8_t at[sizeof...(I)] = { (isNewKey<T>(I) ? newKeysIn<T>(0, I) : (uint8_t)0xFF)... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t KeyNumbers<T, Indices<I...>>::at[sizeof...(I)];
+  template <class T> struct KeyNumber : KeyNumbers<T, typename MakeIndices<length<T>()>::type> {};
+
+  template <class T> constexpr uint16_t nthKey(uint8_t n, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && KeyNumber<T>::at[from] == n) ? T::symbols[from] : c_notFound)
+                          : firstFound(nthKey<T>(n, from, half(from, to)), nthKey<T>(n, half(from, to), to));
+  }
+
+  template <class T, class I> struct KeyTable;
+  template <class T, uint16_t... I> struct KeyTable<T, Indices<I...>> {
+    static constexpr uint8_t keys[sizeof...(I)] PROGMEM = { (uint8_t)nthKey<T>(I, 0, length<T>())... };
+  };
+  template <class T, uint16_t... I> constexpr uint8_t KeyTable<T, Indices<I...>>::keys[sizeof...(I)];
+  template <class T> struct Alphabet : KeyTable<T, typename MakeIndices<keyCount<T>()>::type> {};
+
+  // Perfect hash of the keys (h = key x multiplier, keeping the top bits of the low byte), as in the keymaps:
+  constexpr uint8_t multiplier(uint8_t seed) { return 2 * seed + 1; }
+
+  constexpr uint8_t slot(uint8_t key, uint8_t seed, uint8_t bits) {
+    return (uint8_t)(key * multiplier(seed)) >> (8 - bits);
+  }
+
+  constexpr uint8_t minBits(uint16_t n, uint8_t bits = 1) {
+    return ((uint16_t)1 << bits) >= n ? bits : minBits(n, bits + 1);
+  }
+
+  // Does key i share its slot with any of the keys from..to-1?
+  template <class T> constexpr bool collides(uint8_t seed, uint8_t bits, uint8_t i, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from < to && slot(Alphabet<T>::keys[i], seed, bits) == slot(Alphabet<T>::keys[from], seed, bits))
+                          : collides<T>(seed, bits, i, from, half(from, to)) || collides<T>(seed, bits, i, half(from, to), to);
+  }
+
+  template <class T> constexpr bool isPerfect(uint8_t seed, uint8_t bits, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? (from >= to || !collides<T>(seed, bits, from, 0, from))
+                          : isPerfect<T>(seed, bits, from, half(from, to)) && isPerfect<T>(seed, bits, half(from, to), to);
+  }
+
+  template <class T> constexpr uint16_t findSeed(uint8_t bits, uint8_t seed = 0) {
+    return seed >= c_maxSeeds ? c_notFound : (isPerfect<T>(seed, bits, 0, keyCount<T>()) ? seed : findSeed<T>(bits, seed + 1));
+  }
+
+  template <class T> constexpr uint8_t findBits(uint8_t bits) {  // 8 bits and multiplier 1 is always perfect
+    return (bits >= c_maxBits || findSeed<T>(bits) != c_notFound) ? bits : findBits<T>(bits + 1);
+  }
+
+  // Slot content (alphabet index + 1, or 0 if there's no key in that slot):
+  template <class T> constexpr uint16_t keyInSlot(uint16_t s, uint8_t seed, uint8_t bits, uint16_t from, uint16_t to) {
+    return to - from <= 1 ? ((from < to && slot(Alphabet<T>::keys[from], seed, bits) == s) ? from : c_notFound)
+                          : firstFound(keyInSlot<T>(s, seed, bits, from, half(from, to)), keyInSlot<T>(s, seed, bits, half(from, to), to));
+  }
+
+  constexpr uint8_t slotContent(uint16_t key) { return key == c_notFound ? 0 : key + 1; }
+
+  template <class T, uint8_t Seed, uint8_t Bits, class I> struct SlotTable;
+  template <class T, uint8_t Seed, uint8_t Bits, uint16_t... I> struct SlotTable<T, Seed, Bits, Indices<I...>> {
+    static const uint8_t slots[sizeof...(I)];
+  };
+  template <class T, uint8_t Seed, uint8_t Bits, uint16_t... I>
+  const uint8_t SlotTable<T, Seed, Bits, Indices<I...>>::slots[sizeof...(I)] PROGMEM = {
+    slotContent(keyInSlot<T>(I, Seed, Bits, 0, keyCount<T>()))... };
+
+  // Transition table (one row per state, one column per key):
+  template <class T, uint8_t Keys, class I> struct TransitionTable;
+  template <class T, uint8_t Keys, uint16_t... I> struct TransitionTable<T, Keys, Indices<I...>> {
+    static const uint8_t next[sizeof...(I)];
+  };
+  template <class T, uint8_t Keys, uint16_t... I>
+  const uint8_t TransitionTable<T, Keys, Indices<I...>>::next[sizeof...(I)] PROGMEM = {
+    nextState<T>(I / Keys, Alphabet<T>::keys[I % Keys], child<T>(I / Keys, Alphabet<T>::keys[I % Keys], 0, length<T>()))... };
+
+  // Sequence completed in each state (0xFF if none):
+  template <class T, class I> struct CompletedTable;
+  template <class T, uint16_t... I> struct CompletedTable<T, Indices<I...>> {
+    static const uint8_t completed[sizeof...(I)];
+  };
+  template <class T, uint16_t... I>
+  const uint8_t CompletedTable<T, Indices<I...>>::completed[sizeof...(I)] PROGMEM = {
+    completedAt<T>(endOf<T>(I, 0, length<T>()))... };
+}
+
+
+// ****************************************************************************
+/**
+ * Key sequence recognizer, created by the IR_SMALLD_SEQUENCES macro.
+ * Follows the keys of the decoded data and reports the sequences that are completed.
+ */
+template <class T> class IRsmallDSequences {
+  private:
+    static_assert(IRsmallDSequenceDetail::length<T>() >= 2 && T::symbols[IRsmallDSequenceDetail::length<T>() - 1] == IR_SEQ_END,
+                  "IR sequences: use IR_SEQ(...) to declare each sequence");
+    static_assert(!IRsmallDSequenceDetail::hasEmptySequence<T>(0, IRsmallDSequenceDetail::length<T>()), "IR sequences: empty sequence");
+    static_assert(!IRsmallDSequenceDetail::hasInvalidCommand<T>(0, IRsmallDSequenceDetail::length<T>()), "IR sequences: commands must be between 0x00 and 0xFF");
+    static_assert(IRsmallDSequenceDetail::countEnds<T>(0, IRsmallDSequenceDetail::length<T>()) <= 127, "IR sequences: too many sequences (maximum is 127)");
+    static_assert(IRsmallDSequenceDetail::stateCount<T>() <= 255, "IR sequences: too many keys (maximum is 254, in total)");
+    static_assert(!IRsmallDSequenceDetail::badSequence<T>(0, IRsmallDSequenceDetail::length<T>()),
+                  "IR sequences: a sequence is repeated, or contains another one (that isn't at its end)");
+
+    static const uint8_t  c_keys = IRsmallDSequenceDetail::keyCount<T>();
+    static const uint8_t  c_states = IRsmallDSequenceDetail::stateCount<T>();
+    static const uint8_t  c_bits = IRsmallDSequenceDetail::findBits<T>(IRsmallDSequenceDetail::minBits(c_keys));
+    static const uint8_t  c_seed = IRsmallDSequenceDetail::findSeed<T>(c_bits);
+    static const uint16_t c_repeatTime = 100;  // ms, for protocols without keyHeld
+    typedef IRsmallDSequenceDetail::SlotTable<T, c_seed, c_bits,
+            typename IRsmallDSequenceDetail::MakeIndices<(1 << c_bits)>::type> Slots;
+    typedef IRsmallDSequenceDetail::TransitionTable<T, c_keys,
+            typename IRsmallDSequenceDetail::MakeIndices<c_states * c_keys>::type> Transitions;
+    typedef IRsmallDSequenceDetail::CompletedTable<T,
+            typename IRsmallDSequenceDetail::MakeIndices<c_states>::type> Completed;
+
+    uint8_t  _state = 0;        // 0 = no key of a sequence yet
+    uint16_t _lastKeyTime = 0;  // millis(), low 16 bits
+
+  public:
+    int8_t update(const irSmallD_t &irData);
+    int8_t update(IRsmallDecoder &irDecoder);
+    bool inProgress();
+    void reset();
+};
+
+
+/**
+ * Follows the key of the decoded data and informs if it completed a sequence.
+ * Held keys (repetitions) and frames from other addresses are ignored.
+ *
+ * @param irData the decoded data (retrieved with the dataAvailable() method).
+ * @return the number of the completed sequence (in order of declaration, starting at 0), or IR_SEQ_NONE (-1).
+ */
+template <class T> int8_t IRsmallDSequences<T>::update(const irSmallD_t &irData) {
+  if (irData.addr != T::addr) return IR_SEQ_NONE;  // Another remote
+  uint16_t now = millis();
+  uint16_t elapsed = now - _lastKeyTime;
+  _lastKeyTime = now;
+  #if !defined(IR_SMALLD_HAS_KEYHELD)  // SIRC12/15/20 without IR_SMALLD_SIRC_KEYHELD
+    if (elapsed < c_repeatTime) return IR_SEQ_NONE;  // Too soon, it must be the same key
+  #else
+    if (irData.keyHeld) return IR_SEQ_NONE;
+  #endif
+  if (elapsed > T::timeout) _state = 0;  // Too late, start over
+
+  uint8_t s = IRsmallDSequenceDetail::slot(irData.cmd, c_seed, c_bits);
+  uint8_t key = pgm_read_byte(&Slots::slots[s]);
+  if (!key || pgm_read_byte(&IRsmallDSequenceDetail::Alphabet<T>::keys[key - 1]) != irData.cmd) {
+    _state = 0;  // Not used in any sequence
+    return IR_SEQ_NONE;
+  }
+  _state = pgm_read_byte(&Transitions::next[_state * c_keys + key - 1]);
+  int8_t completed = (int8_t)pgm_read_byte(&Completed::completed[_state]);
+  if (completed != IR_SEQ_NONE) _state = 0;
+  return completed;
+}
+
+
+/**
+ * Retrieves the decoded data, if available, and follows its key.
+ *
+ * @param irDecoder the decoder to check.
+ * @return the number of the completed sequence, or IR_SEQ_NONE (-1).
+ */
+template <class T> int8_t IRsmallDSequences<T>::update(IRsmallDecoder &irDecoder) {
+  irSmallD_t irData;
+  return irDecoder.dataAvailable(irData) ? update(irData) : IR_SEQ_NONE;
+}
+
+
+/**
+ * Informs if some keys of a sequence were pressed, and the time for the next one has not expired
+ * (e.g. to show that a code is being entered).
+ */
+template <class T> bool IRsmallDSequences<T>::inProgress() {
+  return _state && (uint16_t)((uint16_t)millis() - _lastKeyTime) <= T::timeout;
+}
+
+
+/**
+ * Discards the keys pressed so far.
+ */
+template <class T> void IRsmallDSequences<T>::reset() {
+  _state = 0;
+}
+
+#endif
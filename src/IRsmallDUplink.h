@@ -0,0 +1,189 @@
+/* IRsmallDUplink - Binary frame uplink (sends the decoded data to a host computer, in batches)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Usage (after the #include <IRsmallDecoder.h>):
+ *
+ *   #include <IRsmallDUplink.h>
+ *
+ *   IRsmallDUplink uplink(Serial, 100);  // any Print (Serial, Serial1, ...), and the maximum delay of a record (ms)
+ *
+ *   void loop() {
+ *     uplink.poll(irDecoder);  // or: if (irDecoder.dataAvailable(irData)) uplink.add(irData);  ...  uplink.flush();
+ *   }
+ *
+ * Each decoded frame becomes a fixed size record (protocol, addr, cmd, ext, keyHeld and time, 10 bytes) and the
+ * records are sent in batches, as COBS framed packets with a CRC (see IRsmallDUplinkFormat.h). A batch is sent
+ * when it's full, or by poll(), when its first record waited for the maximum delay and the decoder is idle (between
+ * frames). A frame sent as text (e.g. "45\t0\t1\r\n" with Serial.print) costs several print calls and a number
+ * conversion per member; here, it's a few bytes copied to a buffer, and one write() per batch.
+ *
+ * The host side parser, and the iruplink tool that prints the received frames, are in extras/HostTools.
+ *
+ * Notes:
+ *   - IR_SMALLD_UPLINK_BATCH sets the number of records per packet (default 8, maximum 25). The buffer has
+ *     IR_SMALLD_UPLINK_BATCH x 10 + 6 bytes;
+ *   - A batch is sent with a single write(), so it's best if the serial TX buffer can hold it (64 bytes on most
+ *     AVR boards: up to 5 records). Otherwise, write() waits until the rest of the packet fits in the buffer;
+ *   - The first packet is preceded by a 0x00 delimiter, so that a host that was already listening (e.g. when the
+ *     board is reset) doesn't join it with the bytes sent before.
+ */
+
+#ifndef IRsmallD_Uplink_h
+#define IRsmallD_Uplink_h
+
+#if !defined(IRsmallDecoder_h)
+  #error IRsmallDUplink.h must be included after IRsmallDecoder.h
+#endif
+
+#include "IRsmallDUplinkFormat.h"
+
+#if !defined(IR_SMALLD_UPLINK_BATCH)
+  #define IR_SMALLD_UPLINK_BATCH 8
+#elif IR_SMALLD_UPLINK_BATCH < 1 || IR_SMALLD_UPLINK_BATCH > IR_UPLINK_MAX_RECORDS
+  #error IR_SMALLD_UPLINK_BATCH must be between 1 and 25
+#endif
+
+
+// ****************************************************************************
+/**
+ * Uplink class: collects the decoded frames and sends them to the output in binary packets.
+ */
+class IRsmallDUplink {
+  private:
+    Print &_output;
+    uint16_t _maxDelay;      // ms
+    uint16_t _firstTime;     // millis() when the first record of the batch was added
+    uint8_t  _count;         // records in the batch
+    uint8_t  _sequence;
+    bool     _started;       // the first delimiter was sent
+    // COBS overhead byte, seq, count, records, CRC and delimiter:
+    uint8_t  _packet[1 + 2 + IR_SMALLD_UPLINK_BATCH * IR_UPLINK_RECORD_SIZE + 2 + 1];
+
+  public:
+    IRsmallDUplink(Print &output, uint16_t maxDelay = 0);
+    void add(const irSmallD_t &irData);     // sends the batch when it's full
+    void flush();                           // sends the batch (if it's not empty)
+    void flushIfDue();                      // sends the batch if its first record waited for maxDelay ms
+    bool poll(IRsmallDecoder &irDecoder);   // adds the decoder's data, if any, and sends the batch when it's due
+    uint8_t pending() { return _count; }    // records waiting to be sent
+};
+
+
+/**
+ * Constructor.
+ *
+ * @param output where the packets are written (usually Serial).
+ * @param maxDelay maximum time (ms) that poll() keeps a record in the batch, waiting for more; with 0, a record is
+ *                 sent as soon as the decoder is idle.
+ */
+IRsmallDUplink::IRsmallDUplink(Print &output, uint16_t maxDelay)
+    : _output(output), _maxDelay(maxDelay), _firstTime(0), _count(0), _sequence(0), _started(false) {}
+
+
+/**
+ * Adds the decoded data to the batch, and sends the batch if it's full.
+ *
+ * @param irData the decoded data (retrieved with the dataAvailable() method).
+ */
+void IRsmallDUplink::add(const irSmallD_t &irData) {
+  if (!_count) _firstTime = millis();
+
+  uint8_t *record = &_packet[3 + _count * IR_UPLINK_RECORD_SIZE];
+  uint8_t flags = 0;
+  #if defined(IR_SMALLD_HASH)
+    uint16_t addr = irData.hash;
+    uint8_t cmd = irData.hash >> 16;
+    uint8_t ext = irData.hash >> 24;
+  #else
+    uint16_t addr = irData.addr;
+    uint8_t cmd = irData.cmd;
+    #if defined(IR_SMALLD_SIRC20) || defined(IR_SMALLD_SIRC)
+      uint8_t ext = irData.ext;
+    #else
+      uint8_t ext = 0;
+    #endif
+  #endif
+  #if defined(IR_SMALLD_HAS_KEYHELD)
+    flags = IR_UPLINK_HAS_HELD | (irData.keyHeld ? IR_UPLINK_HELD : 0);
+  #endif
+  #if defined(IR_SMALLD_TIMESTAMPS)
+    uint32_t time = irData.time;
+    flags |= IR_UPLINK_FRAME_TIME;
+  #else
+    uint32_t time = micros();
+  #endif
+
+  record[0] = IR_SMALLD_PROTOCOL_ID;
+  record[1] = flags;
+  record[2] = addr;
+  record[3] = addr >> 8;
+  record[4] = cmd;
+  record[5] = ext;
+  record[6] = time;
+  record[7] = time >> 8;
+  record[8] = time >> 16;
+  record[9] = time >> 24;
+  if (++_count == IR_SMALLD_UPLINK_BATCH) flush();
+}
+
+
+/**
+ * Sends the batch, as a single packet (nothing is sent if it's empty).
+ */
+void IRsmallDUplink::flush() {
+  if (!_count) return;
+  if (!_started) {
+    _output.write((uint8_t)0);
+    _started = true;
+  }
+  _packet[1] = _sequence++;
+  _packet[2] = _count;
+  uint16_t end = 3 + _count * IR_UPLINK_RECORD_SIZE;  // (a full batch of 25 records takes 256 bytes, delimiter included)
+  uint16_t crc = irUplinkCrc16(&_packet[1], end - 1);
+  _packet[end++] = crc;
+  _packet[end++] = crc >> 8;
+
+  // COBS, in place: each zero (and the overhead byte at [0]) gets the distance to the next zero, or to the end
+  // (there are at most 254 bytes after the overhead byte, so it's a single block):
+  uint16_t last = 0;
+  for (uint16_t i = 1; i < end; i++) {
+    if (!_packet[i]) {
+      _packet[last] = i - last;
+      last = i;
+    }
+  }
+  _packet[last] = end - last;
+  _packet[end++] = 0;  // Delimiter
+
+  _output.write(_packet, end);
+  _count = 0;
+}
+
+
+/**
+ * Sends the batch if its first record waited for the maximum delay (given to the constructor).
+ */
+void IRsmallDUplink::flushIfDue() {
+  if (_count && (uint16_t)((uint16_t)millis() - _firstTime) >= _maxDelay) flush();
+}
+
+
+/**
+ * Adds the decoded data to the batch, if available, and sends the batch if the decoder is idle (no frame is being
+ * received) and the batch is due (see flushIfDue()).
+ *
+ * @param irDecoder the decoder to check.
+ * @return true if new data was added; false if not.
+ */
+bool IRsmallDUplink::poll(IRsmallDecoder &irDecoder) {
+  irSmallD_t irData;
+  bool available = irDecoder.dataAvailable(irData);
+  if (available) add(irData);
+  if (irDecoder.isIdle()) flushIfDue();
+  return available;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/* IRsmallDUplinkFormat - Packet format of the binary uplink (IRsmallDUplink.h)
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * Packet (before the COBS encoding):
+ *   seq | count | count x record | CRC
+ *     seq    - packet number (uint8_t, incremented for each packet, so that the host can count lost packets);
+ *     count  - number of records (1 to IR_UPLINK_MAX_RECORDS);
+ *     CRC    - CRC-16/CCITT-FALSE of seq, count and the records (uint16_t, little-endian).
+ *
+ * Record (IR_UPLINK_RECORD_SIZE bytes, multi-byte values are little-endian):
+ *   offset 0  protocol  - IR_SMALLD_PROTOCOL_ID of the decoder (see IRsmallDProtocolIDs.h);
+ *   offset 1  flags     - IR_UPLINK_HELD, IR_UPLINK_HAS_HELD and IR_UPLINK_FRAME_TIME (below);
+ *   offset 2  addr      - uint16_t (the HASH decoder sends the low 16 bits of the hash);
+ *   offset 4  cmd       - uint8_t  (HASH: bits 16-23 of the hash);
+ *   offset 5  ext       - uint8_t, 0 if the protocol has no ext (HASH: bits 24-31 of the hash);
+ *   offset 6  time      - uint32_t, micros() of the frame's last edge (with IR_SMALLD_TIMESTAMPS) or of the moment
+ *                         the record was added.
+ *
+ * Framing:
+ *   Each packet is COBS encoded (Consistent Overhead Byte Stuffing: the zeros are replaced by the distance to the
+ *   next one, plus one byte at the start) and followed by a 0x00 delimiter, so a receiver that starts listening in
+ *   the middle of a packet only loses that one. A packet is never longer than 254 bytes, so the encoding always
+ *   adds exactly one byte: with the delimiter, the overhead is 6 bytes per packet.
+ *
+ * Notes:
+ *   - This file does not depend on the protocol selection, so it can be included on its own (e.g. by the host
+ *     side parser in extras/HostTools).
+ */
+
+#ifndef IRsmallD_UplinkFormat_h
+#define IRsmallD_UplinkFormat_h
+
+  #define IR_UPLINK_RECORD_SIZE   10
+  #define IR_UPLINK_MAX_RECORDS   25    // 2 + 25 x 10 + 2 = 254 bytes (a single COBS block)
+  #define IR_UPLINK_MAX_PACKET    (2 + IR_UPLINK_MAX_RECORDS * IR_UPLINK_RECORD_SIZE + 2)
+
+  // Record flags:
+  #define IR_UPLINK_HELD          0x01  // keyHeld was true
+  #define IR_UPLINK_HAS_HELD      0x02  // the protocol's data has keyHeld (otherwise, IR_UPLINK_HELD is always 0)
+  #define IR_UPLINK_FRAME_TIME    0x04  // time is the frame's time (IR_SMALLD_TIMESTAMPS), not the time it was sent
+
+  // CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), bit by bit (no table, to save flash):
+  static inline uint16_t irUplinkCrc16(const uint8_t *data, uint8_t length) {
+    uint16_t crc = 0xFFFF;
+    while (length--) {
+      crc ^= (uint16_t)*data++ << 8;
+      for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+#endif
@@ -0,0 +1,107 @@
+/* IRsmallD_HASH - Universal (hash based) decoder for unknown protocols
+ *
+ * This file is part of the IRsmallDecoder library for Arduino
+ * Copyright (c) 2020 Luis Carvalho
+ *
+ *
+ * How it works:
+ * -------------
+ * This decoder doesn't know anything about the protocol. It's meant for remotes that aren't supported
+ * by the other decoders (air conditioners, no-name devices, etc.), and it only uses the durations of the
+ * intervals between consecutive edges of the signal.
+ *
+ * Each interval is compared with the previous one and classified as shorter (0), similar (1) or longer (2).
+ * The result is then folded into a 32-bit FNV-1 hash:  hash = (hash x FNV_PRIME) XOR result.
+ * Since only the relative lengths matter, the same key produces the same hash, even if the remote's timings
+ * are a bit off, and different keys produce different sequences of intervals (and therefore different hashes).
+ * The hash value is meaningless on its own, but it can be "learned" and bound to an action.
+ *
+ * A frame ends when there's a gap of at least HASH_GAP_MIN without any edges. The hash is published
+ * by the timeout mechanism (when dataAvailable() is called) or by the first edge of the next frame.
+ * The timeout resets the FSM after the gap has started, so the gap is remembered (gapSeen) and the next
+ * edge starts a frame, even if it comes less than HASH_GAP_MIN after the reset (e.g. 45ms SIRC repetitions).
+ * There's no buffering: only the previous interval, the hash and an interval counter are kept.
+ *
+ * Notes:
+ *   - Frames with fewer than HASH_MIN_COUNT intervals are considered noise and ignored;
+ *   - Intervals shorter than HASH_MIN_INTERVAL are glitches, the frame is discarded;
+ *   - Protocols that send frames in sections (separated by long spaces) will produce one hash per section;
+ *   - Short repetition codes (like NEC's, with 3 intervals) have fewer than HASH_MIN_COUNT intervals, so they
+ *     are ignored: a held key is only reported by remotes that repeat the whole frame.
+ */
+
+
+// HASH decoder parameters:
+#define HASH_GAP_MIN      IR_SMALLD_TIMEOUT  /* Minimum gap between frames (µs) */
+#define HASH_MIN_INTERVAL 100                /* Shortest valid interval (µs) */
+#define HASH_MIN_COUNT    6                  /* Minimum number of intervals per frame */
+#define FNV_PRIME_32      16777619UL
+#define FNV_BASIS_32      2166136261UL
+
+#if IR_SMALLD_JITTER >= HASH_MIN_INTERVAL
+  #error The HASH decoder requires a sample period shorter than HASH_MIN_INTERVAL (50µs or less is recommended)
+#endif
+
+
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the IR receiver's output signal level.
+
+  // HASH thresholds in microseconds:
+  const uint16_t c_GapMin = HASH_GAP_MIN;
+  const uint16_t c_IntMin = HASH_MIN_INTERVAL - IR_SMALLD_JITTER;
+
+  // FSM variables:
+  static uint32_t duration;
+  static uint16_t prevDuration;
+  static uint32_t hash;
+  static uint8_t  intervalCount;
+  static bool     gapSeen;  // The FSM was reset after a gap (by the timeout), so the next edge starts a frame
+
+  DBG_RESTART_TIMER();
+
+  duration = IR_ISR_MICROS() - _previousTime;
+  _previousTime = IR_ISR_MICROS();
+  DBG_PRINTLN_DUR(duration);
+
+  switch (_state) {  // Asynchronous (event-driven) Finite State Machine
+    case 0:  // Standby:
+      if (duration >= c_GapMin || gapSeen) {  // Only starts after a gap without signals
+        gapSeen = false;
+        hash = FNV_BASIS_32;
+        intervalCount = 0;
+        TS_FRAME_START();
+        _state = 1;
+      }
+    break;
+
+    case 1:  // Receiving:
+      if (duration >= c_GapMin) {  // End of frame (this edge is already the beginning of the next one)
+        if (intervalCount >= HASH_MIN_COUNT && !_irCopyingData) {  // If not noise and not interrupting a copy
+          _irData.hash = hash;
+          TS_FRAME_END(_previousTime - duration);  // The frame ended on the previous edge
+          _irDataAvailable = true;
+        }
+        hash = FNV_BASIS_32;
+        intervalCount = 0;
+        TS_FRAME_START();
+      }
+      else if (duration < c_IntMin) {  // Error: glitch, or the second ISR call of resetFSM()
+        gapSeen = (intervalCount == 0);  // Right after a gap (the first call), the gap is still valid
+        _state = 0;
+      }
+      else {
+        if (intervalCount) {  // Compare with the previous interval (using 16 bit arithmetic, 0.8 ≈ 1/1.25):
+          uint8_t value;
+          if ((uint16_t)duration + (uint16_t)duration / 4 < prevDuration) value = 0;  // Shorter
+          else if (prevDuration + prevDuration / 4 < (uint16_t)duration) value = 2;   // Longer
+          else value = 1;                                                             // Similar
+          hash = (hash * FNV_PRIME_32) ^ value;
+        }
+        prevDuration = duration;
+        if (intervalCount < UINT8_MAX) intervalCount++;
+      }
+    break;
+  }
+
+  DBG_PRINTLN_TIMER();
+  DBG_PRINT_STATE(_state);
+}
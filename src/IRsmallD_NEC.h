@@ -41,102 +41,135 @@
 #define NEC_R_TOL   803.6   /* Repeat Mark tolerance (µs) */
 #define NEC_MARK_0  1125    /* Bit 0 Mark */
 #define NEC_MARK_1  2250    /* Bit 1 Mark */
+#define NEC_L_PULSE 9000    /* Leading pulse (of the frames and repeat codes) */
+#define NEC_PULSE    562.5  /* Pulse of the other marks */
 #if defined(IR_SMALLD_NEC)  /* Gap1 (interval before first repeat mark) varies with the protocol */ 
   #define NEC_GAP_1 48937.5 /* Gap1 for NEC */
 #else                       /* If it's NECx, it does not have a constant address frame length: */
   #define NEC_GAP_1 39937.5 /* Gap1 is smallest when addr=FFFF; Gap1 = 48937.5 - (8 x 1125) = 39937.5 */  
 #endif
 #define NEC_GAP_2 105187.5  /* Gap2 (between repeat marks) */
+#define NEC_PERIOD  108000  /* Repetition period (from a frame, or repeat code, to the next repeat code) */
 // For more information about these timings, go to:
 // https://github.com/LuisMiCa/IRsmallDecoder/blob/master/extras/Timings/NEC_timings.svg
 
 
-void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
   // The signal goes LOW when IR light is detected (so the rising edge marks the end of an IR pulse).
 
   // NEC timings' thresholds in microseconds:
-  const uint16_t c_GapMin = NEC_GAP_1 * 0.7;        // 34256 (or 27956 for NECx)
-  const uint32_t c_GapMax = NEC_GAP_2 * 1.3;        //136743
-  const uint16_t c_RMmin = NEC_R_MARK * 0.7;        //  1968
-  const uint16_t c_RMmax = NEC_R_MARK + NEC_R_TOL;  //  3616
-  const uint16_t c_LMmin = c_RMmax + 1;             //  3617
-  const uint16_t c_LMmax = NEC_L_MARK * 1.3;        //  6581
-  const uint16_t c_M1min = NEC_MARK_1 * 0.7;        //  1575
-  const uint16_t c_M1max = NEC_MARK_1 * 1.3;        //  2925
-  const uint16_t c_M0min = NEC_MARK_0 * 0.7;        //   787
+  const uint16_t c_GapMin = NEC_GAP_1 * 0.7 - IR_SMALLD_JITTER;  // 34256 (or 27956 for NECx)
+  const uint32_t c_GapMax = NEC_GAP_2 * 1.3 + IR_SMALLD_JITTER;  //136743
+  const uint16_t c_RMmin = NEC_R_MARK * 0.7 - IR_SMALLD_JITTER;  //  1968
+  const uint16_t c_RMmax = NEC_R_MARK + NEC_R_TOL;               //  3616
+  const uint16_t c_LMmin = c_RMmax + 1;                          //  3617
+  const uint16_t c_LMmax = NEC_L_MARK * 1.3 + IR_SMALLD_JITTER;  //  6581
+  const uint16_t c_M1min = NEC_MARK_1 * 0.7;                     //  1575
+  const uint16_t c_M1max = NEC_MARK_1 * 1.3 + IR_SMALLD_JITTER;  //  2925
+  const uint16_t c_M0min = NEC_MARK_0 * 0.7 - IR_SMALLD_JITTER;  //   787
 
   //number of initial repetition marks to be ignored:
   const uint8_t c_RptCount = 2;
 
+  #if defined(IR_SMALLD_DUAL_EDGE)  // Pulses (and the spaces of the bit marks):
+    const uint16_t c_LPmin = NEC_L_PULSE * 0.7 - IR_SMALLD_JITTER;  //  6300
+    const uint16_t c_LPmax = NEC_L_PULSE * 1.3 + IR_SMALLD_JITTER;  // 11700
+    const uint16_t c_Pmin  = NEC_PULSE * 0.5 - IR_SMALLD_JITTER;    //   281
+    const uint16_t c_Pmax  = NEC_PULSE * 1.5 + IR_SMALLD_JITTER;    //   843
+    const uint16_t c_Smin  = NEC_PULSE * 0.5 - IR_SMALLD_JITTER;    //   281 (bit 0 space is 562.5, bit 1 is 1687.5)
+  #endif
+  #if defined(IR_SMALLD_HOLD_GATE)
+    const uint32_t c_PeriodMin = NEC_PERIOD * 0.9 - IR_SMALLD_JITTER;  // 97200 (10% below standard value)
+  #endif
+
   // FSM variables:
-  static uint32_t duration;
+  static irDuration_t duration;
   static uint8_t bitCount;
-  static union {            // Received bits are stored in reversed order (11000101... -> ...10100011)
-    uint32_t all = 0;       // Arduino uses Little Endian so, if all=ABCDEF89 then in memory it's 89EFCDAB (hex format)
-    uint8_t byt[4];         // and we get byt[0]=89, byt[1]=EF, byt[2]=CD and byt[3]=AB (type punning with a union...)
-  } irSignal;
-  static uint8_t repeatCount = 0;
-  static bool possiblyHeld = false;
+  static uint8_t irSignal[4];  // Filled byte by byte, LSB first: address, inverted address (NECx: high address byte),
+                               // command and inverted command (so, no 32-bit shifts and no type punning)
+  static struct {              // FSM flags, packed in a single byte:
+    uint8_t repeatCount  : 2;  // up to c_RptCount
+    bool    possiblyHeld : 1;
+  } flags;                     // (zero-initialized, as all statics)
+  IR_GATE_VARIABLES();
 
   DBG_RESTART_TIMER();
 
-  duration = micros() - _previousTime;  // Note: micros() has a 4μs resolution (multiples of 4) @ 16MHz or 8μs @ 8MHz
-  _previousTime = micros();
+  IR_DUAL_EDGE(c_LPmax);
+  IR_MEASURE_GATED(duration);  // Note: micros() has a 4μs resolution (multiples of 4) @ 16MHz or 8μs @ 8MHz
   DBG_PRINTLN_DUR(duration);
 
   switch (_state) {  // Asynchronous (event-driven) Finite State Machine
     case 0:  // Standby:
-      if (duration > c_GapMin) {
-        if (duration > c_GapMax) possiblyHeld = false;
+      IR_GATE_OPEN();
+      if (duration > c_GapMin && !IR_PULSE_OUTSIDE(c_LPmin, c_LPmax)) {  // After the leading pulse
+        if (IR_DURATION_ABOVE(duration, c_GapMax)) flags.possiblyHeld = false;
+        TS_FRAME_START();
+        SQ_FRAME_START();
         _state = 1;
       } 
-      else possiblyHeld = false;
+      else flags.possiblyHeld = false;
     break;
 
     case 1:  // StartPulse:
-      if (duration >= c_LMmin && duration <= c_LMmax) {  // It's a Leading Mark
+      if (IR_PULSE_OUTSIDE(c_Pmin, c_Pmax)) _state = 0;   // Error: not a mark's pulse
+      else if (duration >= c_LMmin && duration <= c_LMmax) {  // It's a Leading Mark
         bitCount = 0;
-        repeatCount = 0;
+        flags.repeatCount = 0;
         _state = 2;
       } else {
-        if (possiblyHeld && duration >= c_RMmin && duration <= c_RMmax) {  // It's a Repeat Mark
-          if (repeatCount < c_RptCount) repeatCount++;  // First repeat signals will be ignored
-          else if (!_irCopyingData) {                   // If not interrupting a copy, then a key was held
+        if (flags.possiblyHeld && duration >= c_RMmin && duration <= c_RMmax) {  // It's a Repeat Mark
+          SQ_MARK(duration, NEC_R_MARK, c_RMmin, c_RMmax);  // It's the only mark of a keyHeld frame
+          if (flags.repeatCount < c_RptCount) {  // First repeat signals will be ignored
+            flags.repeatCount++;
+            DBG_PRINT_STATE("\nREPEAT IGNORED\n");
+          } else if (!_irCopyingData) {                   // If not interrupting a copy, then a key was held
             _irData.keyHeld = true;
+            TS_FRAME_END(_previousTime);
+            SQ_FRAME_END();
             _irDataAvailable = true;
           }
+          IR_GATE_CLOSE(c_PeriodMin, c_GapMin);  // The next repeat mark can't come earlier
         }
         _state = 0;
       }
     break;
 
     case 2:  // Receiving:
-      if (duration < c_M0min || duration > c_M1max) _state = 0;  // Error: not a bit mark
+      if (duration < c_M0min || duration > c_M1max ||                 // Error: not a bit mark
+          IR_PULSE_OUTSIDE(c_Pmin, c_Pmax) || IR_SPACE_OUTSIDE(duration, c_Smin, c_M1max)) _state = 0;
       else {                 // It's M0 or M1
-        irSignal.all >>= 1;  // Push a 0 from left to right (will be left at 0 if it's M0)
-        if (duration >= c_M1min) irSignal.byt[3] |= 0x80;  // It's M1, change MSB to 1
+        uint8_t &irByte = irSignal[bitCount >> 3];
+        irByte >>= 1;                              // Push a 0 from left to right (will be left at 0 if it's M0)
+        if (duration >= c_M1min) irByte |= 0x80;   // It's M1, change MSB to 1
+        SQ_BIT(duration, c_M0min, NEC_MARK_0, c_M1min, NEC_MARK_1, c_M1max);
         bitCount++;
-        #if defined(IR_SMALLD_NEC)  // Conditional code inclusion (resolved at compile time)
-          if (bitCount == 16) {     // Address and Inverted Address received
-            if (irSignal.byt[2] != (uint8_t)~irSignal.byt[3]) _state = 0;  // Address error
+        #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_ADDRESS_FILTER)  // Conditional code inclusion (resolved at compile time)
+          if (bitCount == 16) {     // Address and Inverted Address received (NECx: 16 bit address received)
+            #if defined(IR_SMALLD_NEC)
+              if (irSignal[0] != (uint8_t)~irSignal[1]) _state = 0;  // Address error
+              else if (!ADDRESS_ALLOWED(irSignal[0])) { _state = 0; flags.possiblyHeld = false; }  // Another device's remote
+            #else
+              if (!ADDRESS_ALLOWED(irSignal[0] | (uint16_t)irSignal[1] << 8)) { _state = 0; flags.possiblyHeld = false; }
+            #endif
             // Else, remain in this state (Address OK, continue with command reception)
           }
           else   // That's right, a loose else...
         #endif
         if (bitCount == 32) {  // All bits received
-          if (!_irCopyingData && (irSignal.byt[2] == (uint8_t)~irSignal.byt[3])) {  // If not interrupting a copy and command OK, finish decoding
+          if (!_irCopyingData && (irSignal[2] == (uint8_t)~irSignal[3])) {  // If not interrupting a copy and command OK, finish decoding
             #if defined(IR_SMALLD_NEC)  // NEC address has 8 bits
-              _irData.addr = irSignal.byt[0];
+              _irData.addr = irSignal[0];
             #else  // it must be IR_SMALLD_NECx (16 bits)
-              _irData.addr = *(uint16_t*)(&irSignal.byt[0]);  // Type punning with a cast...
-              // .addr is the 16 bit value pointed by the address of byt[0]  (byt[1] is addr high byte)
-              // Dereferencing type-punned pointer will break strict-aliasing rules
-              // Usually tolerated by AVR-GCC, but may not work on other compilers
+              _irData.addr = irSignal[0] | (uint16_t)irSignal[1] << 8;
             #endif
-            _irData.cmd = irSignal.byt[2];
+            _irData.cmd = irSignal[2];
             _irData.keyHeld = false;
+            TS_FRAME_END(_previousTime);
+            SQ_FRAME_END();
             _irDataAvailable = true;
-            possiblyHeld = true;  // Will remain true if the next gap is OK
+            flags.possiblyHeld = true;  // Will remain true if the next gap is OK
+            IR_GATE_CLOSE(c_PeriodMin, c_GapMin);
           }
           _state = 0;
         }
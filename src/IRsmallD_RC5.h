@@ -26,42 +26,45 @@
  */
 
 
-void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the IR receiver's output signal level.
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the IR receiver's output signal level.
   // Due to INPUT_PULLUP mode, the signal goes LOW when IR light is detected (i.e., it is inverted).
 
   // RC5 timings in micro secs:
-  const uint32_t c_rptPmax   = 113792 * 1.2;  // Repetition period upper threshold (20% above standard)
-  const uint32_t c_gapMin    = 88900 * 0.8;   // Lower threshold of the gap between 2 signals (20% below standard)
+  const uint32_t c_rptPmax   = 113792 * 1.2 + IR_SMALLD_JITTER;  // Repetition period upper threshold (20% above standard)
+  const uint32_t c_gapMin    = 88900 * 0.8 - IR_SMALLD_JITTER;   // Lower threshold of the gap between 2 signals (20% below standard)
   const uint16_t c_bitPeriod = 1778;
-  const uint16_t c_tolerance = 444;                            // Maximum tolerance is 1778/4 = 444.5
-  const uint16_t c_longMax   = c_bitPeriod + c_tolerance;      // 1778 + 444 = 2222
-  const uint16_t c_shortMax  = c_bitPeriod / 2 + c_tolerance;  // 1778/2+444 = 1333
-  const uint16_t c_shortMin  = c_bitPeriod / 2 - c_tolerance;  // 1778/2-444 =  445
+  const uint16_t c_tolerance = 444;                                               // Maximum tolerance is 1778/4 = 444.5
+  const uint16_t c_longMax   = c_bitPeriod + c_tolerance + IR_SMALLD_JITTER;      // 1778 + 444 = 2222
+  const uint16_t c_shortMax  = c_bitPeriod / 2 + c_tolerance;                     // 1778/2+444 = 1333
+  const uint16_t c_shortMin  = c_bitPeriod / 2 - c_tolerance - IR_SMALLD_JITTER;  // 1778/2-444 =  445
 
   // Number of initial repetitions to be ignored:
   const uint8_t c_rptCount = 2;
 
   // FSM variables:
-  static uint32_t duration;
+  static irDuration_t duration;
   static uint8_t  bitCount;
   static uint16_t irSignal;            // Only 14 bits used
-  static bool     prevToggle = false;  // Used to convert Toggle to Held
-  static uint8_t  repeatCount = 0;
+  static struct {                      // FSM flags, packed in a single byte:
+    uint8_t repeatCount : 2;           // up to c_rptCount
+    bool    prevToggle  : 1;           // Used to convert Toggle to Held
+  } flags;                             // (zero-initialized, as all statics)
   static uint32_t lastBitTime = 0;     // For the repeat code confirmation
 
   FSM_INITIALIZE(st_standby);  // Initialize the "hidden" variable fsm_state (only once)
 
   DBG_RESTART_TIMER();
-  duration = micros() - _previousTime;
-  _previousTime = micros();
+  IR_MEASURE_DURATION(duration);
   DBG_PRINTLN_DUR(duration);
 
   FSM_SWITCH(){  // Asynchronous (event-driven) Finite State Machine, implemented with computed GOTOs
     // ====> States: st_standby, st_roseInSync, st_roseOffSync, st_fellInSync, st_fellOffSync
     st_standby:  // State 0
-      if (duration >= c_gapMin) {  //start pulse detected. It's very unlikely that a non-start pulse will be longer than c_gapMin
+      if (IR_DURATION_ABOVE(duration, c_gapMin - 1)) {  //start pulse detected. It's very unlikely that a non-start pulse will be longer than c_gapMin
         bitCount = 0;
         irSignal = 0;
+        TS_FRAME_START();
+        SQ_FRAME_START();
         FSM_NEXT(st_roseInSync);
         DBG_PRINT_STATE(1);
       }
@@ -70,15 +73,20 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the
     st_roseInSync:  // State 1
       irSignal <<= 1; irSignal += 1;  // push Bit 1 (from right to left)
       bitCount++;
-      if(duration < c_shortMin || duration > c_longMax){      //error
+      if(duration < c_shortMin || duration > c_longMax ||     //error (or, after the 5 address bits,
+         (bitCount == 8 && !ADDRESS_ALLOWED(irSignal & 0x1F))){  // another device's remote)
         FSM_NEXT(st_standby);
         DBG_PRINT_STATE(0);
       }
       else if(duration <= c_shortMax) {                       //it's Short
+        SQ_MARK(duration, c_bitPeriod / 2, c_shortMin, c_shortMax);
         FSM_NEXT(st_fellOffSync); 
         DBG_PRINT_STATE(4);
       }
-      else FSM_DIRECTJUMP(ps_roseChoice);                     //it's Long
+      else {                                                  //it's Long
+        SQ_MARK(duration, c_bitPeriod, c_shortMax + 1, c_longMax);
+        FSM_DIRECTJUMP(ps_roseChoice);
+      }
     break;
     
     st_roseOffSync:  // State 2
@@ -86,21 +94,29 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the
         FSM_NEXT(st_standby);
         DBG_PRINT_STATE(0);
       }
-      else FSM_DIRECTJUMP(ps_roseChoice);                     //it's Short
+      else {                                                  //it's Short
+        SQ_MARK(duration, c_bitPeriod / 2, c_shortMin, c_shortMax);
+        FSM_DIRECTJUMP(ps_roseChoice);
+      }
     break;
       
     st_fellInSync:  // State 3
       irSignal <<= 1;  // push Bit 0 (from right to left)
       bitCount++;
-      if (duration < c_shortMin || duration > c_longMax) {    //error
+      if (duration < c_shortMin || duration > c_longMax ||    //error (or, after the 5 address bits,
+          (bitCount == 8 && !ADDRESS_ALLOWED(irSignal & 0x1F))) {  // another device's remote)
         FSM_NEXT(st_standby); 
         DBG_PRINT_STATE(0);
       }
       else if (duration <= c_shortMax) {                      //it's Short
+        SQ_MARK(duration, c_bitPeriod / 2, c_shortMin, c_shortMax);
         FSM_NEXT(st_roseOffSync);
         DBG_PRINT_STATE(2);
       }
-      else FSM_DIRECTJUMP(ps_fellChoice);                     //it's Long
+      else {                                                  //it's Long
+        SQ_MARK(duration, c_bitPeriod, c_shortMax + 1, c_longMax);
+        FSM_DIRECTJUMP(ps_fellChoice);
+      }
     break;
       
     st_fellOffSync:  // State 4
@@ -108,7 +124,10 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the
         FSM_NEXT(st_standby);
         DBG_PRINT_STATE(0);
       }
-      else FSM_DIRECTJUMP(ps_fellChoice);                     //it's Short
+      else {                                                  //it's Short
+        SQ_MARK(duration, c_bitPeriod / 2, c_shortMin, c_shortMax);
+        FSM_DIRECTJUMP(ps_fellChoice);
+      }
     break;
       
     // ====> Pseudo-states: ps_roseChoice, ps_fellChoice, ps_decode
@@ -140,20 +159,26 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on every change in the
       DBG_PRINT_STATE("d");
       if (!_irCopyingData) {  // If not interrupting a copy, decode the signal; otherwise, discard it.
         // If the period is OK and the toggle bit did not change, then the key was held:
-        if (_previousTime - lastBitTime < c_rptPmax && (prevToggle == bool(irSignal & 0x0800))) {
-          if (repeatCount < c_rptCount) repeatCount++;
-          else {  // Initial repetitions have already been ignored
+        if (_previousTime - lastBitTime < c_rptPmax && (flags.prevToggle == bool(irSignal & 0x0800))) {
+          if (flags.repeatCount < c_rptCount) {
+            flags.repeatCount++;
+            DBG_PRINT_STATE("\nREPEAT IGNORED\n");
+          } else {  // Initial repetitions have already been ignored
             _irData.keyHeld = true;
+            TS_FRAME_END(_previousTime);
+            SQ_FRAME_END();
             _irDataAvailable = true;
           }
         } else {  // Key was not held, decode the signal:
           _irData.addr = (irSignal & 0x7C0) >> 6;
           _irData.cmd = (irSignal & 0x3F) | ((irSignal & 0x1000) ? 0 : 0x40);  // Extract cmd and add field bit (inverted)
           _irData.keyHeld = false;
+          TS_FRAME_END(_previousTime);
+          SQ_FRAME_END();
           _irDataAvailable = true;
-          repeatCount = 0;
+          flags.repeatCount = 0;
         }
-        prevToggle = bool(irSignal & 0x0800);
+        flags.prevToggle = bool(irSignal & 0x0800);
         lastBitTime = _previousTime;  // Last bit transition time (for keyHeld confirmation)
       }
       FSM_NEXT(st_standby);
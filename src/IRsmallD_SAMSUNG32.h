@@ -33,76 +33,109 @@
 #define BIT_TOLERANCE   ((BIT_1_MARK - BIT_0_MARK) / 2)  // = 712
 #define STOP_SPACE_MIN 35437       // 35437.5 µs to be more precise
 #define STOP_SPACE_MAX 72563       // 72562.5 µs to be more precise
+#define REPETITION_PERIOD 108000   // from the start of a frame to the start of the next one
+#define LEADING_PULSE   4500       // (and leading space)
+#define BIT_PULSE        562       // 562.5 µs to be more precise
 
 
-void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each falling edge of the IR receiver output signal.
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each falling edge of the IR receiver output signal.
   // The signal goes LOW when IR light is detected (so the falling edge marks the beginning of an IR pulse).
 
   // SAMSUNG32 timing thresholds:
-  const uint16_t c_LMmax = LEADING_MARK * 1.1;          // 10% more = 9900
-  const uint16_t c_LMmin = LEADING_MARK * 0.9;          // 10% less = 8100
-  const uint16_t c_M1max = BIT_1_MARK + BIT_TOLERANCE;  // 2550+712=3262
-  const uint16_t c_M1min = BIT_1_MARK - BIT_TOLERANCE;  // 2550-712=1838
-  const uint16_t c_M0min = BIT_0_MARK - BIT_TOLERANCE;  // 1125-712= 413
-  const uint32_t c_GapMax = STOP_SPACE_MAX + 6 * BIT_TOLERANCE;  // Bigger tolerance
-  const uint16_t c_GapMin = STOP_SPACE_MIN - 6 * BIT_TOLERANCE;  // 6 x 712 = 4272
+  const uint16_t c_LMmax = LEADING_MARK * 1.1 + IR_SMALLD_JITTER;                   // 10% more = 9900
+  const uint16_t c_LMmin = LEADING_MARK * 0.9 - IR_SMALLD_JITTER;                   // 10% less = 8100
+  const uint16_t c_M1max = BIT_1_MARK + BIT_TOLERANCE + IR_SMALLD_JITTER;           // 2550+712=3262
+  const uint16_t c_M1min = BIT_1_MARK - BIT_TOLERANCE;                              // 2550-712=1838
+  const uint16_t c_M0min = BIT_0_MARK - BIT_TOLERANCE - IR_SMALLD_JITTER;           // 1125-712= 413
+  const uint32_t c_GapMax = STOP_SPACE_MAX + 6 * BIT_TOLERANCE + IR_SMALLD_JITTER;  // Bigger tolerance
+  const uint16_t c_GapMin = STOP_SPACE_MIN - 6 * BIT_TOLERANCE - IR_SMALLD_JITTER;  // 6 x 712 = 4272
 
   // Number of initial repetitions to be ignored:
   const uint8_t  c_RptCount = 2;
 
+  #if defined(IR_SMALLD_DUAL_EDGE)  // Pulses and spaces:
+    const uint16_t c_LPmax = LEADING_PULSE * 1.2 + IR_SMALLD_JITTER;  // 5400 (leading pulse and space)
+    const uint16_t c_LPmin = LEADING_PULSE * 0.8 - IR_SMALLD_JITTER;  // 3600
+    const uint16_t c_Pmax  = BIT_PULSE * 1.5 + IR_SMALLD_JITTER;      //  843
+    const uint16_t c_Pmin  = BIT_PULSE * 0.5 - IR_SMALLD_JITTER;      //  281
+    const uint16_t c_Smin  = BIT_PULSE * 0.5 - IR_SMALLD_JITTER;      //  281 (bit 0 space is 562.5)
+  #endif
+  #if defined(IR_SMALLD_HOLD_GATE)
+    const uint32_t c_PeriodMin = REPETITION_PERIOD * 0.9 - IR_SMALLD_JITTER;  // 97200 (10% below standard value)
+  #endif
+
   // FSM variables:
-  static uint32_t duration;
+  static irDuration_t duration;
   static uint8_t  bitCount;
-  static uint8_t  irSignal[4];
-  static uint8_t  byteIndex = 0;
-  static uint8_t  repeatCount = 0;
-  static bool possiblyHeld = false;
+  static uint8_t  irSignal[4];   // Filled byte by byte, in irSignal[bitCount >> 3]
+  static struct {                // FSM flags, packed in a single byte:
+    uint8_t repeatCount  : 2;    // up to c_RptCount
+    bool    possiblyHeld : 1;
+  } flags;                       // (zero-initialized, as all statics)
+  IR_GATE_VARIABLES();
 
   DBG_RESTART_TIMER();
   
-  duration = micros() - _previousTime;
-  _previousTime = micros();
+  IR_DUAL_EDGE(c_LPmax);
+  IR_MEASURE_GATED(duration);
   DBG_PRINTLN_DUR(duration);
 
   switch (_state) {  // Asynchronous (event-driven) Finite State Machine
     case 0:  // Standby:
+      IR_GATE_OPEN();
       if (duration > c_GapMin) {
-        if (duration > c_GapMax) possiblyHeld = false;
+        if (IR_DURATION_ABOVE(duration, c_GapMax)) flags.possiblyHeld = false;
+        TS_FRAME_START();
+        SQ_FRAME_START();
         _state = 1;
-      } else possiblyHeld = false;
+      } else flags.possiblyHeld = false;
     break;
 
     case 1:  // StartPulse:
-      if (duration >= c_LMmin && duration <= c_LMmax) {  // It's a Leading Mark
+      if (duration >= c_LMmin && duration <= c_LMmax &&
+          !IR_PULSE_OUTSIDE(c_LPmin, c_LPmax) && !IR_SPACE_OUTSIDE(duration, c_LPmin, c_LPmax)) {  // It's a Leading Mark
         bitCount = 0;
-        byteIndex = 0;
         _state = 2;
       } else _state = 0;
     break;
 
     case 2:  // Receiving:
-      if (duration < c_M0min || duration > c_M1max) _state = 0; // Error: not a bit mark
+      if (duration < c_M0min || duration > c_M1max ||                // Error: not a bit mark
+          IR_PULSE_OUTSIDE(c_Pmin, c_Pmax) || IR_SPACE_OUTSIDE(duration, c_Smin, c_M1max)) _state = 0;
       else {                                                    // It's M0 or M1
-        irSignal[byteIndex] >>= 1;                              // Push a 0 from left to right (will be left at 0 if it's M0)
-        if (duration >= c_M1min) irSignal[byteIndex] |= 0x80;   // It's M1, change MSB to 1
+        uint8_t &irByte = irSignal[bitCount >> 3];
+        irByte >>= 1;                                           // Push a 0 from left to right (will be left at 0 if it's M0)
+        if (duration >= c_M1min) irByte |= 0x80;                // It's M1, change MSB to 1
+        SQ_BIT(duration, c_M0min, BIT_0_MARK, c_M1min, BIT_1_MARK, c_M1max);
         bitCount++;
-        if (bitCount == 8 || bitCount == 16 || bitCount == 24) byteIndex++;          // Byte full, proceed to the next one (stay in same state)
+        if (bitCount == 8 && !ADDRESS_ALLOWED(irSignal[0])) {                        // Another device's remote
+          _state = 0;
+          flags.possiblyHeld = false;
+        }
         else if (bitCount == 32) {                                                   // All bits received,
           _state = 0;                                                                // All paths lead to the standby state...
           if (irSignal[0] == irSignal[1] && irSignal[2] == (uint8_t)~irSignal[3]) {  // Address OK && command OK,
-            if (possiblyHeld && (irSignal[2] == _irData.cmd)) {                      // Key Held confirmed (cmd didn't changed)
-              if (repeatCount < c_RptCount) repeatCount++;                           // First repeat signals will be ignored
-              else if (!_irCopyingData) {                                            // Repetitions ignored;  if not interrupting a copy, update data
+            if (flags.possiblyHeld && (irSignal[2] == _irData.cmd)) {                // Key Held confirmed (cmd didn't changed)
+              if (flags.repeatCount < c_RptCount) {  // First repeat signals will be ignored
+                flags.repeatCount++;
+                DBG_PRINT_STATE("\nREPEAT IGNORED\n");
+              } else if (!_irCopyingData) {                                            // Repetitions ignored;  if not interrupting a copy, update data
                 _irData.keyHeld = true;
+                TS_FRAME_END(_previousTime);
+                SQ_FRAME_END();
                 _irDataAvailable = true;
               }
+              IR_GATE_CLOSE(c_PeriodMin, c_GapMin);  // The next repetition can't come earlier
             } else if (!_irCopyingData) {  // Key was not held; if allowed, update data; otherwise, discard it
               _irData.addr = irSignal[0];
               _irData.cmd  = irSignal[2];
               _irData.keyHeld = false;
+              TS_FRAME_END(_previousTime);
+              SQ_FRAME_END();
               _irDataAvailable = true;
-              possiblyHeld = true;  // Will remain true if the next gap is OK
-              repeatCount = 0;
+              flags.possiblyHeld = true;  // Will remain true if the next gap is OK
+              flags.repeatCount = 0;
+              IR_GATE_CLOSE(c_PeriodMin, c_GapMin);
             }
           }
         }
@@ -121,17 +154,13 @@ SAMSUNG32 protocol:
 -------------------
   Bits in order of transmission: A0 A1 A2 A3 A4 A5 A6 A7   A0 A1 A2 A3 A4 A5 A6 A7   C0 C1 C2 C3 C4 C5 C6 C7  ~C0~C1~C2~C3~C4~C5~C6~C7
   
-  Decoding process using irSignal array and byteIndex:
+  Decoding process using irSignal array (the byte index is bitCount >> 3):
      uint8_t irSignal[4]
-     uint8_t byteIndex = 0
      
-     Fill  irSignal[byteIndex]  (8 bit Address)
-     byteIndex++
-     Fill  irSignal[byteIndex]  (8 bit Address repeated)
-     byteIndex++
-     Fill  irSignal[byteIndex]  (8 bit Command)
-     byteIndex++
-     Fill  irSignal[byteIndex]  (Command Complement)
+     Fill  irSignal[0]  (8 bit Address)
+     Fill  irSignal[1]  (8 bit Address repeated)
+     Fill  irSignal[2]  (8 bit Command)
+     Fill  irSignal[3]  (Command Complement)
      Check if addr is OK
      Check if cmd is OK
      
@@ -42,87 +42,158 @@
  *   RPEAT_PERIOD_MULT = 75
  *   MAX_FRAME_MULT    = 4 + c_NumberOfBits * 3   ( max size of the signal - all bits are "1")
  *
+ *
+ * Key held (only if IR_SMALLD_SIRC_KEYHELD is defined):
+ *   The frames have no toggle bit and there are no repeat marks, so a frame is taken as a repetition if it has
+ *   the same code as the previous one and arrives less than a repetition period (+20%) after it, without noise
+ *   in between. As in the SIRC multi decoder, the first two repetitions of each key press are ignored (they're
+ *   always sent) and the next ones are published with keyHeld = true.
  */
 
 
-void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
+// Address of a partially filled signal, as soon as it's complete (after bit 15, or bit 12):
+#if defined(IR_SMALLD_SIRC15)
+  #define SIRC_ADDRESS(signal)  ((signal[0] >> 7) | (signal[1] & 0xFE))  // A0 | A7...A1
+#else
+  #define SIRC_ADDRESS(signal)  ((signal[0] >> 7) | (signal[1] >> 3))    // A0 | A4...A1 (still in the high nibble)
+#endif
+
+
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
   // The signal goes LOW when IR light is detected (so the rising edge marks the end of an IR pulse).
 
   #if defined(IR_SMALLD_SIRC12)  // Set bit count based on the selected protocol (resolved at compile time)
     const uint8_t c_NumberOfBits = 12;
+    const uint8_t c_AddrEnd = 12;  // The address is complete after bit 12
   #elif defined(IR_SMALLD_SIRC15)
     const uint8_t c_NumberOfBits = 15;
+    const uint8_t c_AddrEnd = 15;  // The address is complete after bit 15
   #else  // It must be IR_SMALLD_SIRC20
     const uint8_t c_NumberOfBits = 20;
+    const uint8_t c_AddrEnd = 12;  // The address is complete after bit 12 (before the extended data)
   #endif
 
   // SIRC timings' thresholds in micro secs:
   // bit 0 Mark length = 600µs space + 600µs pulse  = 1200µs
   // bit 1 Mark length = 600µs space + 1200µs pulse = 1800µs
   // Maximum tolerance = (1800 - 1200) / 2 = 300
-  const uint16_t c_M1max = 2100;  // = 1800 + 300 (it could be more)
-  const uint16_t c_M1min = 1500;  // = 1800 - 300
-  const uint16_t c_M0min =  900;  // = 1200 - 300 (it could be less)
+  const uint16_t c_M1max = 2100 + IR_SMALLD_JITTER;  // = 1800 + 300 (it could be more)
+  const uint16_t c_M1min = 1500;                     // = 1800 - 300
+  const uint16_t c_M0min =  900 - IR_SMALLD_JITTER;  // = 1200 - 300 (it could be less)
+  #if defined(IR_SMALLD_DUAL_EDGE)  // Pulses and spaces (the bits are in the pulses, the spaces are all 600µs):
+    const uint16_t c_SPmin = 2400 * 0.7 - IR_SMALLD_JITTER;  // 1680 (start pulse)
+    const uint16_t c_SPmax = 2400 * 1.3 + IR_SMALLD_JITTER;  // 3120
+    const uint16_t c_Pmin  =  600 * 0.5 - IR_SMALLD_JITTER;  //  300 (bit 0 pulse is 600, bit 1 is 1200)
+    const uint16_t c_Pmax  = 1200 * 1.25 + IR_SMALLD_JITTER; // 1500
+    const uint16_t c_Smin  =  600 * 0.5 - IR_SMALLD_JITTER;  //  300
+    const uint16_t c_Smax  =  600 * 1.5 + IR_SMALLD_JITTER;  //  900
+  #endif
   // Minimum standard Gap length = (75 - (4 + 3 x c_NumberOfBits)) x 600
-  const uint16_t c_GapMin  = (75 -(4 + 3 * c_NumberOfBits)) * 600 * 0.8;  // 20% below standard value
+  const uint16_t c_GapMin  = (75 -(4 + 3 * c_NumberOfBits)) * 600 * 0.8 - IR_SMALLD_JITTER;  // 20% below standard value
+  #if defined(IR_SMALLD_SIRC_KEYHELD)
+    // A gap (between the end of the previous frame and the end of the start pulse) is always shorter than the period:
+    const uint16_t c_GapMax = 75 * 600 * 1.2 + IR_SMALLD_JITTER;  // Repetition period + 20%
+    const uint8_t c_RptCount = 2;  // Number of initial repetitions to be ignored
+    #if defined(IR_SMALLD_HOLD_GATE)
+      const uint32_t c_PeriodMin = 75 * 600 * 0.9 - IR_SMALLD_JITTER;  // Repetition period - 10%
+    #endif
+  #endif
 
   // FSM variables:
-  static uint32_t duration;
+  static irDuration_t duration;
   static uint8_t bitCount;
-  static union {  // Received bits are stored in reversed order (e.g., 11000101... -> ...10100011)
-    #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15)
-      uint16_t all = 0;  // Arduino uses Little Endian so, if all=ABCD then in memory it's CDAB (hex format),
-      uint8_t byt[2];    // then we get byt[0]=CD and byt[1]=AB (type punning with a union...)
-    #else                // It must be IR_SMALLD_SIRC20
-      uint32_t all = 0;  // If all=ABCDEF00 then in memory it's 00EFCDAB (hex format)
-      uint8_t byt[4];    // byt[0]=00;  byt[1]=EF;  byt[2]=CD;  byt[3]=AB
-    #endif
-  } irSignal;
+  static uint8_t irSignal[(c_NumberOfBits + 7) / 8];  // Filled byte by byte, LSB first (a partial byte is left in its
+                                                      // high bits); see the decoding process at the end of the file
+  #if defined(IR_SMALLD_SIRC_KEYHELD)
+    static struct {              // FSM flags, packed in a single byte:
+      uint8_t repeatCount  : 2;  // up to c_RptCount
+      bool    possiblyHeld : 1;
+    } flags;                     // (zero-initialized, as all statics)
+    IR_GATE_VARIABLES();
+  #endif
 
   DBG_RESTART_TIMER();
 
-  duration = micros() - _previousTime;
-  _previousTime = micros();
+  IR_DUAL_EDGE(c_SPmax);
+  #if defined(IR_SMALLD_SIRC_KEYHELD)
+    IR_MEASURE_GATED(duration);
+  #else
+    IR_MEASURE_DURATION(duration);
+  #endif
   DBG_PRINTLN_DUR(duration)
 
   switch (_state) {  // Asynchronous (event-driven) Finite State Machine
     case 0: // Standby
-      if (duration > c_GapMin) {  // Only starts after a GAP without signals
+      #if defined(IR_SMALLD_SIRC_KEYHELD)
+        IR_GATE_OPEN();
+      #endif
+      if (duration > c_GapMin && !IR_PULSE_OUTSIDE(c_SPmin, c_SPmax)) {  // Only starts after a GAP without signals
+        #if defined(IR_SMALLD_SIRC_KEYHELD)
+          if (duration > c_GapMax) flags.possiblyHeld = false;
+        #endif
         bitCount = 0;
+        for (uint8_t i = 0; i < sizeof(irSignal); i++) irSignal[i] = 0;  // The partial byte must start empty
+        TS_FRAME_START();
+        SQ_FRAME_START();
         _state = 1;  // Leading pulse detected
       }
+      #if defined(IR_SMALLD_SIRC_KEYHELD)
+        else flags.possiblyHeld = false;  // Noise between frames
+      #endif
     break;
 
     case 1: // Receiving
-      if (duration < c_M0min || duration > c_M1max) _state = 0;  // Not a Mark duration
+      if (duration < c_M0min || duration > c_M1max ||              // Not a Mark duration
+          IR_PULSE_OUTSIDE(c_Pmin, c_Pmax) || IR_SPACE_OUTSIDE(duration, c_Smin, c_Smax)) _state = 0;
       else {                                                     // It's M0 or M1
-        irSignal.all >>= 1;  // Push a 0 from left to right (will be left at 0 if it's M0)
+        uint8_t &irByte = irSignal[bitCount >> 3];
+        irByte >>= 1;                             // Push a 0 from left to right (will be left at 0 if it's M0)
+        if (duration >= c_M1min) irByte |= 0x80;  // It's a bit 1 mark, change Most Significant bit to 1
+        SQ_BIT(duration, c_M0min, 1200, c_M1min, 1800, c_M1max);  // Nominal bit marks: 1200 and 1800µs
         bitCount++;
-        if (duration >= c_M1min) {  // It's a bit 1 mark, change Most Significant bit to 1
-          #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15)
-            irSignal.byt[1] |= 0x80;
-          #else   // IR_SMALLD_SIRC20 uses 4 bytes
-            irSignal.byt[3] |= 0x80;
+        if (bitCount == c_AddrEnd && !ADDRESS_ALLOWED(SIRC_ADDRESS(irSignal))) {  // Another device's remote
+          _state = 0;
+          #if defined(IR_SMALLD_SIRC_KEYHELD)
+            flags.possiblyHeld = false;
           #endif
         }
-        if (bitCount == c_NumberOfBits) {  // All bits received
+        else if (bitCount == c_NumberOfBits) {  // All bits received
           if (!_irCopyingData) {           // If not interrupting a copy, decode the signal; otherwise, discard it
-            #if defined(IR_SMALLD_SIRC12)
-              irSignal.all >>= 3;          // Adjust address in the high byte (only needed for SIRC12)
+            uint8_t cmd = irSignal[0] & 0x7F;
+            #if defined(IR_SMALLD_SIRC20)  // A1...A4 were pushed to the low nibble of [1] by the extended data
+              uint8_t addr = ((irSignal[0] >> 7) | (irSignal[1] << 1)) & 0x1F;
+              uint8_t ext  = (irSignal[1] >> 4) | (irSignal[2] & 0xF0);
+            #else
+              uint8_t addr = SIRC_ADDRESS(irSignal);
+            #endif
+            bool publish = true;
+            #if defined(IR_SMALLD_SIRC_KEYHELD)  // Compared with the last published frame (_irData isn't changed otherwise)
+              bool held = flags.possiblyHeld && cmd == _irData.cmd && addr == _irData.addr;
+              #if defined(IR_SMALLD_SIRC20)
+                held = held && ext == _irData.ext;
+              #endif
+              if (!held) flags.repeatCount = 0;
+              else if (flags.repeatCount < c_RptCount) {  // First repetitions will be ignored
+                flags.repeatCount++;
+                publish = false;
+                DBG_PRINT_STATE("\nREPEAT IGNORED\n");
+              }
+              flags.possiblyHeld = true;  // Will remain true if the next gap is OK
+              IR_GATE_CLOSE(c_PeriodMin, c_GapMin);  // The next repetition can't come earlier
             #endif
-            #if defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15)
-              irSignal.byt[0] >>= 1;           // Adjust command in the low byte
-              _irData.addr = irSignal.byt[1];  // Little-Endian puts high byte in the array's second position
-              _irData.cmd  = irSignal.byt[0];
-            #else                              // Else, it's IR_SMALLD_SIRC20...
-              _irData.ext = irSignal.byt[3];
-              irSignal.byt[3] = 0;
-              irSignal.all >>= 3;
-              irSignal.byt[1] >>= 1;
-              _irData.addr = irSignal.byt[2];
-              _irData.cmd  = irSignal.byt[1];
-            #endif  
-            _irDataAvailable = true;
+            if (publish) {
+              _irData.cmd = cmd;
+              _irData.addr = addr;
+              #if defined(IR_SMALLD_SIRC20)
+                _irData.ext = ext;
+              #endif
+              #if defined(IR_SMALLD_SIRC_KEYHELD)
+                _irData.keyHeld = held;
+              #endif
+              TS_FRAME_END(_previousTime);
+              SQ_FRAME_END();
+              _irDataAvailable = true;
+            }
           }
           _state = 0; // Done
         } // Else, remain in this state (continue receiving)
@@ -134,23 +205,23 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of
 }
 
 
-/* 12-bit signal decode process (bit order is already reversed)
- *                     byt[1] (high byte)        byt[0] (low byte)
- * encoded bits:    A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0
- * all >> 3          0  0  0 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0
- * byt[0] >> 1       0  0  0 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0
- * 
- *
- * 15-bit signal decode process (bit order already reversed)
- *                     byt[1] (high byte)        byt[0] (low byte)
- * encoded bits:    A7 A6 A5 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0
- * byt[0] >> 1      A7 A6 A5 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0
- * 
- *
- * 20-bit signal decode process (bit order already reversed)
- *                            byt[3] (high)                 byt[2]                   byt[1]             byt[0] (low)
- * encoded bits:         E7 E6 E5 E4 E3 E2 E1 E0   A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0   0 0 0 0 0 0 0 0
- * extract ext code       0  0  0  0  0  0  0  0   A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0   0 0 0 0 0 0 0 0
- * all >> 3               0  0  0  0  0  0  0  0    0  0  0 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0   0 0 0 0 0 0 0 0
- * byt[1] >> 1            0  0  0  0  0  0  0  0    0  0  0 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0   0 0 0 0 0 0 0 0
+/* Decoding process (bit order is already reversed; a partial byte is left in the high bits)
+ *
+ * 12 bits:            irSignal[1]               irSignal[0]
+ * received bits:   A4 A3 A2 A1  0  0  0  0   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd = [0] & 0x7F                            0 C6 C5 C4 C3 C2 C1 C0
+ * addr = [0] >> 7 | [1] >> 3                  0  0  0 A4 A3 A2 A1 A0
+ *
+ *
+ * 15 bits:            irSignal[1]               irSignal[0]
+ * received bits:   A7 A6 A5 A4 A3 A2 A1  0   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd = [0] & 0x7F                            0 C6 C5 C4 C3 C2 C1 C0
+ * addr = [0] >> 7 | ([1] & 0xFE)             A7 A6 A5 A4 A3 A2 A1 A0
+ *
+ *
+ * 20 bits:            irSignal[2]               irSignal[1]               irSignal[0]
+ * received bits:   E7 E6 E5 E4  0  0  0  0   E3 E2 E1 E0 A4 A3 A2 A1   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd  = [0] & 0x7F                                                     0 C6 C5 C4 C3 C2 C1 C0
+ * addr = ([0] >> 7 | [1] << 1) & 0x1F                                   0  0  0 A4 A3 A2 A1 A0
+ * ext  = [1] >> 4 | ([2] & 0xF0)                                       E7 E6 E5 E4 E3 E2 E1 E0
 */
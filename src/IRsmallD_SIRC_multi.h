@@ -42,117 +42,142 @@
  */
 
 
-void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
+IR_ISR_TEMPLATE void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of the IR receiver output signal.
   // The signal goes LOW when IR light is detected (so the rising edge marks the end of an IR pulse).
 
   // SIRC timings' thresholds in microseconds:
   // Minimum standard gap length = (75 - (4 + 3 × 20)) × 600  --> assuming 20 '1' bits, which results in the smallest gapMin
   // Maximum standard gap length = (75 - (4 + 2 × 12)) × 600  --> assuming 12 '0' bits, which results in the largest gapMax
-  const uint16_t c_GapMax = 33840;  // = (75 -(4 + 2 x 12)) x 600 x 1.2  (20% above standard value)
-  const uint16_t c_GapMin =  5280;  // = (75 -(4 + 3 x 20)) x 600 x 0.8  (20% below standard value)
+  const uint16_t c_GapMax = 33840 + IR_SMALLD_JITTER;  // = (75 -(4 + 2 x 12)) x 600 x 1.2  (20% above standard value)
+  const uint16_t c_GapMin =  5280 - IR_SMALLD_JITTER;  // = (75 -(4 + 3 x 20)) x 600 x 0.8  (20% below standard value)
   // Bit 0 Mark length = 600µs space + 600µs pulse  = 1200µs
   // Bit 1 Mark length = 600µs space + 1200µs pulse = 1800µs
   // Maximum tolerance = (1800 - 1200) / 2 = 300
-  const uint16_t c_M1max = 2100;  // = 1800 + 300 (it could be more)
-  const uint16_t c_M1min = 1500;  // = 1800 - 300
-  const uint16_t c_M0min =  900;  // = 1200 - 300 (it could be less)
+  const uint16_t c_M1max = 2100 + IR_SMALLD_JITTER;  // = 1800 + 300 (it could be more)
+  const uint16_t c_M1min = 1500;                     // = 1800 - 300
+  const uint16_t c_M0min =  900 - IR_SMALLD_JITTER;  // = 1200 - 300 (it could be less)
+  #if defined(IR_SMALLD_DUAL_EDGE)  // Pulses and spaces (the bits are in the pulses, the spaces are all 600µs):
+    const uint16_t c_SPmin = 2400 * 0.7 - IR_SMALLD_JITTER;  // 1680 (start pulse)
+    const uint16_t c_SPmax = 2400 * 1.3 + IR_SMALLD_JITTER;  // 3120
+    const uint16_t c_Pmin  =  600 * 0.5 - IR_SMALLD_JITTER;  //  300 (bit 0 pulse is 600, bit 1 is 1200)
+    const uint16_t c_Pmax  = 1200 * 1.25 + IR_SMALLD_JITTER; // 1500
+    const uint16_t c_Smin  =  600 * 0.5 - IR_SMALLD_JITTER;  //  300
+    const uint16_t c_Smax  =  600 * 1.5 + IR_SMALLD_JITTER;  //  900
+  #endif
   
   // Number of initial repetitions to be ignored:
   const uint8_t c_RptCount = 5;
 
+  #if defined(IR_SMALLD_HOLD_GATE)
+    const uint32_t c_PeriodMin = 75 * 600 * 0.9 - IR_SMALLD_JITTER;  // = 40500 (repetition period - 10%)
+  #endif
+
   // FSM variables:
-  static uint32_t duration;
+  static irDuration_t duration;
   static uint8_t  bitCount;
-  static union {       // Received bits are stored in reversed order (11000101... -> ...10100011)
-    uint32_t all = 0;  // If all=ABCDEF00 then in memory it's 00EFCDAB (hex format)
-    uint8_t  byt[4];   // and byt[0]=00;  byt[1]=EF;  byt[2]=CD;  byt[3]=AB (type punning with a union...)
+  static union {       // Received bits, filled byte by byte, LSB first (a partial byte is left in its high bits);
+    uint32_t all = 0;  // the whole code is only used to compare the frames (it doesn't depend on the endianness)
+    uint8_t  byt[4];
   } irSignal;
-  static uint8_t  frameCount;
   static uint8_t  firstBitCount = 20;
   static uint32_t firstCode;
-  static bool     possiblyHeld = false;
-  static uint8_t  repeatCount = 0;
+  static struct {                // FSM flags, packed in a single byte:
+    uint8_t frameCount   : 2;    // 1 to 3
+    uint8_t repeatCount  : 3;    // up to c_RptCount
+    bool    possiblyHeld : 1;
+  } flags;                       // (zero-initialized, as all statics)
+  IR_GATE_VARIABLES();
 
   DBG_RESTART_TIMER();
 
-  duration = micros() - _previousTime;
-  _previousTime = micros();
+  IR_DUAL_EDGE(c_SPmax);
+  IR_MEASURE_GATED(duration);
   DBG_PRINTLN_DUR(duration)
 
   switch (_state) {  // Asynchronous (event-driven) Finite State Machine
     case 0:  // Standby
-      if (duration >= c_GapMin) {  // Only starts after a GAP without signals
-        if (duration > c_GapMax) possiblyHeld = false;
+      IR_GATE_OPEN();
+      if (duration >= c_GapMin && !IR_PULSE_OUTSIDE(c_SPmin, c_SPmax)) {  // Only starts after a GAP without signals
+        if (duration > c_GapMax) flags.possiblyHeld = false;
         bitCount = 0;
         irSignal.all = 0;
-        frameCount = 1;
+        flags.frameCount = 1;
+        TS_FRAME_START();
+        SQ_FRAME_START();
         _state = 1;
-      } else possiblyHeld = false;
+      } else flags.possiblyHeld = false;
     break;
 
     case 1:  // Receiving
       if (duration < c_M0min || duration > c_M1max) {                    // Not a Bit Mark duration
-        if (frameCount == 3) _state = 0;                                 // Duration error in frame 3
+        if (flags.frameCount == 3) _state = 0;                                 // Duration error in frame 3
         else {                                                           // Not a Bit Mark duration, possibly a Gap at frame 1 or frame 2
-          if (duration < c_GapMin || duration > c_GapMax) _state = 0;    // Duration error
+          if (duration < c_GapMin || duration > c_GapMax || IR_PULSE_OUTSIDE(c_SPmin, c_SPmax)) _state = 0;  // Duration error
           else {                                                         // It's a Gap at the end of frame 1 or frame 2
-            if (frameCount == 1) {                                       // Frame 1 received
-              if (bitCount == 12 || bitCount == 15 || bitCount == 20) {  // bitCount confirmed, prep for frame 2
-                firstBitCount = bitCount;
+            if (flags.frameCount == 1) {                                 // Frame 1 received
+              if ((bitCount == 12 && ADDRESS_ALLOWED((irSignal.byt[0] >> 7) | (irSignal.byt[1] >> 3))) ||  // bitCount
+                  (bitCount == 15 && ADDRESS_ALLOWED((irSignal.byt[0] >> 7) | (irSignal.byt[1] & 0xFE))) ||  // confirmed,
+                  (bitCount == 20 && ADDRESS_ALLOWED(((irSignal.byt[0] >> 7) | (irSignal.byt[1] << 1)) & 0x1F))) {
+                firstBitCount = bitCount;                                  // address allowed, prep for frame 2
                 bitCount = 0;
                 firstCode = irSignal.all;
                 irSignal.all = 0;
-                frameCount = 2;
-              } else _state = 0;                // BitCount error
+                flags.frameCount = 2;
+              } else _state = 0;                // BitCount error (or another device's remote)
             } else {                            // Frame 2 received
               if (irSignal.all == firstCode) {  // Code OK, prep for frame 3
+                IR_GATE_OPEN();                 // (frame 3 starts here)
                 bitCount = 0;
                 irSignal.all = 0;
-                frameCount = 3;
+                flags.frameCount = 3;
               } else _state = 0;                 // Code error at end of frame 2
             }
           }
         }
-      } else {                                             // It's a Bit Mark duration
-        irSignal.all >>= 1;                                // Push a 0 from left to right (will be left at 0 if it's M0)
-        if (duration >= c_M1min) irSignal.byt[3] |= 0x80;  // It's M1, change MSB to 1
+      } else if (bitCount == 20) _state = 0;               // Too many bits
+      else if (IR_PULSE_OUTSIDE(c_Pmin, c_Pmax) || IR_SPACE_OUTSIDE(duration, c_Smin, c_Smax)) _state = 0;  // Bad pulse or space
+      else {                                               // It's a Bit Mark duration
+        uint8_t &irByte = irSignal.byt[bitCount >> 3];
+        irByte >>= 1;                                      // Push a 0 from left to right (will be left at 0 if it's M0)
+        if (duration >= c_M1min) irByte |= 0x80;           // It's M1, change MSB to 1
+        SQ_BIT(duration, c_M0min, 1200, c_M1min, 1800, c_M1max);  // Nominal bit marks: 1200 and 1800µs
         bitCount++;
-        if (frameCount == 3) {
+        if (flags.frameCount == 3) {
           if (bitCount == firstBitCount) {                         // All bits of frame 3 received
             if (!_irCopyingData && (irSignal.all == firstCode)) {  // If not interrupting a copy and the code is OK, decode the data; otherwise, discard it
+              _irData.cmd = irSignal.byt[0] & 0x7F;
               if (bitCount == 12) {
-                irSignal.all >>= 3;
-                irSignal.byt[2] >>= 1;
-                _irData.addr = irSignal.byt[3];
-                _irData.cmd = irSignal.byt[2];
+                _irData.addr = (irSignal.byt[0] >> 7) | (irSignal.byt[1] >> 3);
                 _irData.ext = 0;
               } else if (bitCount == 15) {
-                irSignal.byt[2] >>= 1;
-                _irData.addr = irSignal.byt[3];
-                _irData.cmd = irSignal.byt[2];
+                _irData.addr = (irSignal.byt[0] >> 7) | (irSignal.byt[1] & 0xFE);
                 _irData.ext = 0;
               } else {  // It's 20 bits
-                _irData.ext = irSignal.byt[3];
-                irSignal.byt[3] = 0;
-                irSignal.all >>= 3;
-                irSignal.byt[1] >>= 1;
-                _irData.addr = irSignal.byt[2];
-                _irData.cmd  = irSignal.byt[1];
+                _irData.addr = ((irSignal.byt[0] >> 7) | (irSignal.byt[1] << 1)) & 0x1F;
+                _irData.ext  = (irSignal.byt[1] >> 4) | (irSignal.byt[2] & 0xF0);
               }
               _irData.keyHeld = false;
+              TS_FRAME_END(_previousTime);
+              SQ_FRAME_END();
               _irDataAvailable = true;
-              possiblyHeld = true;  // Will remain true if the next gap is OK
+              flags.possiblyHeld = true;  // Will remain true if the next gap is OK
+              IR_GATE_CLOSE(c_PeriodMin, c_GapMin);  // The next repetition can't come earlier
             }
-            repeatCount = 0;
+            flags.repeatCount = 0;
             _state = 0;  // Done
           }              // Else, remain in this state (continue receiving frame 3)
         } else {         // It's frame 1 or 2. Check if a key was held
-          if (frameCount == 1 && possiblyHeld && bitCount == firstBitCount && irSignal.all == firstCode) {  // A key was Held
-            if (repeatCount < c_RptCount) repeatCount++;  // First repetitions will be ignored
-            else if (!_irCopyingData) {                   // If not interrupting a copy then keyHeld...
+          if (flags.frameCount == 1 && flags.possiblyHeld && bitCount == firstBitCount && irSignal.all == firstCode) {  // Held
+            if (flags.repeatCount < c_RptCount) {  // First repetitions will be ignored
+              flags.repeatCount++;
+              DBG_PRINT_STATE("\nREPEAT IGNORED\n");
+            } else if (!_irCopyingData) {                   // If not interrupting a copy then keyHeld...
               _irData.keyHeld = true;
+              TS_FRAME_END(_previousTime);
+              SQ_FRAME_END();
               _irDataAvailable = true;
             }
+            IR_GATE_CLOSE(c_PeriodMin, c_GapMin);
             _state = 0;
           }
         }
@@ -164,23 +189,23 @@ void IR_ISR_ATTR IRsmallDecoder::irISR() {  // Triggered on each rising edge of
 }
 
 
-/* Decoding process using 32 bits data for all cases (bit order already reversed)
- * 
- * 12 bits:                byt[3] (high)                byt[2]                 byt[1]         byt[0] (low)
- * encoded bits:      A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0   0 0 0 0 0 0 0 0   0 0 0 0 0 0 0 0
- * all >> 3            0  0  0 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0   0 0 0 0 0 0 0 0   0 0 0 0 0 0 0 0
- * byt[2] >> 1         0  0  0 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0   0 0 0 0 0 0 0 0   0 0 0 0 0 0 0 0
+/* Decoding process (bit order already reversed; a partial byte is left in the high bits)
  *
+ * 12 bits:                byt[1]                    byt[0]
+ * received bits:      A4 A3 A2 A1  0  0  0  0   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd  = byt[0] & 0x7F                           0 C6 C5 C4 C3 C2 C1 C0
+ * addr = byt[0] >> 7 | byt[1] >> 3               0  0  0 A4 A3 A2 A1 A0
  *
- * 15 bits:                byt[3] (high)                byt[2]                 byt[1]         byt[0] (low)
- * encoded bits:      A7 A6 A5 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0   0 0 0 0 0 0 0 0   0 0 0 0 0 0 0 0
- * byt[2] >> 1        A7 A6 A5 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0   0 0 0 0 0 0 0 0   0 0 0 0 0 0 0 0
  *
+ * 15 bits:                byt[1]                    byt[0]
+ * received bits:      A7 A6 A5 A4 A3 A2 A1  0   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd  = byt[0] & 0x7F                           0 C6 C5 C4 C3 C2 C1 C0
+ * addr = byt[0] >> 7 | (byt[1] & 0xFE)          A7 A6 A5 A4 A3 A2 A1 A0
  *
- * 20 bits:                byt[3] (high)                byt[2]                    byt[1]              byt[0] (low)
- * encoded bits:      E7 E6 E5 E4 E3 E2 E1 E0   A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0   0 0 0 0 0 0 0 0
- * extract ext code    0  0  0  0  0  0  0  0   A4 A3 A2 A1 A0 C6 C5 C4   C3 C2 C1 C0  0  0  0  0   0 0 0 0 0 0 0 0
- * all >> 3            0  0  0  0  0  0  0  0    0  0  0 A4 A3 A2 A1 A0   C6 C5 C4 C3 C2 C1 C0  0   0 0 0 0 0 0 0 0
- * byt[1] >> 1         0  0  0  0  0  0  0  0    0  0  0 A4 A3 A2 A1 A0    0 C6 C5 C4 C3 C2 C1 C0   0 0 0 0 0 0 0 0
+ *
+ * 20 bits:                byt[2]                    byt[1]                    byt[0]
+ * received bits:      E7 E6 E5 E4  0  0  0  0   E3 E2 E1 E0 A4 A3 A2 A1   A0 C6 C5 C4 C3 C2 C1 C0
+ * cmd  = byt[0] & 0x7F                                                     0 C6 C5 C4 C3 C2 C1 C0
+ * addr = (byt[0] >> 7 | byt[1] << 1) & 0x1F                                0  0  0 A4 A3 A2 A1 A0
+ * ext  = byt[1] >> 4 | (byt[2] & 0xF0)                                    E7 E6 E5 E4 E3 E2 E1 E0
 */
-
@@ -18,15 +18,41 @@
  *    #define IR_SMALLD_SIRC
  *    #define IR_SMALLD_SAMSUNG
  *    #define IR_SMALLD_SAMSUNG32
- *    
+ *    #define IR_SMALLD_HASH
+ *
  *   before the
  *    #include <IRsmallDecoder.h>
  *
  * ► RC5 works for both normal and extended versions;
  * ► SIRC12, SIRC15 and SIRC20 use a basic (smaller and faster) implementation but without some features...
+ *   (IR_SMALLD_SIRC_KEYHELD can be defined to add keyHeld, by comparing each frame with the previous one);
  * ► SIRC handles SIRC 12, 15 and 20 bits, by taking advantage of the fact that most Sony remotes send
  *   three frames each time one button is pressed. It uses triple frame verification and checks if keyHeld;
+ * ► HASH does not decode any specific protocol; it turns each frame of an unknown remote into a 32 bit hash;
  * ► IR_SMALLD_NO_TIMEOUT can be defined before the #include <IRsmallDecoder.h> to disable the timeout feature.
+ * ► IR_SMALLD_TIMESTAMPS can be defined to add the time, duration and latency members to the decoded data.
+ * ► IR_SMALLD_ADDRESS_FILTER can be defined as a list of addresses (e.g. 0x00, 0x04); frames with other
+ *   addresses are discarded by the ISR as soon as their address is received (not available for HASH).
+ * ► IR_SMALLD_QUALITY can be defined to add signal quality members (deviations, margin and a score) to the
+ *   decoded data (not available for HASH).
+ * ► IR_SMALLD_FREERTOS_NOTIFY (ESP32), or a custom IR_SMALLD_NOTIFY()/IR_SMALLD_WAIT(us) pair, can be defined
+ *   to let waitForData() sleep until the ISR has new data, instead of polling.
+ * ► IR_SMALLD_EDGE_BUFFER replaces the pin interrupt with decodeBuffer(), which decodes a whole buffer of
+ *   pulse/space durations (e.g. from the ESP32 RMT or a RP2040 PIO) in one call.
+ * ► IR_SMALLD_SAMPLING replaces the pin interrupt with sample(), which must be called periodically (every
+ *   IR_SMALLD_SAMPLE_PERIOD µs, 50 by default), e.g. from a timer interrupt. Any digital pin can be used.
+ * ► IR_SMALLD_MULTICORE makes the handoff between the ISR and dataAvailable() safe when they run on different
+ *   cores (e.g. dual-core ESP32), with atomics and a sequence lock instead of disabling interrupts.
+ * ► IR_SMALLD_DIVERSITY decodes two IR receivers (on two pins, each with its own FSM) into one stream of frames,
+ *   without the duplicates of a frame received by both.
+ * ► IR_SMALLD_RECORDER keeps the last edges received (IR_SMALLD_RECORDER_SIZE bytes, varint encoded) in a ring
+ *   buffer, which can be frozen and dumped in a format that the host tools can replay (see extras/HostTools).
+ * ► IR_SMALLD_HOLD_GATE makes the ISRs ignore the edges that come before the next repetition while a key may be
+ *   held (noise between repetitions no longer ends them); not used by RC5 and HASH.
+ * ► IR_SMALLD_DUAL_EDGE makes the NEC, SIRC and SAMSUNG ISRs run on both edges, to check the pulse and the space
+ *   of each mark separately (interference with the right mark length is rejected).
+ * ► IR_SMALLD_AVR_FAST enables the AVR fast path (16-bit intervals in the ISRs). It's experimental: its gain
+ *   hasn't been measured on an AVR board yet (see extras/Footprint/footprint.sh -f), so it's off by default.
  */
 
 #ifndef IRsmallDecoder_h
@@ -45,23 +71,158 @@
 #include "IRsmallDDebug.h"
 
 
+// ****************************************************************************
+// Sampling mode (if IR_SMALLD_SAMPLING is defined):
+// The edges are only detected when sample() is called, so each measured duration can be off by up to one
+// sample period. The decoders' outer acceptance limits are widened by IR_SMALLD_JITTER to compensate.
+#if defined(IR_SMALLD_SAMPLING)
+  #if defined(IR_SMALLD_EDGE_BUFFER)
+    #error IR_SMALLD_SAMPLING and IR_SMALLD_EDGE_BUFFER cannot be used together
+  #endif
+  #if !defined(IR_SMALLD_SAMPLE_PERIOD)
+    #define IR_SMALLD_SAMPLE_PERIOD 50  // µs
+  #endif
+  #if IR_SMALLD_SAMPLE_PERIOD > 200
+    #error IR_SMALLD_SAMPLE_PERIOD is too long (maximum is 200µs, 50µs or less is recommended)
+  #endif
+  #define IR_SMALLD_JITTER IR_SMALLD_SAMPLE_PERIOD
+#else
+  #define IR_SMALLD_JITTER 0
+#endif
+
+
+// ****************************************************************************
+// Signal quality (if IR_SMALLD_QUALITY is defined):
+// The HASH decoder has no nominal durations to compare the intervals with.
+#if defined(IR_SMALLD_QUALITY) && defined(IR_SMALLD_HASH)
+  #error IR_SMALLD_QUALITY is not available for the HASH decoder
+#endif
+
+
+// ****************************************************************************
+// Multi-core handoff (if IR_SMALLD_MULTICORE is defined):
+// The ISR publishes each frame with a sequence lock (the consumer retries the copy if the ISR changed it meanwhile),
+// and the timeout reset takes the FSM with a try-lock (edges that arrive meanwhile are queued for the reset to decode,
+// up to IR_SMALLD_PENDING_EDGES: 4 by default, a power of 2; more than that, and the later ones are dropped).
+// Neither side disables interrupts or waits for the other, and the ISR never drops a frame because of a copy.
+#if defined(IR_SMALLD_MULTICORE)
+  #if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+    #error IR_SMALLD_MULTICORE cannot be used with IR_SMALLD_EDGE_BUFFER or IR_SMALLD_SAMPLING
+  #endif
+  #if defined(__AVR__)
+    #error IR_SMALLD_MULTICORE requires std::atomic (and single-core AVR boards do not need it)
+  #endif
+  #include <atomic>
+  #if !defined(IR_SMALLD_PENDING_EDGES)
+    #define IR_SMALLD_PENDING_EDGES 4
+  #endif
+  #if (IR_SMALLD_PENDING_EDGES) & ((IR_SMALLD_PENDING_EDGES) - 1)
+    #error IR_SMALLD_PENDING_EDGES must be a power of 2
+  #endif
+#endif
+
+
+// ****************************************************************************
+// Receiver diversity (if IR_SMALLD_DIVERSITY is defined):
+// Each receiver has its own ISR, with its own copy of the FSM: the ISR is a template (one instantiation, and one set of
+// static variables, per receiver), and the FSM registers shared by all ISRs (_state, _previousTime...) are loaded
+// from the receiver's slot before each call and saved after it. The first receiver to complete a frame wins; the same
+// frame from the other receiver is a duplicate if it ends less than IR_SMALLD_DIVERSITY_WINDOW µs later (half of the
+// protocol's repetition period by default, so the repetitions of a held key are not taken as duplicates).
+#if defined(IR_SMALLD_DIVERSITY)
+  #if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING) || defined(IR_SMALLD_MULTICORE)
+    #error IR_SMALLD_DIVERSITY cannot be used with IR_SMALLD_EDGE_BUFFER, IR_SMALLD_SAMPLING or IR_SMALLD_MULTICORE
+  #endif
+  #if !defined(IR_SMALLD_DIVERSITY_WINDOW)
+    #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_NECx) || defined(IR_SMALLD_SAMSUNG32)
+      #define IR_SMALLD_DIVERSITY_WINDOW 54000  // repetition period: 108ms
+    #elif defined(IR_SMALLD_SAMSUNG)
+      #define IR_SMALLD_DIVERSITY_WINDOW 30000  // repetition period: 60ms
+    #elif defined(IR_SMALLD_RC5)
+      #define IR_SMALLD_DIVERSITY_WINDOW 56896  // repetition period: 113.792ms
+    #elif defined(IR_SMALLD_HASH)
+      #define IR_SMALLD_DIVERSITY_WINDOW 20000  // unknown protocol: the minimum gap between frames
+    #else
+      #define IR_SMALLD_DIVERSITY_WINDOW 22500  // SIRC repetition period: 45ms
+    #endif
+  #endif
+  #define IR_ISR_TEMPLATE  template <uint8_t receiver>
+#else
+  #define IR_ISR_TEMPLATE  // not a template
+#endif
+
+
+// ****************************************************************************
+// Edge recorder (if IR_SMALLD_RECORDER is defined):
+// Each edge that triggers the ISR is recorded before it reaches the FSM, as the time since the previous edge, in units
+// of 2^IR_SMALLD_RECORDER_SHIFT µs (the resolution of micros() on AVR boards), shifted left by one bit to make room
+// for a frame start flag (set if the FSM was in standby), and stored as a varint (7 bits per byte, LSB first,
+// the high bit is set if more bytes follow). Most durations take one or two bytes. When the ring buffer is full,
+// the oldest frame is dropped as a whole (up to the next frame start), so the recording starts with a complete frame.
+#if defined(IR_SMALLD_RECORDER)
+  #if defined(IR_SMALLD_MULTICORE) || defined(IR_SMALLD_DIVERSITY)
+    #error IR_SMALLD_RECORDER cannot be used with IR_SMALLD_MULTICORE or IR_SMALLD_DIVERSITY
+  #endif
+  #if !defined(IR_SMALLD_RECORDER_SIZE)
+    #define IR_SMALLD_RECORDER_SIZE 256  // bytes
+  #endif
+  #if IR_SMALLD_RECORDER_SIZE < 16 || IR_SMALLD_RECORDER_SIZE > 32767
+    #error IR_SMALLD_RECORDER_SIZE must be between 16 and 32767 bytes
+  #endif
+  #if !defined(IR_SMALLD_RECORDER_SHIFT)
+    #if defined(__AVR__) && F_CPU >= 16000000L
+      #define IR_SMALLD_RECORDER_SHIFT 2  // micros() resolution: 4µs
+    #elif defined(__AVR__)
+      #define IR_SMALLD_RECORDER_SHIFT 3  // micros() resolution: 8µs
+    #else
+      #define IR_SMALLD_RECORDER_SHIFT 0
+    #endif
+  #endif
+#endif
+
+
+// ****************************************************************************
+// Edge buffer input (if IR_SMALLD_EDGE_BUFFER is defined):
+// Each item is the level of the receiver's output and for how long (µs) it stayed at that level, so the level
+// changes at the end of each item. This is the layout of each half of an ESP32 RMT item (rmt_data_t), which can
+// be used directly; a zero duration marks the end of the data.
+#if defined(IR_SMALLD_EDGE_BUFFER)
+  struct irSmallD_pulse_t {
+    uint16_t duration : 15;
+    uint16_t level    : 1;
+  };
+#endif
+
+
 // ****************************************************************************
 // IR_ISR_MODE definition based on protocol:
 // Keep in mind that the signal is active low. The decoder pulls the input pin to LOW when detecting an IR pulse.
+// The FSMs of the pulse distance/width decoders run once per mark, on IR_FSM_EDGE; in dual-edge mode (see
+// IR_DUAL_EDGE() below) their ISR is also triggered by the other edge, to measure the mark's pulse.
 #if defined(IR_SMALLD_SAMSUNG) || defined(IR_SMALLD_SAMSUNG32)
-  #define IR_ISR_MODE  FALLING
+  #define IR_FSM_EDGE  FALLING
 
 #elif defined(IR_SMALLD_SIRC12) || defined(IR_SMALLD_SIRC15) || defined(IR_SMALLD_SIRC20) || \
       defined(IR_SMALLD_SIRC)   || defined(IR_SMALLD_NEC)    || defined(IR_SMALLD_NECx)
-  #define IR_ISR_MODE  RISING
+  #define IR_FSM_EDGE  RISING
 
-#elif defined(IR_SMALLD_RC5)
+#elif defined(IR_SMALLD_RC5)   || defined(IR_SMALLD_HASH)
   #define IR_ISR_MODE  CHANGE
 
 #else
   #error IR_ISR_MODE not defined.
 #endif
 
+#if defined(IR_FSM_EDGE)
+  #if defined(IR_SMALLD_DUAL_EDGE)
+    #define IR_ISR_MODE  CHANGE
+  #else
+    #define IR_ISR_MODE  IR_FSM_EDGE
+  #endif
+#elif defined(IR_SMALLD_DUAL_EDGE)
+  #error IR_SMALLD_DUAL_EDGE is not available for RC5 and HASH (they already use both edges)
+#endif
+
 
 // ****************************************************************************
 // Set the ISR memory attribute (for fast execution) according to the MCU type:
@@ -88,6 +249,47 @@
 #endif
 
 
+// ****************************************************************************
+// Address filter (if IR_SMALLD_ADDRESS_FILTER is defined as a comma separated list of addresses):
+// The ISRs check the address as soon as all of its bits are received, and frames from other remotes are discarded
+// without being published (and the rest of the frame is ignored). The list is expanded into a chain of comparisons.
+#if defined(IR_SMALLD_ADDRESS_FILTER)
+  #if defined(IR_SMALLD_HASH)
+    #error IR_SMALLD_ADDRESS_FILTER is not available for the HASH decoder (it has no address)
+  #endif
+  inline bool IR_ISR_ATTR irSmallD_addressIn(uint16_t) { return false; }
+  template <typename... Others>
+  inline bool IR_ISR_ATTR irSmallD_addressIn(uint16_t addr, uint16_t first, Others... others) {
+    return addr == first || irSmallD_addressIn(addr, others...);
+  }
+  #define ADDRESS_ALLOWED(addr)  irSmallD_addressIn(addr, IR_SMALLD_ADDRESS_FILTER)
+#else
+  #define ADDRESS_ALLOWED(addr)  ((void)(addr), true)
+#endif
+
+
+// ****************************************************************************
+// Notification hook, used by waitForData():
+// IR_SMALLD_NOTIFY() is called by the ISR when new data becomes available, and IR_SMALLD_WAIT(us) is called
+// by waitForData() to sleep until that happens (or until the given time has passed, whichever comes first).
+// They can be defined before the #include <IRsmallDecoder.h> (e.g. with a semaphore or a condition variable),
+// or IR_SMALLD_FREERTOS_NOTIFY can be defined to use FreeRTOS direct-to-task notifications (ESP32).
+// If they are not defined, the ISR is not changed at all and waitForData() just polls the decoder.
+#if defined(IR_SMALLD_FREERTOS_NOTIFY)
+  #define IR_SMALLD_NOTIFY()  { BaseType_t woken = pdFALSE;                      \
+                                if (_waitingTask) {                              \
+                                  vTaskNotifyGiveFromISR(_waitingTask, &woken);  \
+                                  if (woken) portYIELD_FROM_ISR();               \
+                                } }
+  // Rounded up to whole ticks, so that a wait shorter than a tick (e.g. 1ms at 100Hz) doesn't become a poll:
+  #define IR_SMALLD_WAIT(us)  ulTaskNotifyTake(pdTRUE, (TickType_t)(((uint64_t)(us) * configTICK_RATE_HZ + 999999) / 1000000))
+#endif
+
+#if !defined(IR_SMALLD_WAIT)
+  #define IR_SMALLD_WAIT(us)  ((void)(us), yield())  // Just polls (the time is only used by a real wait)
+#endif
+
+
 // ****************************************************************************
 // By default, a timeout will be used (if IR_SMALLD_NO_TIMEOUT is not defined).
 // Timeout value is in microseconds.
@@ -103,6 +305,11 @@
   #define IR_SMALLD_TIMEOUT 2160    // =ceil(1800 x 1.2)    // max time between events = 1800 µs (@IR fall -> I/O input rise)
 #elif defined(IR_SMALLD_SIRC)
   #define IR_SMALLD_TIMEOUT 37440   // =ceil(31200 x 1.2)   // max time between events = 31200 µs (@IR fall -> I/O input rise)
+#elif defined(IR_SMALLD_HASH)
+  #define IR_SMALLD_TIMEOUT 20000   // minimum gap between frames (the timeout is what ends a frame)
+  #if defined(IR_SMALLD_NO_TIMEOUT)
+    #warning "Without the timeout, each HASH frame will only be available after the next frame begins"
+  #endif
 #else
   #error Timeout not defined.
 #endif
@@ -115,7 +322,26 @@
  */
 class IRsmallDecoder {
   private:
-    static void irISR();
+    IR_ISR_TEMPLATE static void irISR();
+    #if defined(IR_SMALLD_DIVERSITY)
+      template <uint8_t receiver> static void irISRreceiver();  // calls irISR<receiver>() with its FSM registers
+      template <uint8_t receiver> static void resetReceiver(bool onTimeout);  // resets its FSM (if timed out)
+      static bool sameFrame();              // compares the new frame with the last one
+    #elif defined(IR_SMALLD_MULTICORE)
+      static void irISRmulticore();         // calls irISR() with the FSM locked, and publishes the data
+      static bool lockFSM();                // try-lock, false if the FSM is being used by the other core
+      static void unlockFSM();              // publishes the data, and decodes the edges queued by the ISR (if any)
+      static bool edgePending(uint32_t &time);  // true (and its time) if the ISR queued an edge
+      static bool decodePendingEdge();      // decodes the oldest edge queued while the FSM was locked (if any)
+      static void publishData();            // copies _irData to _sharedData (seqlock writer)
+      static bool readData(irSmallD_t &irData);  // copies _sharedData, if it has new data (seqlock reader)
+    #elif defined(IR_SMALLD_NOTIFY)
+      static void irISRnotify();            // calls irISR() and the notification hook
+    #endif
+    #if defined(IR_SMALLD_RECORDER)
+      static void irISRrecorder();          // records the edge, then calls irISR() (or irISRnotify())
+      static void recordEdge();             // adds the edge to the ring buffer
+    #endif
     void resetFSM();                        // used by enable() and checkTimeout() methods
     void checkTimeout();                    // used by dataAvailable() method
     static volatile bool _irDataAvailable;  // will be updated by the ISR
@@ -123,14 +349,108 @@ class IRsmallDecoder {
     static volatile uint8_t _state;         // will be updated and used by the ISR (and timeout)
     static volatile uint32_t _previousTime; // will be updated and used by the ISR (and timeout)
     static bool _irCopyingData;             // used by the ISR but not changed by it, no need for volatile
-    uint8_t _irInterruptNum;                // used by enable/disable Decoder methods
+    #if defined(IR_SMALLD_TIMESTAMPS)
+      static uint32_t _frameStart;          // only used by the ISR
+    #endif
+    #if defined(IR_SMALLD_QUALITY)
+      static uint16_t _qualitySum;          // sum of the deviations of the frame's marks (only used by the ISR)
+      static uint16_t _qualityMax;          // largest deviation (only used by the ISR)
+      static uint16_t _qualityMargin;       // smallest margin (only used by the ISR)
+      static uint8_t  _qualityCount;        // number of marks (only used by the ISR)
+      static void addQualitySample(uint16_t duration, uint16_t nominal, uint16_t minimum, uint16_t maximum);
+      static void summarizeQuality(irSmallD_t &irData);  // used by dataAvailable()
+    #endif
+    #if defined(IR_SMALLD_FREERTOS_NOTIFY)
+      static volatile TaskHandle_t _waitingTask;  // task to be notified by the ISR
+    #endif
+    #if defined(IR_SMALLD_RECORDER)
+      static uint8_t _recBuffer[IR_SMALLD_RECORDER_SIZE];  // varint encoded records (ring buffer)
+      static uint16_t _recHead;             // where the next record will be written
+      static uint16_t _recUsed;             // bytes in use (the oldest record is _recUsed bytes behind _recHead)
+      static uint32_t _recTime;             // time of the last record (rounded to the recorder's units)
+      static uint8_t _recLevel;             // level after the last edge (only meaningful in CHANGE mode)
+      static uint8_t _recOldestLevel;       // level after the oldest recorded edge
+      static volatile bool _recFrozen;      // recording stopped by freezeRecorder() (or by an error)
+      #if defined(IR_SMALLD_RECORDER_FREEZE_ON_ERROR)
+        static uint8_t _recFrameEdges;      // edges since the FSM left the standby state
+      #endif
+    #endif
+    #if defined(IR_SMALLD_DIVERSITY)
+      struct fsmRegisters_t {               // a receiver's copy of the FSM registers shared by the ISRs
+        uint8_t  state = 0;
+        uint32_t previousTime = UINT32_MAX;  // as _previousTime
+        #if defined(IR_SMALLD_TIMESTAMPS)
+          uint32_t frameStart = 0;
+        #endif
+        #if defined(IR_SMALLD_QUALITY)
+          uint16_t qualitySum = 0, qualityMax = 0, qualityMargin = UINT16_MAX;
+          uint8_t  qualityCount = 0;
+        #endif
+      };
+      static fsmRegisters_t _receiverFSM[2];  // only used by the ISRs (and by the resets, with interrupts disabled)
+      static irSmallD_t _lastFrame;         // last frame that was not a duplicate
+      static uint32_t _lastFrameTime;       // time of its last edge
+      static uint8_t _lastReceiver;         // receiver that won it
+      static volatile uint32_t _receiverWins[2];  // number of frames won by each receiver
+      static volatile uint32_t _duplicates; // number of frames received by both (and discarded once)
+    #endif
+    #if defined(IR_SMALLD_MULTICORE)
+      // With the FSM locked, _irData and _irDataAvailable are only the ISR's staging area:
+      enum { c_sharedWords = (sizeof(irSmallD_t) + 3) / 4 };
+      static std::atomic<bool> _fsmLocked;          // the ISR or the timeout reset is running the FSM
+      static std::atomic<uint32_t> _pendingHead;    // edges queued by the ISR while the FSM was locked (ISR only)
+      static std::atomic<uint32_t> _pendingTail;    // queued edges decoded (with the FSM locked)
+      static std::atomic<uint32_t> _pendingTime[IR_SMALLD_PENDING_EDGES];  // times of the queued edges
+      static std::atomic<bool> _fsmBusy;            // copy of (_state != 0), updated when the FSM is unlocked
+      static std::atomic<uint32_t> _fsmTime;        // copy of _previousTime, updated when the FSM is unlocked
+      static std::atomic<uint32_t> _sequence;       // odd while _sharedData is being written, +2 for each frame
+      static std::atomic<uint32_t> _sharedData[c_sharedWords];  // last published frame
+      static uint32_t _isrTime;                     // time used by the ISR instead of micros() (FSM locked)
+      static uint32_t _readSequence;                // _sequence of the last frame read (only used by the consumer)
+    #endif
+    #if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+      static volatile uint32_t _edgeTime;   // time of the edge being decoded (used by the ISR instead of micros())
+      bool _enabled;                        // used by enable/disable Decoder methods
+    #endif
+    #if defined(IR_SMALLD_SAMPLING)
+      uint8_t _irPin;                       // used by sample()
+      uint8_t _sampledLevel;                // level read by the previous sample() call
+    #elif not defined(IR_SMALLD_EDGE_BUFFER)
+      uint8_t _irInterruptNum;              // used by enable/disable Decoder methods
+    #endif
+    #if defined(IR_SMALLD_DIVERSITY)
+      uint8_t _irInterruptNum2;             // second receiver's interrupt
+    #endif
     
   public:
-    IRsmallDecoder(uint8_t interruptPin);
+    #if defined(IR_SMALLD_EDGE_BUFFER)
+      IRsmallDecoder();
+      void decodeBuffer(const irSmallD_pulse_t *pulses, uint16_t count, uint32_t startTime);
+    #elif defined(IR_SMALLD_DIVERSITY)
+      IRsmallDecoder(uint8_t interruptPin, uint8_t interruptPin2);
+      uint32_t receiverWins(uint8_t receiver);  // frames won by receiver 0 or 1 (received first, or only by it)
+      uint32_t duplicateFrames();           // frames received by both receivers
+    #else
+      IRsmallDecoder(uint8_t interruptPin);
+    #endif
+    #if defined(IR_SMALLD_SAMPLING)
+      void sample();
+      void sample(uint8_t level);           // for levels read by other means (e.g. direct port access)
+    #endif
+    #if defined(IR_SMALLD_RECORDER)
+      void freezeRecorder();                // stops recording, keeping the recorded edges
+      void resumeRecorder();
+      bool recorderFrozen();
+      void clearRecorder();
+      void dumpRecorder(Print &output);     // prints the recording, for the host tools
+    #endif
     void disable();
     void enable(); 
     bool dataAvailable(irSmallD_t &irData);
     bool dataAvailable();                   // method overloading
+    bool waitForData(irSmallD_t &irData, uint32_t timeoutUs);
+    bool isIdle();                          // no frame is being received (the FSM is in standby)
+    bool nextDeadline(uint32_t &deadline);  // when the frame being received will time out (false if none)
 };
 
 
@@ -142,10 +462,275 @@ volatile irSmallD_t IRsmallDecoder::_irData;             // data structure to ho
 volatile uint8_t IRsmallDecoder::_state = 0;             // FSM satate (0=standby, in any of the FSMs)
 volatile uint32_t IRsmallDecoder::_previousTime = UINT32_MAX; // not ini with 0, that would cause an issue in the RC5 decoder
 bool IRsmallDecoder::_irCopyingData = false;             // used to avoid volatile _irData corruption by the ISR
+#if defined(IR_SMALLD_TIMESTAMPS)
+  uint32_t IRsmallDecoder::_frameStart = 0;              // time of the first edge of the frame being received
+#endif
+#if defined(IR_SMALLD_QUALITY)
+  uint16_t IRsmallDecoder::_qualitySum = 0;              // the quality accumulators are reset at the start of each frame
+  uint16_t IRsmallDecoder::_qualityMax = 0;
+  uint16_t IRsmallDecoder::_qualityMargin = UINT16_MAX;
+  uint8_t  IRsmallDecoder::_qualityCount = 0;
+#endif
+#if defined(IR_SMALLD_FREERTOS_NOTIFY)
+  volatile TaskHandle_t IRsmallDecoder::_waitingTask = NULL;  // set by waitForData()
+#endif
+#if defined(IR_SMALLD_DIVERSITY)
+  IRsmallDecoder::fsmRegisters_t IRsmallDecoder::_receiverFSM[2];  // both in standby
+  irSmallD_t IRsmallDecoder::_lastFrame;
+  uint32_t IRsmallDecoder::_lastFrameTime = 0;
+  uint8_t IRsmallDecoder::_lastReceiver = UINT8_MAX;     // none yet
+  volatile uint32_t IRsmallDecoder::_receiverWins[2] = {0, 0};
+  volatile uint32_t IRsmallDecoder::_duplicates = 0;
+#endif
+#if defined(IR_SMALLD_RECORDER)
+  uint8_t IRsmallDecoder::_recBuffer[IR_SMALLD_RECORDER_SIZE];
+  uint16_t IRsmallDecoder::_recHead = 0;
+  uint16_t IRsmallDecoder::_recUsed = 0;
+  uint32_t IRsmallDecoder::_recTime = 0;
+  uint8_t IRsmallDecoder::_recLevel = HIGH;              // the receiver's output is high when idle
+  uint8_t IRsmallDecoder::_recOldestLevel = LOW;
+  volatile bool IRsmallDecoder::_recFrozen = false;
+  #if defined(IR_SMALLD_RECORDER_FREEZE_ON_ERROR)
+    uint8_t IRsmallDecoder::_recFrameEdges = 0;
+  #endif
+#endif
+#if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+  volatile uint32_t IRsmallDecoder::_edgeTime = 0;       // set by decodeBuffer() and resetFSM(), or by sample()
+#endif
+#if defined(IR_SMALLD_MULTICORE)
+  std::atomic<bool> IRsmallDecoder::_fsmLocked(false);
+  std::atomic<uint32_t> IRsmallDecoder::_pendingHead(0);
+  std::atomic<uint32_t> IRsmallDecoder::_pendingTail(0);
+  std::atomic<uint32_t> IRsmallDecoder::_pendingTime[IR_SMALLD_PENDING_EDGES];  // zero initialized (static)
+  std::atomic<bool> IRsmallDecoder::_fsmBusy(false);
+  std::atomic<uint32_t> IRsmallDecoder::_fsmTime(0);
+  std::atomic<uint32_t> IRsmallDecoder::_sequence(0);
+  std::atomic<uint32_t> IRsmallDecoder::_sharedData[IRsmallDecoder::c_sharedWords];  // zero initialized (static)
+  uint32_t IRsmallDecoder::_isrTime = 0;
+  uint32_t IRsmallDecoder::_readSequence = 0;
+#endif
+
+
+// ****************************************************************************
+// ISR to be attached (with or without the notification hook):
+#if defined(IR_SMALLD_DIVERSITY)
+  #define IR_ISR_FUNCTION irISRreceiver<0>  // and irISRreceiver<1> for the second receiver
+#elif defined(IR_SMALLD_MULTICORE)
+  #define IR_ISR_FUNCTION irISRmulticore
+#elif defined(IR_SMALLD_RECORDER)
+  #define IR_ISR_FUNCTION irISRrecorder  // which calls irISRnotify() if the notification hook is defined
+#elif defined(IR_SMALLD_NOTIFY)
+  #define IR_ISR_FUNCTION irISRnotify
+#else
+  #define IR_ISR_FUNCTION irISR
+#endif
+
+// Time of the edge that triggered the ISR, and the current time (the sampling mode has its own clock):
+#if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+  #define IR_ISR_MICROS()  _edgeTime
+#elif defined(IR_SMALLD_MULTICORE)
+  #define IR_ISR_MICROS()  _isrTime
+#else
+  #define IR_ISR_MICROS()  micros()
+#endif
+#if defined(IR_SMALLD_SAMPLING)
+  #define IR_SMALLD_CLOCK()  _edgeTime
+#else
+  #define IR_SMALLD_CLOCK()  micros()
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Interval measured by the ISRs (the duration since the previous edge; HASH keeps its own 32-bit interval):
+// On 8-bit AVRs each 32-bit operation takes 4 instructions (and 4 registers), but only the gaps can exceed 65ms. So,
+// the fast path reads the clock once, keeps the interval in 16 bits (saturated at IR_DURATION_MAX) and remembers the
+// overflow in the high word of irElapsed. IR_DURATION_ABOVE() is only needed for limits above 65535µs, which it
+// compares in 256µs units. It's only enabled by defining IR_SMALLD_AVR_FAST, until footprint.sh has measured it.
+#if defined(IR_SMALLD_AVR_FAST)
+  typedef uint16_t irDuration_t;
+  #define IR_DURATION_MAX  0xFFFF
+  #define IR_MEASURE_DURATION(duration)              \
+    uint32_t irNow = IR_ISR_MICROS();               \
+    uint32_t irElapsed = irNow - _previousTime;     \
+    _previousTime = irNow;                          \
+    duration = (irElapsed >> 16) ? IR_DURATION_MAX : (irDuration_t)irElapsed
+  #define IR_DURATION_ABOVE(duration, limit)         \
+    ((duration) == IR_DURATION_MAX && ((irElapsed >> 24) || (uint16_t)(irElapsed >> 8) > (uint16_t)((limit) >> 8)))
+#else
+  typedef uint32_t irDuration_t;
+  #define IR_MEASURE_DURATION(duration)              \
+    duration = IR_ISR_MICROS() - _previousTime;     \
+    _previousTime = IR_ISR_MICROS()
+  #define IR_DURATION_ABOVE(duration, limit)  ((duration) > (uint32_t)(limit))
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Repetition gate (used by the ISRs of the decoders with possiblyHeld, if IR_SMALLD_HOLD_GATE is defined):
+// While a key is held, each repetition starts one repetition period after the previous frame (or repeat code)
+// started. So, when a frame ends with possiblyHeld, IR_GATE_CLOSE() predicts the gap until the next repetition (the
+// minimum period minus the frame's length, but never less than the decoder's minimum gap), and IR_MEASURE_GATED()
+// returns from the ISR, with a single comparison and before _previousTime is updated, for the edges that come
+// earlier: noise between frames no longer shortens the next gap or clears possiblyHeld. IR_GATE_OPEN(), at the top
+// of the standby state, removes the gate (the first edge that passes it) and marks the possible start of a frame.
+#if defined(IR_SMALLD_HOLD_GATE)
+  #define IR_GATE_VARIABLES()  static uint32_t irGate, irFrameStart  // (zero-initialized: no gate)
+  #if defined(IR_SMALLD_AVR_FAST)
+    #define IR_MEASURE_GATED(duration)               \
+      uint32_t irNow = IR_ISR_MICROS();             \
+      uint32_t irElapsed = irNow - _previousTime;   \
+      if (irElapsed < irGate) return;               \
+      _previousTime = irNow;                        \
+      duration = (irElapsed >> 16) ? IR_DURATION_MAX : (irDuration_t)irElapsed
+  #else
+    #define IR_MEASURE_GATED(duration)               \
+      duration = IR_ISR_MICROS() - _previousTime;   \
+      if (duration < irGate) return;                \
+      _previousTime += duration
+  #endif
+  #define IR_GATE_OPEN()  {irGate = 0; irFrameStart = _previousTime;}
+  #define IR_GATE_CLOSE(periodMin, gapMin)                                                                  \
+            {uint32_t irLength = _previousTime - irFrameStart;                                              \
+             irGate = (irLength < (uint32_t)(periodMin) - (gapMin)) ? (uint32_t)(periodMin) - irLength : (gapMin);}
+#else
+  #define IR_GATE_VARIABLES()                //nothing
+  #define IR_MEASURE_GATED(duration)         IR_MEASURE_DURATION(duration)
+  #define IR_GATE_OPEN()                     //nothing
+  #define IR_GATE_CLOSE(periodMin, gapMin)   //nothing
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Dual-edge validation (used by the NEC, SIRC and SAMSUNG ISRs, if IR_SMALLD_DUAL_EDGE is defined):
+// With a single edge per mark, the FSMs only see the sum of each pulse and space, so interference with the right
+// period passes as a bit. In dual-edge mode, IR_DUAL_EDGE() measures the pulse (the time between a falling and the
+// next rising edge) into irPulse, and returns from the ISR on the edge that isn't IR_FSM_EDGE, so the FSMs still run
+// once per mark and can reject the mark as soon as IR_PULSE_OUTSIDE() or IR_SPACE_OUTSIDE() (the rest of the mark).
+// The edges' polarity isn't read from the pin: the edges alternate, and a "pulse" longer than pulseLimit (the
+// longest pulse of the protocol) was a space, so it ends with a falling edge. After a lost edge, the frame is
+// rejected and the polarity is right again after the next gap.
+#if defined(IR_SMALLD_DUAL_EDGE)
+  #define IR_DUAL_EDGE(pulseLimit)                                                                  \
+    static bool irInPulse;                                                                         \
+    static uint32_t irPulseStart;                                                                  \
+    static uint16_t irPulse;                                                                       \
+    {                                                                                              \
+      uint32_t irEdgeTime = IR_ISR_MICROS();                                                       \
+      if (irInPulse && irEdgeTime - irPulseStart <= (uint16_t)(pulseLimit)) {  /* Rising edge */   \
+        irInPulse = false;                                                                         \
+        irPulse = irEdgeTime - irPulseStart;                                                       \
+        if (IR_FSM_EDGE == FALLING) return;                                                        \
+      } else {                                                                 /* Falling edge */  \
+        if (irInPulse) irPulse = UINT16_MAX;  /* The previous pulse never ended (it was a space) */ \
+        irInPulse = true;                                                                          \
+        irPulseStart = irEdgeTime;                                                                 \
+        if (IR_FSM_EDGE == RISING) return;                                                         \
+      }                                                                                            \
+    }
+  #define IR_PULSE_OUTSIDE(minimum, maximum)           (irPulse < (minimum) || irPulse > (maximum))
+  #define IR_SPACE_OUTSIDE(duration, minimum, maximum)  \
+            ((duration) - irPulse < (minimum) || (duration) - irPulse > (maximum))  // (a negative space is outside)
+#else
+  #define IR_DUAL_EDGE(pulseLimit)                      //nothing
+  #define IR_PULSE_OUTSIDE(minimum, maximum)            false
+  #define IR_SPACE_OUTSIDE(duration, minimum, maximum)  false
+#endif
 
 
 // ****************************************************************************
 // Decoder's Methods Implementation
+#if defined(IR_SMALLD_SAMPLING)
+/**
+ * IRsmallDecoder object constructor (sampling mode)
+ * 
+ * @param interruptPin is the digital pin where the IR receiver is connected (it doesn't need to support interrupts)
+ */
+IRsmallDecoder::IRsmallDecoder(uint8_t interruptPin) {
+  pinMode(interruptPin,INPUT_PULLUP);  //active low
+  _irPin = interruptPin;
+  _sampledLevel = HIGH;
+  _enabled = true;
+}
+
+
+/**
+ * Reads the input pin and, if its level changed, calls the ISR (if the edge matches its mode).
+ * It must be called every IR_SMALLD_SAMPLE_PERIOD microseconds, usually from a timer interrupt.
+ * The timeout is also checked here, since the durations are measured by counting the calls.
+ */
+void IR_ISR_ATTR IRsmallDecoder::sample() {
+  this->sample(digitalRead(_irPin));
+}
+
+
+/**
+ * Same as sample(), but with a level that was read by the caller.
+ * 
+ * @param level the current level of the input pin (HIGH or LOW).
+ */
+void IR_ISR_ATTR IRsmallDecoder::sample(uint8_t level) {
+  if (!_enabled) return;
+  _edgeTime += IR_SMALLD_SAMPLE_PERIOD;
+  if (level != _sampledLevel) {
+    _sampledLevel = level;
+    if (IR_ISR_MODE == CHANGE || (IR_ISR_MODE == RISING) == (level == HIGH)) IR_ISR_FUNCTION();
+  }
+  #if not defined(IR_SMALLD_NO_TIMEOUT)
+    else if (_state && (uint32_t)(_edgeTime - _previousTime) >= (uint32_t)IR_SMALLD_TIMEOUT) {
+      DBG_PRINT_STATE("\nTIMEOUT\n");
+      this->resetFSM();  // Put the FSM in Standby state
+    }
+  #endif
+}
+
+#elif defined(IR_SMALLD_DIVERSITY)
+/**
+ * IRsmallDecoder object constructor (receiver diversity)
+ * 
+ * @param interruptPin is the digital pin where the first IR receiver (receiver 0) is connected.
+ * @param interruptPin2 is the digital pin where the second IR receiver (receiver 1) is connected.
+ *   Both pins must support external interrupts.
+ */
+IRsmallDecoder::IRsmallDecoder(uint8_t interruptPin, uint8_t interruptPin2) {
+  pinMode(interruptPin,INPUT_PULLUP);  //active low
+  pinMode(interruptPin2,INPUT_PULLUP);
+  _irInterruptNum = digitalPinToInterrupt(interruptPin);
+  _irInterruptNum2 = digitalPinToInterrupt(interruptPin2);
+  attachInterrupt(_irInterruptNum, irISRreceiver<0>, IR_ISR_MODE);
+  attachInterrupt(_irInterruptNum2, irISRreceiver<1>, IR_ISR_MODE);
+}
+
+
+/**
+ * Informs how many frames were won by a receiver, i.e., received by it first (or only by it).
+ * Comparing both receivers' wins helps to find the best placement for each of them.
+ * 
+ * @param receiver 0 for the receiver on the first pin, 1 for the other.
+ * @return number of frames won by that receiver since the decoder was created.
+ */
+uint32_t IRsmallDecoder::receiverWins(uint8_t receiver) {
+  uint32_t wins;
+  noInterrupts();  // Not an atomic copy on many microcontrollers
+  wins = _receiverWins[receiver ? 1 : 0];
+  interrupts();
+  return wins;
+}
+
+
+/**
+ * Informs how many frames were received by both receivers (the second copy of each is discarded).
+ * 
+ * @return number of duplicates since the decoder was created.
+ */
+uint32_t IRsmallDecoder::duplicateFrames() {
+  uint32_t duplicates;
+  noInterrupts();
+  duplicates = _duplicates;
+  interrupts();
+  return duplicates;
+}
+
+#elif not defined(IR_SMALLD_EDGE_BUFFER)
 /**
  * IRsmallDecoder object constructor
  * 
@@ -159,22 +744,94 @@ IRsmallDecoder::IRsmallDecoder(uint8_t interruptPin) {
   #else
     _irInterruptNum = digitalPinToInterrupt(interruptPin);
   #endif
-  attachInterrupt(_irInterruptNum, irISR, IR_ISR_MODE);
+  attachInterrupt(_irInterruptNum, IR_ISR_FUNCTION, IR_ISR_MODE);
+}
+
+#else
+/**
+ * IRsmallDecoder object constructor (edge buffer input; the input pin is handled by the peripheral)
+ */
+IRsmallDecoder::IRsmallDecoder() {
+  _enabled = true;
+}
+
+
+/**
+ * Decodes a buffer of pulse/space durations, by calling the ISR for each edge that matches its mode.
+ * It can be called from an interrupt (e.g. a RMT or DMA callback) or from the main loop/task.
+ * 
+ * @param pulses Level and duration (µs) of each pulse and space, in the order they were received.
+ * @param count Number of items in the buffer (it stops earlier if it finds a zero duration).
+ * @param startTime micros() value of the first edge (the beginning of the first item). It's used to measure
+ *   the gap from the previous buffer, which some decoders need in order to detect the start of a frame.
+ */
+void IR_ISR_ATTR IRsmallDecoder::decodeBuffer(const irSmallD_pulse_t *pulses, uint16_t count, uint32_t startTime) {
+  if (!_enabled || count == 0) return;
+  _edgeTime = startTime;  // The first edge leads to the level of the first item
+  if (IR_ISR_MODE == CHANGE || (IR_ISR_MODE == RISING) == (pulses[0].level == HIGH)) IR_ISR_FUNCTION();
+  for (uint16_t i = 0; i < count && pulses[i].duration; i++) {
+    _edgeTime += pulses[i].duration;  // At the end of each item, the level changes (LOW to HIGH is a rising edge)
+    if (IR_ISR_MODE == CHANGE || (IR_ISR_MODE == RISING) == (pulses[i].level == LOW)) IR_ISR_FUNCTION();
+  }
 }
+#endif
 
 
 /**
  * Reset the ISR's FSM, transitioning it to the Standby state.
  */
+#if defined(IR_SMALLD_DIVERSITY)
 void IRsmallDecoder::resetFSM() {
+  resetReceiver<0>(false);  // Both receivers' FSMs
+  resetReceiver<1>(false);
+}
+
+#else
+void IRsmallDecoder::resetFSM() {
+  #if defined(IR_SMALLD_EDGE_BUFFER)
+    _edgeTime = micros();
+  #elif defined(IR_SMALLD_MULTICORE)
+    while (!lockFSM());  // The ISR only keeps it for a few microseconds
+    while (decodePendingEdge());
+    _isrTime = micros();
+  #endif
   this->irISR();  // two consecutive calls will place any of the FSMs in standby state
   this->irISR();  // forced _state=0 will not work with computed GOTOs based FSMs
+  #if defined(IR_SMALLD_MULTICORE)
+    unlockFSM();
+  #endif
 }
+#endif
 
 
 /**
  * Checks if the FSM is in a non-standby state for too long and resets it if necessary.
  */
+#if defined(IR_SMALLD_DIVERSITY)
+void IRsmallDecoder::checkTimeout() {
+  resetReceiver<0>(true);  // Each receiver's FSM has its own timeout
+  resetReceiver<1>(true);
+}
+
+#elif defined(IR_SMALLD_MULTICORE)
+void IRsmallDecoder::checkTimeout() {
+  uint32_t now = micros();
+  // The FSM is only locked when a timeout is due (while it's locked, the ISR can only leave one edge for later):
+  if (!_fsmBusy.load(std::memory_order_relaxed) ||
+      (uint32_t)(now - _fsmTime.load(std::memory_order_relaxed)) < (uint32_t)IR_SMALLD_TIMEOUT) return;
+  if (!lockFSM()) return;  // The ISR is running, so it's not a timeout
+  uint32_t pendingTime;
+  while (edgePending(pendingTime) && (int32_t)(pendingTime - now) <= 0) decodePendingEdge();  // Edges before now come first
+  if (_state && (uint32_t)(now - _previousTime) >= (uint32_t)IR_SMALLD_TIMEOUT) {
+    DBG_PRINT_STATE("\nTIMEOUT\n");
+    _isrTime = now;
+    irISR();  // Put the FSM in Standby state (as in resetFSM(), but the FSM is already locked)
+    irISR();
+  }
+  unlockFSM();  // Edges left after now are decoded after the reset
+}
+
+#else
 void IRsmallDecoder::checkTimeout() {
   if (_state) {                    // If FSM is not in standby state, check for timeout:
     uint32_t prevTimeCopy;
@@ -188,22 +845,38 @@ void IRsmallDecoder::checkTimeout() {
     }
   }
 }
+#endif
 
 /**
  * Enables the decoder by reattaching the ISR to the hardware interrupt (and resets the FSM).
  */
 void IRsmallDecoder::enable() {
-  attachInterrupt(_irInterruptNum, irISR, IR_ISR_MODE);  //interrupt flag may already be set
-  // if so, ISR will be immediately executed and the FSM jumps out of standby state
+  #if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+    _enabled = true;
+  #else
+    attachInterrupt(_irInterruptNum, IR_ISR_FUNCTION, IR_ISR_MODE);  //interrupt flag may already be set
+    // if so, ISR will be immediately executed and the FSM jumps out of standby state
+    #if defined(IR_SMALLD_DIVERSITY)
+      attachInterrupt(_irInterruptNum2, irISRreceiver<1>, IR_ISR_MODE);
+    #endif
+  #endif
   this->resetFSM();  // Put the FSM in Standby state
 }
 
 
 /**
  * Disables the decoder, without interfering with other interrupts
+ * (with the edge buffer input or in sampling mode, decodeBuffer() or sample() will do nothing until enable() is called)
  */
 void IRsmallDecoder::disable() {
-  detachInterrupt(_irInterruptNum);
+  #if defined(IR_SMALLD_EDGE_BUFFER) || defined(IR_SMALLD_SAMPLING)
+    _enabled = false;
+  #else
+    detachInterrupt(_irInterruptNum);
+    #if defined(IR_SMALLD_DIVERSITY)
+      detachInterrupt(_irInterruptNum2);
+    #endif
+  #endif
 }
 
 
@@ -214,11 +887,14 @@ void IRsmallDecoder::disable() {
  * @return true if new data was decoded and retrieved; false if not.
  */
 bool IRsmallDecoder::dataAvailable(irSmallD_t &irData) {
-  // Check Timeout (resets the FSM if necessary):
-  #if not defined(IR_SMALLD_NO_TIMEOUT)
+  // Check Timeout (resets the FSM if necessary; in sampling mode, it's done by sample()):
+  #if not defined(IR_SMALLD_NO_TIMEOUT) && not defined(IR_SMALLD_SAMPLING)
     this->checkTimeout();
   #endif
   // Copy data if available:
+  #if defined(IR_SMALLD_MULTICORE)
+  if (readData(irData)) {
+  #else
   if (_irDataAvailable) {
     _irCopyingData = true;     // Let the ISR know that it cannot change the data while it's being copied.
     memcpy(&irData, (void*)&_irData, sizeof(_irData));  // This is not an atomic operation; the ISR could potentially corrupt the data.
@@ -226,6 +902,13 @@ bool IRsmallDecoder::dataAvailable(irSmallD_t &irData) {
     _irCopyingData = false;    // interrupts method, it could unnecessarily keep the ISR from determining the exact intervals  
     // between the signals pulses (memcpy() may take a few microseconds to execute). And besides, it should rarely happen that the
     // ISR is replacing existing data that was not retrieved yet. Unless the user is not polling the dataAvailable() frequently enough.
+  #endif
+    #if defined(IR_SMALLD_TIMESTAMPS)
+      irData.latency = IR_SMALLD_CLOCK() - irData.time;  // How long the data waited to be retrieved
+    #endif
+    #if defined(IR_SMALLD_QUALITY)
+      summarizeQuality(irData);
+    #endif
     return true;
   } else return false;
 }
@@ -238,17 +921,460 @@ bool IRsmallDecoder::dataAvailable(irSmallD_t &irData) {
  */
 bool IRsmallDecoder::dataAvailable() {
   // Check Timeout and reset FSM if necessary:
-  #if not defined(IR_SMALLD_NO_TIMEOUT)
+  #if not defined(IR_SMALLD_NO_TIMEOUT) && not defined(IR_SMALLD_SAMPLING)
     this->checkTimeout();
   #endif
   // Check data availability:
+  #if defined(IR_SMALLD_MULTICORE)
+    irSmallD_t discarded;
+    return readData(discarded);
+  #else
   if (_irDataAvailable) {
     _irDataAvailable = false;
     return true;
   } else return false;
+  #endif
+}
+
+
+/**
+ * Waits until there's new decoded data and retrieves it, or until the timeout expires.
+ * It sleeps between checks if a notification hook is defined; otherwise, it keeps polling the decoder.
+ * 
+ * @param irData If new data becomes available, it is "moved" to this data structure.
+ * @param timeoutUs Maximum waiting time, in microseconds.
+ * @return true if new data was decoded and retrieved; false if the timeout expired.
+ */
+bool IRsmallDecoder::waitForData(irSmallD_t &irData, uint32_t timeoutUs) {
+  uint32_t startTime = micros();
+  #if defined(IR_SMALLD_FREERTOS_NOTIFY)
+    _waitingTask = xTaskGetCurrentTaskHandle();
+  #endif
+  bool received;
+  while (!(received = this->dataAvailable(irData))) {
+    uint32_t elapsed = micros() - startTime;
+    if (elapsed >= timeoutUs) break;
+    uint32_t waitTime = timeoutUs - elapsed;
+    #if not defined(IR_SMALLD_NO_TIMEOUT)
+      // If a frame is being received, wake up in time to check the decoder's timeout:
+      #if defined(IR_SMALLD_DIVERSITY)   // _state only holds the FSM registers while an ISR is running
+        if ((_receiverFSM[0].state || _receiverFSM[1].state) && waitTime > (uint32_t)IR_SMALLD_TIMEOUT) waitTime = IR_SMALLD_TIMEOUT;
+      #elif defined(IR_SMALLD_MULTICORE)  // _state can't be read while the ISR is running on the other core
+        if (_fsmBusy.load(std::memory_order_relaxed) && waitTime > (uint32_t)IR_SMALLD_TIMEOUT) waitTime = IR_SMALLD_TIMEOUT;
+      #else
+        if (_state && waitTime > (uint32_t)IR_SMALLD_TIMEOUT) waitTime = IR_SMALLD_TIMEOUT;
+      #endif
+    #endif
+    IR_SMALLD_WAIT(waitTime);
+  }
+  #if defined(IR_SMALLD_FREERTOS_NOTIFY)
+    _waitingTask = NULL;  // The ISR must not notify a task that isn't waiting (or that no longer exists)
+  #endif
+  return received;
+}
+
+
+/**
+ * Checks if the decoder is idle, i.e. if no frame is being received (the FSM, or both FSMs in diversity mode, in
+ * the standby state). When it's idle and there's no data to retrieve, a sketch can sleep until the next edge.
+ * 
+ * @return true if the FSM is in standby.
+ */
+bool IRsmallDecoder::isIdle() {
+  #if defined(IR_SMALLD_DIVERSITY)     // _state only holds the FSM registers while an ISR is running
+    return !_receiverFSM[0].state && !_receiverFSM[1].state;
+  #elif defined(IR_SMALLD_MULTICORE)   // _state can't be read while the ISR is running on the other core
+    return !_fsmBusy.load(std::memory_order_relaxed);
+  #else
+    return !_state;
+  #endif
+}
+
+
+/**
+ * Gets the time when the frame being received will time out, so a sketch can sleep until then (or until the next
+ * edge, whichever comes first). Nothing happens at the deadline by itself: the timeout is only evaluated by the
+ * next dataAvailable() call, so the sketch must call it after waking up (calling it later just resets the FSM later).
+ * 
+ * @param deadline micros() value when the timeout expires (in sampling mode, IR_SMALLD_CLOCK()'s); it's not changed
+ *   if there's no deadline, and it may already be in the past.
+ * @return true if a frame is being received; false if the decoder is idle (or the timeout is disabled).
+ */
+bool IRsmallDecoder::nextDeadline(uint32_t &deadline) {
+  #if defined(IR_SMALLD_NO_TIMEOUT)
+    (void)deadline;
+    return false;
+  #elif defined(IR_SMALLD_DIVERSITY)  // The earliest of the two receivers' deadlines
+    bool pending = false;
+    noInterrupts();                   // The registers are changed by both ISRs
+    for (uint8_t receiver = 0; receiver < 2; receiver++) {
+      if (!_receiverFSM[receiver].state) continue;
+      uint32_t time = _receiverFSM[receiver].previousTime + IR_SMALLD_TIMEOUT;
+      if (!pending || (int32_t)(time - deadline) < 0) deadline = time;
+      pending = true;
+    }
+    interrupts();
+    return pending;
+  #elif defined(IR_SMALLD_MULTICORE)
+    if (!_fsmBusy.load(std::memory_order_relaxed)) return false;
+    deadline = _fsmTime.load(std::memory_order_relaxed) + IR_SMALLD_TIMEOUT;
+    return true;
+  #else
+    noInterrupts();                   // As in checkTimeout(), copying _previousTime is not atomic on many boards
+    bool pending = _state;
+    uint32_t previousTime = _previousTime;
+    interrupts();
+    if (pending) deadline = previousTime + IR_SMALLD_TIMEOUT;
+    return pending;
+  #endif
+}
+
+
+#if defined(IR_SMALLD_DIVERSITY)
+/**
+ * ISR of each receiver: calls the protocol's ISR with the receiver's own FSM registers. If it completes a frame,
+ * the frame is discarded when it's a duplicate (the same frame, just received by the other receiver).
+ */
+template <uint8_t receiver>
+void IR_ISR_ATTR IRsmallDecoder::irISRreceiver() {
+  fsmRegisters_t &fsm = _receiverFSM[receiver];
+  bool dataWasAvailable = _irDataAvailable;
+  _irDataAvailable = false;  // Set by the ISR if this receiver completes a frame
+  _state = fsm.state;
+  _previousTime = fsm.previousTime;
+  #if defined(IR_SMALLD_TIMESTAMPS)
+    _frameStart = fsm.frameStart;
+  #endif
+  #if defined(IR_SMALLD_QUALITY)
+    _qualitySum = fsm.qualitySum;  _qualityMax = fsm.qualityMax;
+    _qualityMargin = fsm.qualityMargin;  _qualityCount = fsm.qualityCount;
+  #endif
+  irISR<receiver>();
+  fsm.state = _state;
+  fsm.previousTime = _previousTime;
+  #if defined(IR_SMALLD_TIMESTAMPS)
+    fsm.frameStart = _frameStart;
+  #endif
+  #if defined(IR_SMALLD_QUALITY)
+    fsm.qualitySum = _qualitySum;  fsm.qualityMax = _qualityMax;
+    fsm.qualityMargin = _qualityMargin;  fsm.qualityCount = _qualityCount;
+  #endif
+
+  if (!_irDataAvailable) {  // No new frame
+    _irDataAvailable = dataWasAvailable;
+  }
+  else if (_lastReceiver == (receiver ^ 1) && sameFrame() &&
+           (uint32_t)(_previousTime - _lastFrameTime) < (uint32_t)IR_SMALLD_DIVERSITY_WINDOW) {  // Duplicate
+    if (dataWasAvailable) memcpy((void*)&_irData, &_lastFrame, sizeof(_irData));  // Not read yet, put it back
+    _irDataAvailable = dataWasAvailable;
+    _duplicates++;
+  }
+  else {  // This receiver won
+    memcpy(&_lastFrame, (void*)&_irData, sizeof(_irData));
+    _lastFrameTime = _previousTime;
+    _lastReceiver = receiver;
+    _receiverWins[receiver]++;
+    #if defined(IR_SMALLD_NOTIFY)
+      if (!dataWasAvailable) { IR_SMALLD_NOTIFY(); }
+    #endif
+  }
+}
+
+
+/**
+ * Resets a receiver's FSM, or only checks its timeout (if onTimeout is true). It's done with interrupts disabled,
+ * since the other receiver's ISR would load its own registers in the middle of it (it only takes long on a reset).
+ */
+template <uint8_t receiver>
+void IRsmallDecoder::resetReceiver(bool onTimeout) {
+  noInterrupts();
+  if (!onTimeout || (_receiverFSM[receiver].state &&
+      (uint32_t)(micros() - _receiverFSM[receiver].previousTime) >= (uint32_t)IR_SMALLD_TIMEOUT)) {
+    if (onTimeout) { DBG_PRINT_STATE("\nTIMEOUT\n"); }
+    irISRreceiver<receiver>();  // two consecutive calls will place any of the FSMs in standby state
+    irISRreceiver<receiver>();
+  }
+  interrupts();
+}
+
+
+/**
+ * Compares the frame that was just decoded with the last frame that was not a duplicate
+ * (only the decoded data, not the timestamps or the signal quality, which are different for each receiver).
+ */
+bool IR_ISR_ATTR IRsmallDecoder::sameFrame() {
+  #if defined(IR_SMALLD_HASH)
+    return _irData.hash == _lastFrame.hash;
+  #else
+    return _irData.addr == _lastFrame.addr && _irData.cmd == _lastFrame.cmd
+      #if defined(IR_SMALLD_SIRC20) || defined(IR_SMALLD_SIRC)
+        && _irData.ext == _lastFrame.ext
+      #endif
+      #if defined(IR_SMALLD_HAS_KEYHELD)
+        && _irData.keyHeld == _lastFrame.keyHeld
+      #endif
+      ;
+  #endif
+}
+
+#elif defined(IR_SMALLD_MULTICORE)
+/**
+ * ISR (multi-core): calls the protocol's ISR with the FSM locked, and publishes the new data (if any).
+ * If the FSM is locked by the timeout reset (on the other core), the edge is left for it to decode.
+ */
+void IR_ISR_ATTR IRsmallDecoder::irISRmulticore() {
+  uint32_t now = micros();
+  if (!lockFSM()) {
+    uint32_t head = _pendingHead.load(std::memory_order_relaxed);
+    if (head - _pendingTail.load(std::memory_order_acquire) < IR_SMALLD_PENDING_EDGES) {  // Else, the edge is dropped
+      _pendingTime[head % IR_SMALLD_PENDING_EDGES].store(now, std::memory_order_relaxed);
+      _pendingHead.store(head + 1, std::memory_order_seq_cst);  // Not release: see unlockFSM()
+    }
+    return;
+  }
+  uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+  while (decodePendingEdge());  // Older edges come first
+  _isrTime = now;
+  irISR();
+  unlockFSM();
+  #if defined(IR_SMALLD_NOTIFY)
+    if (_sequence.load(std::memory_order_relaxed) != sequence) { IR_SMALLD_NOTIFY(); }
+  #else
+    (void)sequence;
+  #endif
+}
+
+
+bool IR_ISR_ATTR IRsmallDecoder::lockFSM() {
+  return !_fsmLocked.exchange(true, std::memory_order_seq_cst);
+}
+
+
+/**
+ * Publishes the new data (if any) and unlocks the FSM. If the ISR queued edges in the meantime,
+ * the FSM is locked again to decode them (there's no one else to do it, until the next edge).
+ * The unlock and the check of the queue are sequentially consistent, as are the ISR's lock and queuing: with
+ * release/acquire, the check could be done before the unlock is seen by the ISR, and both would miss the edge.
+ */
+void IR_ISR_ATTR IRsmallDecoder::unlockFSM() {
+  while (true) {
+    if (_irDataAvailable) publishData();
+    _fsmBusy.store(_state != 0, std::memory_order_relaxed);
+    _fsmTime.store(_previousTime, std::memory_order_relaxed);
+    _fsmLocked.store(false, std::memory_order_seq_cst);
+    uint32_t pendingTime;
+    if (!edgePending(pendingTime) || !lockFSM()) return;  // Nothing left, or the ISR took it
+    while (decodePendingEdge());
+  }
+}
+
+
+bool IR_ISR_ATTR IRsmallDecoder::edgePending(uint32_t &time) {
+  uint32_t tail = _pendingTail.load(std::memory_order_relaxed);
+  if (_pendingHead.load(std::memory_order_seq_cst) == tail) return false;
+  time = _pendingTime[tail % IR_SMALLD_PENDING_EDGES].load(std::memory_order_relaxed);
+  return true;
+}
+
+
+bool IR_ISR_ATTR IRsmallDecoder::decodePendingEdge() {
+  if (!edgePending(_isrTime)) return false;
+  _pendingTail.fetch_add(1, std::memory_order_release);  // The ISR can reuse its slot
+  irISR();
+  if (_irDataAvailable) publishData();
+  return true;
 }
 
 
+/**
+ * Copies the data decoded by the ISR to _sharedData (seqlock writer, always called with the FSM locked).
+ */
+void IR_ISR_ATTR IRsmallDecoder::publishData() {
+  uint32_t words[c_sharedWords] = {0};
+  memcpy(words, (void*)&_irData, sizeof(_irData));
+  _irDataAvailable = false;
+  uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+  _sequence.store(sequence + 1, std::memory_order_relaxed);  // Odd: being written
+  // Release: a reader that loads any of the new words also sees the odd sequence (no standalone fence needed)
+  for (uint8_t i = 0; i < c_sharedWords; i++) _sharedData[i].store(words[i], std::memory_order_release);
+  _sequence.store(sequence + 2, std::memory_order_release);  // Even: done
+  DBG_PRINT_STATE("\nPUBLISHED\n");
+}
+
+
+/**
+ * Copies the last published data, if it wasn't read yet (seqlock reader, it retries if the ISR changed it meanwhile).
+ */
+bool IRsmallDecoder::readData(irSmallD_t &irData) {
+  uint32_t words[c_sharedWords];
+  uint32_t sequence;
+  while (true) {
+    sequence = _sequence.load(std::memory_order_acquire);
+    if (sequence == _readSequence) return false;
+    // Acquire: the sequence is checked again after the words are loaded, so it can't miss a write that changed them
+    for (uint8_t i = 0; i < c_sharedWords; i++) words[i] = _sharedData[i].load(std::memory_order_acquire);
+    if (!(sequence & 1) && _sequence.load(std::memory_order_relaxed) == sequence) break;
+  }
+  #if defined(IRSMALLD_DEBUG_STATE)
+    for (uint32_t n = (sequence - _readSequence) / 2; n > 1; n--) { DBG_PRINT_STATE("\nOVERWRITTEN\n"); }
+  #endif
+  _readSequence = sequence;
+  memcpy(&irData, words, sizeof(irData));
+  return true;
+}
+
+#elif defined(IR_SMALLD_NOTIFY)
+/**
+ * Calls the protocol's ISR and then the notification hook, if new data became available.
+ */
+void IR_ISR_ATTR IRsmallDecoder::irISRnotify() {
+  bool dataWasAvailable = _irDataAvailable;
+  irISR();
+  if (_irDataAvailable && !dataWasAvailable) { IR_SMALLD_NOTIFY(); }
+}
+#endif
+
+
+#if defined(IR_SMALLD_RECORDER)
+/**
+ * ISR (with the edge recorder): records the edge, before the FSM sees it, and then calls the protocol's ISR.
+ * With IR_SMALLD_RECORDER_FREEZE_ON_ERROR, the recording is frozen when the FSM returns to standby without new
+ * data after at least 3 edges (shorter sequences, like noise or NEC's ignored repeat codes, are not errors).
+ */
+void IR_ISR_ATTR IRsmallDecoder::irISRrecorder() {
+  recordEdge();
+  #if defined(IR_SMALLD_RECORDER_FREEZE_ON_ERROR)
+    uint8_t stateBefore = _state;
+    bool dataWasAvailable = _irDataAvailable;
+    _irDataAvailable = false;  // Set by the ISR if it completes a frame
+  #endif
+  #if defined(IR_SMALLD_NOTIFY)
+    irISRnotify();
+  #else
+    irISR();
+  #endif
+  #if defined(IR_SMALLD_RECORDER_FREEZE_ON_ERROR)
+    if (_state) {
+      if (_recFrameEdges < UINT8_MAX) _recFrameEdges++;
+    } else {
+      if (stateBefore && !_irDataAvailable && _recFrameEdges >= 3) _recFrozen = true;  // Error
+      _recFrameEdges = 0;
+    }
+    _irDataAvailable = _irDataAvailable || dataWasAvailable;
+  #endif
+}
+
+
+/**
+ * Adds the edge to the ring buffer (unless it's frozen), dropping the oldest frame(s) to make room for it.
+ */
+void IR_ISR_ATTR IRsmallDecoder::recordEdge() {
+  _recLevel = !_recLevel;  // Only meaningful in CHANGE mode (where every edge is recorded)
+  if (_recFrozen) return;
+
+  uint32_t units = (uint32_t)(IR_ISR_MICROS() - _recTime) >> IR_SMALLD_RECORDER_SHIFT;
+  _recTime += units << IR_SMALLD_RECORDER_SHIFT;  // The rounding errors do not accumulate
+  if (units > 0x7FFFFFFF) units = 0x7FFFFFFF;
+  uint32_t value = (units << 1) | (_state == 0);  // Frame start flag: the FSM is in standby
+  uint8_t record[5];
+  uint8_t length = 0;
+  do {
+    record[length] = value & 0x7F;
+    value >>= 7;
+    if (value) record[length] |= 0x80;  // More bytes follow
+    length++;
+  } while (value);
+
+  // Drop the oldest records (up to the next frame start) until there's room for this one:
+  uint16_t oldest = (_recHead >= _recUsed) ? _recHead - _recUsed : _recHead + IR_SMALLD_RECORDER_SIZE - _recUsed;
+  while (_recUsed + length > IR_SMALLD_RECORDER_SIZE) {
+    do {
+      bool more;
+      do {
+        more = _recBuffer[oldest] & 0x80;
+        if (++oldest == IR_SMALLD_RECORDER_SIZE) oldest = 0;  // Faster than % (on AVR)
+        _recUsed--;
+      } while (more);
+      _recOldestLevel = !_recOldestLevel;
+    } while (_recUsed && !(_recBuffer[oldest] & 0x01));
+  }
+
+  if (!_recUsed) _recOldestLevel = _recLevel;
+  for (uint8_t i = 0; i < length; i++) {
+    _recBuffer[_recHead] = record[i];
+    if (++_recHead == IR_SMALLD_RECORDER_SIZE) _recHead = 0;
+  }
+  _recUsed += length;
+}
+
+
+/**
+ * Stops recording, so that the edges that led to a problem are not overwritten (the decoder keeps working).
+ */
+void IRsmallDecoder::freezeRecorder() {
+  _recFrozen = true;
+}
+
+
+/**
+ * Resumes recording (the first new edge is recorded with the time since the last recorded one).
+ */
+void IRsmallDecoder::resumeRecorder() {
+  _recFrozen = false;
+}
+
+
+/**
+ * Informs if the recording is frozen (by freezeRecorder() or, with IR_SMALLD_RECORDER_FREEZE_ON_ERROR, by an error).
+ */
+bool IRsmallDecoder::recorderFrozen() {
+  return _recFrozen;
+}
+
+
+/**
+ * Discards all the recorded edges.
+ */
+void IRsmallDecoder::clearRecorder() {
+  noInterrupts();
+  _recUsed = 0;
+  interrupts();
+}
+
+
+/**
+ * Prints the recording: a header line, with the interrupt mode, the units and the level after the first edge,
+ * followed by the records in hexadecimal (32 bytes per line). Recording is paused while it's being printed.
+ * The host tools (extras/HostTools) can replay it into the decoders, e.g.: irdecode_nec recording.txt
+ * 
+ * @param output where to print it (e.g. Serial).
+ */
+void IRsmallDecoder::dumpRecorder(Print &output) {
+  bool wasFrozen = _recFrozen;
+  _recFrozen = true;  // The buffer doesn't change while it's frozen
+  output.print(F("#irsmalld-rec protocol="));
+  output.print(IR_SMALLD_PROTOCOL_ID);
+  output.print(F(" mode="));
+  output.print(IR_ISR_MODE == CHANGE ? 'C' : (IR_ISR_MODE == RISING ? 'R' : 'F'));
+  output.print(F(" shift="));
+  output.print(IR_SMALLD_RECORDER_SHIFT);
+  output.print(F(" level="));
+  output.println(_recOldestLevel);
+  uint16_t index = (_recHead + IR_SMALLD_RECORDER_SIZE - _recUsed) % IR_SMALLD_RECORDER_SIZE;
+  for (uint16_t i = 0; i < _recUsed; i++) {
+    uint8_t value = _recBuffer[index];
+    if (value < 0x10) output.print('0');
+    output.print(value, HEX);
+    if (i % 32 == 31) output.println();
+    index = (index + 1) % IR_SMALLD_RECORDER_SIZE;
+  }
+  if (_recUsed % 32) output.println();
+  output.println(F("#end"));
+  _recFrozen = wasFrozen;
+}
+#endif
+
+
 // ----------------------------------------------------------------------------
 // Computed GOTOs (labels as values) FSM control:
 #define FSM_INITIALIZE(initialState) static void* fsm_state = &&initialState
@@ -257,6 +1383,61 @@ bool IRsmallDecoder::dataAvailable() {
 #define FSM_DIRECTJUMP(label) goto label
 
 
+// ----------------------------------------------------------------------------
+// Frame timing (used by the ISRs if IR_SMALLD_TIMESTAMPS is defined):
+#if defined(IR_SMALLD_TIMESTAMPS)
+  #define TS_FRAME_START()         _frameStart = _previousTime;
+  #define TS_FRAME_END(lastEdge)  {_irData.time = lastEdge; _irData.duration = lastEdge - _frameStart;}
+#else
+  #define TS_FRAME_START()         //nothing
+  #define TS_FRAME_END(lastEdge)   //nothing
+#endif
+
+
+// ----------------------------------------------------------------------------
+// Signal quality (used by the ISRs if IR_SMALLD_QUALITY is defined):
+// SQ_MARK() adds a mark that was accepted between minimum and maximum, and SQ_BIT() a bit mark (M0 from min0 to
+// min1-1, M1 from min1 to max1). The ISR only accumulates; the sum and count are left in meanDeviation and quality.
+#if defined(IR_SMALLD_QUALITY)
+  #define SQ_FRAME_START()  {_qualitySum = 0; _qualityMax = 0; _qualityMargin = UINT16_MAX; _qualityCount = 0;}
+  #define SQ_MARK(duration, nominal, minimum, maximum)  addQualitySample(duration, nominal, minimum, maximum)
+  #define SQ_BIT(duration, min0, nominal0, min1, nominal1, max1)                                  \
+            {if ((duration) >= (min1)) addQualitySample(duration, nominal1, min1, max1);           \
+             else addQualitySample(duration, nominal0, min0, (min1) - 1);}
+  #define SQ_FRAME_END()    {_irData.meanDeviation = _qualitySum; _irData.quality = _qualityCount; \
+                             _irData.maxDeviation = _qualityMax;  _irData.minMargin = _qualityMargin;}
+
+/**
+ * Adds a mark's deviation from its nominal duration, and its margin to the thresholds, to the frame's quality.
+ */
+void IR_ISR_ATTR IRsmallDecoder::addQualitySample(uint16_t duration, uint16_t nominal, uint16_t minimum, uint16_t maximum) {
+  uint16_t deviation = duration > nominal ? duration - nominal : nominal - duration;
+  uint16_t margin = (duration - minimum < maximum - duration) ? duration - minimum : maximum - duration;
+  if (_qualitySum <= UINT16_MAX - deviation) _qualitySum += deviation;  // It can't overflow in a valid frame
+  if (deviation > _qualityMax) _qualityMax = deviation;
+  if (margin < _qualityMargin) _qualityMargin = margin;
+  if (_qualityCount < UINT8_MAX) _qualityCount++;
+}
+
+
+/**
+ * Turns the sum and count left by the ISR into the mean deviation, and computes the quality score:
+ * the smallest margin relative to the margin plus the largest deviation (100 if all marks were nominal).
+ */
+void IRsmallDecoder::summarizeQuality(irSmallD_t &irData) {
+  uint8_t count = irData.quality;
+  if (count) irData.meanDeviation /= count;
+  uint32_t range = (uint32_t)irData.minMargin + irData.maxDeviation;
+  irData.quality = range ? (uint32_t)100 * irData.minMargin / range : 100;
+}
+#else
+  #define SQ_FRAME_START()                                        //nothing
+  #define SQ_MARK(duration, nominal, minimum, maximum)            //nothing
+  #define SQ_BIT(duration, min0, nominal0, min1, nominal1, max1)  //nothing
+  #define SQ_FRAME_END()                                          //nothing
+#endif
+
+
 // ----------------------------------------------------------------------------
 // Conditional inclusion of protocol specific ISR implementations:
 #if defined(IR_SMALLD_NEC) || defined(IR_SMALLD_NECx)
@@ -271,6 +1452,8 @@ bool IRsmallDecoder::dataAvailable() {
   #include "IRsmallD_SAMSUNG.h"
 #elif defined(IR_SMALLD_SAMSUNG32)
   #include "IRsmallD_SAMSUNG32.h"
+#elif defined(IR_SMALLD_HASH)
+  #include "IRsmallD_HASH.h"
 #else
   #error ISR implementation not included.
 #endif